@@ -37,9 +37,78 @@ enum COMMANDS{
     CMD_SET_SMOOTH_SLOWDOWN,
     CMD_SET_BRIGHTNESS,
 
+    // Colors of 12 bits packed MSB first, two values into three bytes,
+    // LEDs in the device order, report may be shorter than 64 bytes.
+    // Supported since firmware x.7
+    CMD_UPDATE_LEDS_PACKED,     /* R G B of every LED */
+    CMD_UPDATE_LEDS_CHANGED,    /* 16-bit little endian mask of LEDs, R G B of each LED in the mask */
+    CMD_FILL_LEDS,              /* R G B for all LEDs */
+
+    // Effect the device plays by itself until the next colors report or
+    // CMD_OFF_ALL, hardware 6.x/7.x. Supported since firmware x.7
+    CMD_SET_EFFECT,             /* flags, count, keyframes of EFFECT_KEYFRAME_SIZE bytes */
+
+    // Gamma and white balance applied by the device to the colors of the
+    // commands above, kept in EEPROM, hardware 6.x/7.x. Supported since firmware x.7
+    CMD_SET_COLOR_CORRECTION,   /* item of COLOR_CORRECTION_ITEMS, its data */
+
     CMD_NOP = 0x0F
 };
 
+// Colors of CMD_UPDATE_LEDS and the packed commands may be followed by a
+// 16-bit little endian frame sequence number. The device puts the sequence
+// of the frame shown by its LEDs into the input report, so the host knows
+// how many frames are in flight. Supported since firmware x.7
+enum FRAME_SEQUENCE{
+    UPDATE_LEDS_REPORT_LEDS = 10,       /* LEDs of CMD_UPDATE_LEDS and CMD_UPDATE_LEDS_PACKED, the sequence follows them */
+    INDEX_UPDATE_LEDS_SEQUENCE = 61,    /* CMD_UPDATE_LEDS: command, 6 bytes of every LED, sequence */
+};
+
+// CMD_SET_EFFECT fills all LEDs, every keyframe is a transition from the
+// previous color (the current one for the first keyframe) to the keyframe
+// color: R G B of 8 bits, easing, 16-bit little endian duration in ms.
+// Zero keyframes stop the effect
+enum EFFECT_FLAGS{
+    EFFECT_LOOP = 0x01,         /* start over after the last keyframe */
+    EFFECT_SHUFFLE = 0x02,      /* random next keyframe, implies EFFECT_LOOP */
+};
+
+enum EFFECT_EASINGS{
+    EFFECT_EASING_LINEAR,
+    EFFECT_EASING_IN,           /* quadratic */
+    EFFECT_EASING_OUT,
+    EFFECT_EASING_IN_OUT,       /* smoothstep */
+    EFFECT_EASING_STEP,         /* keeps the previous color, jumps at the end */
+};
+
+enum EFFECT_SIZES{
+    EFFECT_KEYFRAME_SIZE = 6,
+    EFFECT_KEYFRAMES_MAX = 8,
+};
+
+// CMD_SET_COLOR_CORRECTION: every 12-bit color is scaled by the white
+// balance of its LED, mapped through the gamma table of its channel and
+// scaled by the brightness.
+// Tables survive power cycles, every changed byte is an EEPROM write of
+// 3.4 ms, so they are sent only when they change. On/off and brightness
+// are kept in RAM, the correction is off after power up
+enum COLOR_CORRECTION_ITEMS{
+    COLOR_CORRECTION_OFF,           /* colors are shown as sent */
+    COLOR_CORRECTION_ON,
+    COLOR_CORRECTION_GAMMA_RED,     /* COLOR_CORRECTION_GAMMA_POINTS of 16-bit little endian */
+    COLOR_CORRECTION_GAMMA_GREEN,
+    COLOR_CORRECTION_GAMMA_BLUE,
+    COLOR_CORRECTION_WHITE_BALANCE, /* R G B of every LED in the device order, 255 is 1.0 */
+    COLOR_CORRECTION_BRIGHTNESS,    /* 16-bit little endian up to COLOR_CORRECTION_BRIGHTNESS_MAX */
+};
+
+enum COLOR_CORRECTION_SIZES{
+    // Outputs for the inputs 0, 256, ..., 4096, linear in between
+    COLOR_CORRECTION_GAMMA_POINTS = 17,
+    // Brightness of 1.0
+    COLOR_CORRECTION_BRIGHTNESS_MAX = 256,
+};
+
 enum PRESCALLERS{
     CMD_SET_PRESCALLER_1,
     CMD_SET_PRESCALLER_8,
@@ -52,6 +121,22 @@ enum PRESCALLERS{
 enum DATA_VERSION_INDEXES{
     INDEX_FW_VER_MAJOR = 1,
     INDEX_FW_VER_MINOR,
+    INDEX_APPLIED_SEQUENCE,     /* 16-bit, frame sequence on the LEDs, firmware x.7 */
+};
+
+// Telemetry feature report, supported since firmware x.7.
+// 16-bit little endian counters which wrap around, indexes in the report
+// data (hidapi puts the report ID before them)
+enum TELEMETRY_INDEXES{
+    INDEX_TELEMETRY_FRAMES_RECEIVED = 0,    /* colors reports */
+    INDEX_TELEMETRY_FRAME_APPLIED = 2,      /* frames received when the LEDs got the last one */
+    INDEX_TELEMETRY_FRAME_APPLIED_SOF = 4,  /* USB frame (1 ms) counter then */
+    INDEX_TELEMETRY_SOF = 6,                /* USB frame counter when the report was created */
+    INDEX_TELEMETRY_ISR_OVERRUNS = 8,       /* timer compare matches lost while the ISR was running */
+    INDEX_TELEMETRY_FRAMES_MERGED = 10,     /* frames replaced by the next one before the LEDs got them */
+    INDEX_TELEMETRY_REPORTS_DROPPED = 12,   /* reports too short or of an unknown command */
+    INDEX_TELEMETRY_APPLIED_SEQUENCE = 14,  /* frame sequence on the LEDs, see FRAME_SEQUENCE */
+    TELEMETRY_REPORT_SIZE = 16
 };
 
 #endif /* COMMANDS_H_INCLUDED */
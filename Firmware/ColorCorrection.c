@@ -0,0 +1,148 @@
+/*
+ * ColorCorrection.c
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+
+#include "Lightpack.h"
+#include "ColorCorrection.h"
+
+#include "../CommonHeaders/COMMANDS.h"
+
+#if (LIGHTPACK_HW >= 6)
+
+// Tables are read from EEPROM on every color, there is no RAM for them
+typedef struct
+{
+    uint16_t gamma[3][COLOR_CORRECTION_GAMMA_POINTS];
+    uint8_t whiteBalance[LEDS_COUNT][3];
+
+} ColorCorrection_t;
+
+static ColorCorrection_t EEMEM s_eeColorCorrection;
+
+// Runtime state is kept in RAM only, the correction is off after power up
+// until the host that uploaded the tables switches it on
+static bool s_isEnabled = false;
+static uint16_t s_brightness = COLOR_CORRECTION_BRIGHTNESS_MAX;
+
+/*
+ *  Writes changed bytes only, the watchdog waits for 250 ms
+ */
+static void _UpdateBlock(uint8_t *eeAddress, const uint8_t *data, const uint8_t size)
+{
+    for (uint8_t i = 0; i < size; i++)
+    {
+        wdt_reset();
+        eeprom_update_byte(eeAddress + i, data[i]);
+    }
+}
+
+bool ColorCorrection_Set(const uint8_t *data, const uint16_t size)
+{
+    if (size < 1)
+        return false;
+
+    const uint8_t item = data[0];
+
+    switch (item)
+    {
+    case COLOR_CORRECTION_OFF:
+    case COLOR_CORRECTION_ON:
+
+        s_isEnabled = (item == COLOR_CORRECTION_ON);
+
+        return true;
+
+    case COLOR_CORRECTION_BRIGHTNESS:
+
+        if (size - 1 < sizeof(s_brightness))
+            return false;
+
+        s_brightness = data[1] | (data[2] << 8);
+        if (s_brightness > COLOR_CORRECTION_BRIGHTNESS_MAX)
+            s_brightness = COLOR_CORRECTION_BRIGHTNESS_MAX;
+
+        return true;
+
+    case COLOR_CORRECTION_GAMMA_RED:
+    case COLOR_CORRECTION_GAMMA_GREEN:
+    case COLOR_CORRECTION_GAMMA_BLUE:
+
+        if (size - 1 < sizeof(s_eeColorCorrection.gamma[0]))
+            return false;
+
+        // Little endian, as AVR keeps it
+        _UpdateBlock((uint8_t *)s_eeColorCorrection.gamma[item - COLOR_CORRECTION_GAMMA_RED],
+                     data + 1, sizeof(s_eeColorCorrection.gamma[0]));
+
+        return true;
+
+    case COLOR_CORRECTION_WHITE_BALANCE:
+
+        if (size - 1 < sizeof(s_eeColorCorrection.whiteBalance))
+            return false;
+
+        _UpdateBlock((uint8_t *)s_eeColorCorrection.whiteBalance,
+                     data + 1, sizeof(s_eeColorCorrection.whiteBalance));
+
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static inline uint16_t _Correct(const uint16_t *gamma, const uint8_t *whiteBalance, const uint16_t value)
+{
+    // White balance of 255 keeps the value
+    uint16_t balanced = ((uint32_t)value * (eeprom_read_byte(whiteBalance) + 1)) >> 8;
+
+    const uint8_t index = balanced >> 8;
+    const uint8_t fraction = balanced & 0xff;
+
+    int16_t from = eeprom_read_word(gamma + index);
+    int16_t to = eeprom_read_word(gamma + index + 1);
+    int16_t corrected = from + (int16_t)(((int32_t)(to - from) * fraction) >> 8);
+
+    if (corrected < 0)
+        return 0;
+    if (corrected > 0xfff)
+        corrected = 0xfff;
+
+    return ((uint32_t)corrected * s_brightness) >> 8;
+}
+
+void ColorCorrection_Apply(const uint8_t index, RGB_t * const color)
+{
+    if (!s_isEnabled)
+        return;
+
+    const uint8_t *whiteBalance = s_eeColorCorrection.whiteBalance[index];
+
+    color->r = _Correct(s_eeColorCorrection.gamma[0], whiteBalance, color->r);
+    color->g = _Correct(s_eeColorCorrection.gamma[1], whiteBalance + 1, color->g);
+    color->b = _Correct(s_eeColorCorrection.gamma[2], whiteBalance + 2, color->b);
+}
+
+#endif /* (LIGHTPACK_HW >= 6) */
@@ -0,0 +1,39 @@
+/*
+ * ColorCorrection.h
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLORCORRECTION_H_INCLUDED
+#define COLORCORRECTION_H_INCLUDED
+
+#include "datatypes.h"
+
+#if (LIGHTPACK_HW >= 6)
+
+// Stores the item of CMD_SET_COLOR_CORRECTION, returns false if the report is malformed
+extern bool ColorCorrection_Set(const uint8_t *data, const uint16_t size);
+
+// White balance of the LED, gamma of the channels and brightness, if enabled
+extern void ColorCorrection_Apply(const uint8_t index, RGB_t * const color);
+
+#endif /* (LIGHTPACK_HW >= 6) */
+
+#endif /* COLORCORRECTION_H_INCLUDED */
@@ -0,0 +1,174 @@
+/*
+ * Effects.c
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Lightpack.h"
+#include "Effects.h"
+
+#include "../CommonHeaders/COMMANDS.h"
+
+#if (LIGHTPACK_HW >= 6)
+
+typedef struct
+{
+    uint8_t r, g, b;
+    uint8_t easing;
+    uint16_t ticks;
+} EffectKeyframe_t;
+
+static EffectKeyframe_t s_keyframes[EFFECT_KEYFRAMES_MAX];
+
+static volatile uint8_t s_count = 0; // no effect is playing if zero
+static uint8_t s_flags;
+static uint8_t s_index;
+static uint16_t s_elapsed;
+static uint16_t s_random;
+static RGB_t s_from;
+
+bool Effects_Set(const uint8_t *data, const uint16_t size)
+{
+    if (size < 2)
+        return false;
+
+    uint8_t count = data[1];
+
+    if (count > EFFECT_KEYFRAMES_MAX || size - 2 < (uint16_t)count * EFFECT_KEYFRAME_SIZE)
+        return false;
+
+    // The ISR leaves the keyframes alone while the count is zero
+    Effects_Stop();
+
+    const uint8_t *keyframe = data + 2;
+
+    for (uint8_t i = 0; i < count; i++, keyframe += EFFECT_KEYFRAME_SIZE)
+    {
+        uint32_t ms = keyframe[4] | ((uint16_t)keyframe[5] << 8);
+        uint16_t ticks = (ms * 1000 + EFFECTS_TICK_US / 2) / EFFECTS_TICK_US;
+
+        s_keyframes[i].r = keyframe[0];
+        s_keyframes[i].g = keyframe[1];
+        s_keyframes[i].b = keyframe[2];
+        s_keyframes[i].easing = keyframe[3];
+        s_keyframes[i].ticks = ticks ? ticks : 1;
+    }
+
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        s_flags = data[0];
+        s_index = 0;
+        s_elapsed = 0;
+        s_random = TCNT1 | 1;
+        s_from = g_Images.current[0];
+        s_count = count;
+    }
+
+    return true;
+}
+
+void Effects_Stop(void)
+{
+    s_count = 0;
+}
+
+/*
+ *  Eased position of the transition, 0..256
+ */
+static inline uint16_t _Ease(const uint8_t easing, const uint16_t elapsed, const uint16_t ticks)
+{
+    uint16_t t = ((uint32_t)elapsed << 8) / ticks;
+
+    switch (easing)
+    {
+    case EFFECT_EASING_IN:
+        return ((uint32_t)t * t) >> 8;
+
+    case EFFECT_EASING_OUT:
+        return 256 - (((uint32_t)(256 - t) * (256 - t)) >> 8);
+
+    case EFFECT_EASING_IN_OUT:
+        return ((uint32_t)t * t * (768 - 2 * t)) >> 16;
+
+    case EFFECT_EASING_STEP:
+        return t < 256 ? 0 : 256;
+
+    default:
+        return t;
+    }
+}
+
+static inline uint16_t _Lerp(const uint16_t from, const uint8_t to, const uint16_t position)
+{
+    // 8-bit keyframe color to 12 bits, 0xff is 0xfff
+    int16_t end = ((uint16_t)to << 4) | (to >> 4);
+
+    return from + (int16_t)(((int32_t)(end - (int16_t)from) * position) >> 8);
+}
+
+static inline uint8_t _Random(void)
+{
+    // xorshift, the period is 65535
+    s_random ^= s_random << 7;
+    s_random ^= s_random >> 9;
+    s_random ^= s_random << 8;
+
+    return (uint8_t)s_random;
+}
+
+static inline void _NextKeyframe(void)
+{
+    if ((s_flags & EFFECT_SHUFFLE) && s_count > 1)
+    {
+        // Any keyframe but the current one
+        s_index = (s_index + 1 + _Random() % (s_count - 1)) % s_count;
+
+    } else if (++s_index == s_count) {
+
+        if (s_flags & (EFFECT_LOOP | EFFECT_SHUFFLE))
+            s_index = 0;
+        else
+            s_count = 0;
+    }
+}
+
+bool Effects_NextColor(RGB_t * const color)
+{
+    if (s_count == 0)
+        return false;
+
+    const EffectKeyframe_t *keyframe = &s_keyframes[s_index];
+    uint16_t position = _Ease(keyframe->easing, ++s_elapsed, keyframe->ticks);
+
+    color->r = _Lerp(s_from.r, keyframe->r, position);
+    color->g = _Lerp(s_from.g, keyframe->g, position);
+    color->b = _Lerp(s_from.b, keyframe->b, position);
+
+    if (s_elapsed == keyframe->ticks)
+    {
+        s_from = *color;
+        s_elapsed = 0;
+
+        _NextKeyframe();
+    }
+
+    return true;
+}
+
+#endif /* (LIGHTPACK_HW >= 6) */
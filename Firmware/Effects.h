@@ -0,0 +1,43 @@
+/*
+ * Effects.h
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EFFECTS_H_INCLUDED
+#define EFFECTS_H_INCLUDED
+
+#include "datatypes.h"
+
+#if (LIGHTPACK_HW >= 6)
+
+// Timer1 compare match period, 65536 cycles at 16 MHz
+#define EFFECTS_TICK_US 4096
+
+// Starts the effect of CMD_SET_EFFECT, returns false if the report is malformed
+extern bool Effects_Set(const uint8_t *data, const uint16_t size);
+extern void Effects_Stop(void);
+
+// Called by the timer ISR, returns false if no effect is playing
+extern bool Effects_NextColor(RGB_t * const color);
+
+#endif /* (LIGHTPACK_HW >= 6) */
+
+#endif /* EFFECTS_H_INCLUDED */
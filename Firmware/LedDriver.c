@@ -43,23 +43,37 @@
 
 static const uint8_t LedsNumberForOneDriver = 5;
 
-static inline void _SPI_Write12(uint16_t byte)
+// Two drivers in chain, 16 channels of 12 bits each
+#define LED_DRIVER_CHANNELS     16
+#define LED_DRIVER_FRAME_SIZE   (2 * LED_DRIVER_CHANNELS * 12 / 8)
+
+static inline void _SPI_Write8(const uint8_t byte)
 {
-    CLR(MOSI_PIN);
+    // SPI clock is F_CPU / 2, next byte goes right after the previous one
+    SPDR = byte;
+    while ((SPSR & (1 << SPIF)) == false) { }
+}
+
+// Packs 12-bit words MSB first, two words into three bytes, and shifts them
+// out as soon as they are complete: there is no RAM for the whole frame
+typedef struct
+{
+    uint8_t pending;
+    uint8_t isOdd;
 
-    // 12-bits
-    for (uint16_t bit = 0x0800; bit != 0; bit >>= 1)
+} Packer_t;
+
+static inline void _Pack12(Packer_t *packer, const uint16_t word)
+{
+    if (packer->isOdd)
     {
-        if (byte & bit)
-        {
-            SET(MOSI_PIN);
-        } else {
-            CLR(MOSI_PIN);
-        }
-
-        SET(SCK_PIN);
-        CLR(SCK_PIN);
+        _SPI_Write8(packer->pending | ((uint8_t)(word >> 8) & 0x0f));
+        _SPI_Write8((uint8_t)word);
+    } else {
+        _SPI_Write8((uint8_t)(word >> 4));
+        packer->pending = (uint8_t)(word << 4);
     }
+    packer->isOdd ^= 1;
 }
 
 static inline void _LedDriver_LatchPulse(void)
@@ -73,12 +87,17 @@ void LedDriver_Init(void)
 {
     OUTPUT(SCK_PIN);
     OUTPUT(MOSI_PIN);
+    // LATCH is SS pin of SPI, it must be output before SPI master is enabled
     OUTPUT(LATCH_PIN);
 
     CLR(LATCH_PIN);
     CLR(SCK_PIN);
     CLR(MOSI_PIN);
 
+    // Setup SPI Master with max SPI clock speed (F_CPU / 2), mode 0, MSB first
+    SPSR = (1 << SPI2X);
+    SPCR = (1 << SPE) | (1 << MSTR);
+
     LedDriver_OffLeds();
 }
 
@@ -92,23 +111,24 @@ void LedDriver_Update(const RGB_t imageFrame[LEDS_COUNT])
     //       5     4     3     2     1
     // 0 B G R B G R B G R B G R B G R
 
-    _SPI_Write12(0);
+    Packer_t packer = { 0, 0 };
+
+    _Pack12(&packer, 0);
 
     for (uint8_t i = LedsNumberForOneDriver; i < LEDS_COUNT; i++)
     {
-        _SPI_Write12(imageFrame[i].b);
-        _SPI_Write12(imageFrame[i].g);
-        _SPI_Write12(imageFrame[i].r);
+        _Pack12(&packer, imageFrame[i].b);
+        _Pack12(&packer, imageFrame[i].g);
+        _Pack12(&packer, imageFrame[i].r);
     }
 
-    _SPI_Write12(0);
-
+    _Pack12(&packer, 0);
 
     for (uint8_t i = 0; i < LedsNumberForOneDriver; i++)
     {
-        _SPI_Write12(imageFrame[i].b);
-        _SPI_Write12(imageFrame[i].g);
-        _SPI_Write12(imageFrame[i].r);
+        _Pack12(&packer, imageFrame[i].b);
+        _Pack12(&packer, imageFrame[i].g);
+        _Pack12(&packer, imageFrame[i].r);
     }
 
     _LedDriver_LatchPulse();
@@ -116,8 +136,9 @@ void LedDriver_Update(const RGB_t imageFrame[LEDS_COUNT])
 
 void LedDriver_OffLeds(void)
 {
-    for (uint8_t i = 0; i < 16; i++)
-        _SPI_Write12(0x0000);
+    // Both drivers, all channels
+    for (uint8_t i = 0; i < LED_DRIVER_FRAME_SIZE; i++)
+        _SPI_Write8(0x00);
 
     _LedDriver_LatchPulse();
 }
@@ -23,72 +23,266 @@
 
 #include "Lightpack.h"
 #include "LedDriver.h"
+#include "Effects.h"
+
+// Frame is complete, the ISR may swap it in. USB code sets the colors of the
+// next frame without locking, as the ISR leaves them alone until then
+static volatile uint8_t s_isNextImageReady = false;
+
+void LedManager_BeginFrame(void)
+{
+    // Frame which has not been swapped in yet is merged with this one
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        s_isNextImageReady = false;
+    }
+}
+
+void LedManager_EndFrame(void)
+{
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        s_isNextImageReady = true;
+    }
+}
+
+#if (LIGHTPACK_HW >= 6)
+
+static volatile uint8_t s_isImageChanged = true;
 
 void LedManager_FillImages(const uint8_t red, const uint8_t green, const uint8_t blue)
 {
-    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        Effects_Stop();
+
+        for (uint8_t i = 0; i < LEDS_COUNT; i++)
+        {
+            g_Images.current[i].r = g_Images.end[i].r = red;
+            g_Images.current[i].g = g_Images.end[i].g = green;
+            g_Images.current[i].b = g_Images.end[i].b = blue;
+        }
+
+        g_Images.smoothMask = 0;
+        g_Images.nextMask = 0;
+        s_isNextImageReady = false;
+        s_isImageChanged = true;
+    }
+}
+
+static inline int16_t _Delta(const uint16_t from, const uint16_t to, const uint8_t ticks)
+{
+    return (int16_t)((((int32_t)to - from) << 4) / ticks);
+}
+
+// Start of the change in 12.4 fixed point, the rounding error of the delta
+// is taken in the first step and the last one is exactly on the end color
+static inline uint16_t _Start(const uint16_t to, const int16_t delta, const uint8_t ticks)
+{
+    return (uint16_t)(((int32_t)to << 4) - (int32_t)delta * ticks);
+}
+
+// Sets the color and its fraction from 12.4 fixed point
+static inline void _SetPosition(uint16_t *color, uint8_t *fraction, const uint16_t position)
+{
+    *color = position >> 4;
+    *fraction = position & 0x0f;
+}
+
+static inline void _Step(uint16_t *color, uint8_t *fraction, const int16_t delta)
+{
+    _SetPosition(color, fraction, (uint16_t)((*color << 4) | *fraction) + delta);
+}
+
+void LedManager_ChangeColor(const uint8_t index, const RGB_t * const color)
+{
+    // End colors of the LEDs in nextMask are the next image,
+    // the ISR does not read them until the frame is ended
+    g_Images.end[index] = *color;
+    g_Images.nextMask |= (uint16_t)(1 << index);
+}
+
+/*
+ *  Starts the change of the LED to its end color, in the ISR
+ */
+static inline void _StartChange(const uint8_t index)
+{
+    uint8_t ticks = g_Settings.smoothSlowdown;
+    RGB_t *current = &g_Images.current[index];
+    const RGB_t *color = &g_Images.end[index];
+
+    // Smooth change restarts from the current color, like the host
+    // sends the frames faster than smoothSlowdown ticks
+    if (!g_Settings.isSmoothEnabled || ticks < 2 ||
+            (current->r == color->r && current->g == color->g && current->b == color->b))
     {
-        g_Images.start[i].r = red;
-        g_Images.start[i].g = green;
-        g_Images.start[i].b = blue;
+        if (current->r != color->r || current->g != color->g || current->b != color->b)
+        {
+            *current = *color;
+            s_isImageChanged = true;
+        }
+        g_Images.smoothMask &= (uint16_t)~(1 << index);
 
-        g_Images.current[i].r = red;
-        g_Images.current[i].g = green;
-        g_Images.current[i].b = blue;
+    } else {
+        g_Images.delta[index].r = _Delta(current->r, color->r, ticks);
+        g_Images.delta[index].g = _Delta(current->g, color->g, ticks);
+        g_Images.delta[index].b = _Delta(current->b, color->b, ticks);
 
-        g_Images.end[i].r = red;
-        g_Images.end[i].g = green;
-        g_Images.end[i].b = blue;
+        // Current color moves by less than one step, the first step comes on this tick
+        _SetPosition(&current->r, &g_Images.fraction[index].r, _Start(color->r, g_Images.delta[index].r, ticks));
+        _SetPosition(&current->g, &g_Images.fraction[index].g, _Start(color->g, g_Images.delta[index].g, ticks));
+        _SetPosition(&current->b, &g_Images.fraction[index].b, _Start(color->b, g_Images.delta[index].b, ticks));
+
+        g_Images.smoothTicks[index] = ticks;
+        g_Images.smoothMask |= (uint16_t)(1 << index);
     }
 }
 
-#if (LIGHTPACK_HW >= 6)
+void LedManager_SwapImages(void)
+{
+    uint16_t mask = g_Images.nextMask;
+
+    if (!s_isNextImageReady)
+        return;
+
+    s_isNextImageReady = false;
+    g_Images.nextMask = 0;
+
+    // All LEDs of the frame change on the same tick
+    for (uint8_t i = 0; mask != 0; i++, mask >>= 1)
+    {
+        if (mask & 1)
+            _StartChange(i);
+    }
+}
 
 void EvalCurrentImage_SmoothlyAlg(void)
 {
-    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    uint16_t mask = g_Images.smoothMask;
+
+    if (mask == 0)
+        return;
+
+    for (uint8_t i = 0; mask != 0; i++, mask >>= 1)
     {
-        if (g_Images.smoothIndex[i] >= g_Settings.smoothSlowdown)
-        {
-            // Smooth change colors complete, rewrite start image
-            g_Images.current[i].r = g_Images.start[i].r = g_Images.end[i].r;
-            g_Images.current[i].g = g_Images.start[i].g = g_Images.end[i].g;
-            g_Images.current[i].b = g_Images.start[i].b = g_Images.end[i].b;
+        if ((mask & 1) == 0)
+            continue;
 
-        } else {
-            uint32_t coefEnd = ((uint32_t)g_Images.smoothIndex[i] << 16) / g_Settings.smoothSlowdown;
-            uint32_t coefStart = (1UL << 16) - coefEnd;
+        // The last step ends on the end color, which may already be
+        // the one of the next frame, so it is not read here
+        if (--g_Images.smoothTicks[i] == 0)
+            g_Images.smoothMask &= (uint16_t)~(1 << i);
 
-            g_Images.current[i].r = (
-                    coefStart * g_Images.start[i].r +
-                    coefEnd   * g_Images.end  [i].r) >> 16;
+        _Step(&g_Images.current[i].r, &g_Images.fraction[i].r, g_Images.delta[i].r);
+        _Step(&g_Images.current[i].g, &g_Images.fraction[i].g, g_Images.delta[i].g);
+        _Step(&g_Images.current[i].b, &g_Images.fraction[i].b, g_Images.delta[i].b);
+    }
 
-            g_Images.current[i].g = (
-                    coefStart * g_Images.start[i].g +
-                    coefEnd   * g_Images.end  [i].g) >> 16;
+    s_isImageChanged = true;
+}
 
-            g_Images.current[i].b = (
-                    coefStart * g_Images.start[i].b +
-                    coefEnd   * g_Images.end  [i].b) >> 16;
+/*
+ *  Effect frame, the same color for all LEDs
+ */
+static inline void _FillCurrentImage(const RGB_t * const color)
+{
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        RGB_t *current = &g_Images.current[i];
 
-            g_Images.smoothIndex[i]++;
+        if (current->r != color->r || current->g != color->g || current->b != color->b)
+        {
+            *current = *color;
+            s_isImageChanged = true;
         }
+        g_Images.end[i] = *color;
     }
+
+    g_Images.smoothMask = 0;
 }
 
 void LedManager_UpdateColors(void)
 {
-    EvalCurrentImage_SmoothlyAlg();
+    static uint8_t s_ticksSinceUpdate = 0;
+    RGB_t color;
 
-    if (g_Settings.isSmoothEnabled)
-    	LedDriver_Update(g_Images.current);
+    LedManager_SwapImages();
+
+    if (Effects_NextColor(&color))
+        _FillCurrentImage(&color);
     else
-    	LedDriver_Update(g_Images.end);
+        EvalCurrentImage_SmoothlyAlg();
+
+    // LED drivers keep the latched colors, rewrite them on a change
+    // and every 256 ticks anyway
+    if (s_isImageChanged || ++s_ticksSinceUpdate == 0)
+    {
+        s_isImageChanged = false;
+        s_ticksSinceUpdate = 0;
+
+        LedDriver_Update(g_Images.current);
+    }
 }
 
 
 #elif (LIGHTPACK_HW == 5 || LIGHTPACK_HW == 4)
 
+void LedManager_FillImages(const uint8_t red, const uint8_t green, const uint8_t blue)
+{
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        for (uint8_t i = 0; i < LEDS_COUNT; i++)
+        {
+            g_Images.start[i].r = red;
+            g_Images.start[i].g = green;
+            g_Images.start[i].b = blue;
+
+            g_Images.current[i].r = red;
+            g_Images.current[i].g = green;
+            g_Images.current[i].b = blue;
+
+            g_Images.end[i].r = red;
+            g_Images.end[i].g = green;
+            g_Images.end[i].b = blue;
+        }
+
+        g_Images.nextMask = 0;
+        s_isNextImageReady = false;
+    }
+}
+
+void LedManager_ChangeColor(const uint8_t index, const RGB_t * const color)
+{
+    // The ISR does not read the next image until the frame is ended
+    g_Images.next[index] = *color;
+    g_Images.nextMask |= (uint16_t)(1 << index);
+}
+
+void LedManager_SwapImages(void)
+{
+    uint16_t mask = g_Images.nextMask;
+
+    if (!s_isNextImageReady)
+        return;
+
+    s_isNextImageReady = false;
+    g_Images.nextMask = 0;
+
+    for (uint8_t i = 0; mask != 0; i++, mask >>= 1)
+    {
+        if ((mask & 1) == 0)
+            continue;
+
+        g_Images.start[i] = g_Images.current[i];
+        g_Images.end[i] = g_Images.next[i];
+
+        // If pixel changed, then restart smooth algorithm
+        // for current pixel by clearing smoothIndex
+        if (g_Images.start[i].r != g_Images.end[i].r ||
+            g_Images.start[i].g != g_Images.end[i].g ||
+            g_Images.start[i].b != g_Images.end[i].b)
+        {
+            g_Images.smoothIndex[i] = 0;
+        }
+    }
+}
+
 
 static inline void _StartConstantTime(void)
 {
@@ -145,6 +339,9 @@ static inline void _PulseWidthModulation(void)
         // Switch OFF LEDs on time sets in g_Settings.brightness
         LedDriver_OffLeds();
 
+        // Frame changes between the PWM periods only
+        LedManager_SwapImages();
+
         // Also eval current image
         if (g_Settings.isSmoothEnabled)
         {
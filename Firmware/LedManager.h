@@ -24,8 +24,21 @@
 #ifndef LEDMANAGER_H_INCLUDED
 #define LEDMANAGER_H_INCLUDED
 
+#include "datatypes.h"
+
 extern void LedManager_UpdateColors(void);
 extern void LedManager_FillImages(const uint8_t red, const uint8_t green, const uint8_t blue);
 
+// Colors of a frame are set between LedManager_BeginFrame() and LedManager_EndFrame(),
+// the timer ISR swaps the whole frame in on its next tick (PWM period on hardware 4.x/5.x)
+extern void LedManager_BeginFrame(void);
+extern void LedManager_EndFrame(void);
+
+// Sets the new end color of the LED, the smooth change to it starts with the frame
+extern void LedManager_ChangeColor(const uint8_t index, const RGB_t * const color);
+
+// Called by the timer ISR, takes the frame ended last if there is one
+extern void LedManager_SwapImages(void);
+
 #endif /* LEDMANAGER_H_INCLUDED */
 
@@ -34,6 +34,8 @@ volatile uint8_t g_Flags = 0;
 
 Images_t g_Images = { };
 
+Telemetry_t g_Telemetry = { };
+
 Settings_t g_Settings =
 {
         .isSmoothEnabled = true,
@@ -57,6 +59,21 @@ ISR( TIMER1_COMPA_vect )
 {
     LedManager_UpdateColors();
 
+    // Frame received before this tick is on the LEDs now
+    if (g_Telemetry.isFramePending)
+    {
+        g_Telemetry.isFramePending = false;
+        g_Telemetry.frameApplied = g_Telemetry.framesReceived;
+        g_Telemetry.frameAppliedSof = g_Telemetry.sof;
+        g_Telemetry.appliedSequence = g_Telemetry.receivedSequence;
+    }
+
+#   if (LIGHTPACK_HW >= 6)
+    // Older hardware restarts the timer here, a match during the ISR is expected
+    if (TIFR1 & _BV(OCF1A))
+        g_Telemetry.isrOverruns++;
+#   endif
+
     // Clear timer interrupt flag
     TIFR1 = _BV(OCF1A);
 }
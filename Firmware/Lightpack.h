@@ -61,6 +61,7 @@
 // Global variables
 extern Settings_t g_Settings;
 extern Images_t g_Images;
+extern Telemetry_t g_Telemetry;
 
 static inline void _BlinkUsbLed(const uint8_t times, const uint8_t ms)
 {
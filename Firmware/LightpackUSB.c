@@ -26,13 +26,14 @@
 
 #include "Lightpack.h"
 #include "LightpackUSB.h"
+#include "LedManager.h"
+#include "Effects.h"
+#include "ColorCorrection.h"
 #include "version.h"
 
 #include "../CommonHeaders/COMMANDS.h"
 #include <LUFA/Drivers/USB/USB.h>
 
-// Buffer to hold the previously generated HID report, for comparison purposes inside the HID class driver.
-uint8_t PrevHIDReportINBuffer[GENERIC_REPORT_SIZE];
 uint8_t PrevUsbLedState;
 
 USB_ClassInfo_HID_Device_t Generic_HID_Interface =
@@ -47,8 +48,10 @@ USB_ClassInfo_HID_Device_t Generic_HID_Interface =
                     .Banks                    = 1,
                 },
 
-                .PrevReportINBuffer           = PrevHIDReportINBuffer,
-                .PrevReportINBufferSize       = sizeof(PrevHIDReportINBuffer),
+                // Input report is sent on every poll anyway, so there is no copy of the previous
+                // one to compare with. The size is still needed for the report buffers on the stack
+                .PrevReportINBuffer           = NULL,
+                .PrevReportINBufferSize       = GENERIC_REPORT_SIZE,
         },
 };
 
@@ -83,6 +86,32 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 void EVENT_USB_Device_StartOfFrame(void)
 {
     HID_Device_MillisecondElapsed(&Generic_HID_Interface);
+
+    g_Telemetry.sof++;
+}
+
+static inline void _Put16(uint8_t *data, const uint8_t index, const uint16_t value)
+{
+    data[index] = value & 0xff;
+    data[index + 1] = value >> 8;
+}
+
+static void _CreateTelemetryReport(uint8_t *data)
+{
+    Telemetry_t telemetry;
+
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        telemetry = g_Telemetry;
+    }
+
+    _Put16(data, INDEX_TELEMETRY_FRAMES_RECEIVED, telemetry.framesReceived);
+    _Put16(data, INDEX_TELEMETRY_FRAME_APPLIED, telemetry.frameApplied);
+    _Put16(data, INDEX_TELEMETRY_FRAME_APPLIED_SOF, telemetry.frameAppliedSof);
+    _Put16(data, INDEX_TELEMETRY_SOF, telemetry.sof);
+    _Put16(data, INDEX_TELEMETRY_ISR_OVERRUNS, telemetry.isrOverruns);
+    _Put16(data, INDEX_TELEMETRY_FRAMES_MERGED, telemetry.framesMerged);
+    _Put16(data, INDEX_TELEMETRY_REPORTS_DROPPED, telemetry.reportsDropped);
+    _Put16(data, INDEX_TELEMETRY_APPLIED_SEQUENCE, telemetry.appliedSequence);
 }
 
 
@@ -93,14 +122,171 @@ bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDIn
                                          uint16_t* const ReportSize)
 {
     uint8_t *ReportData_u8 = (uint8_t *)ReportData;
+
+    if (ReportType == HID_REPORT_ITEM_Feature)
+    {
+        _CreateTelemetryReport(ReportData_u8);
+        *ReportSize = TELEMETRY_REPORT_SIZE;
+        return true;
+    }
+
     *ReportSize = GENERIC_EPSIZE;
 
     // Firmware version
     ReportData_u8[INDEX_FW_VER_MAJOR] = VERSION_OF_FIRMWARE_MAJOR;
     ReportData_u8[INDEX_FW_VER_MINOR] = VERSION_OF_FIRMWARE_MINOR;
+
+    // Report goes out on every poll of the IN endpoint (5 ms), so the host
+    // learns about the applied frame without asking for it
+    uint16_t appliedSequence;
+
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        appliedSequence = g_Telemetry.appliedSequence;
+    }
+
+    _Put16(ReportData_u8, INDEX_APPLIED_SEQUENCE, appliedSequence);
     return true;
 }
 
+/*
+ *  Sets new 12-bit color of the LED, older hardware takes 8 high bits
+ */
+static inline void _UpdateLed(const uint8_t index, const uint16_t red, const uint16_t green, const uint16_t blue)
+{
+#   if (LIGHTPACK_HW >= 6)
+
+    RGB_t color = { red, green, blue };
+
+    ColorCorrection_Apply(index, &color);
+
+    // Colors from the host take over from the effect
+    Effects_Stop();
+
+#   else /* (LIGHTPACK_HW >= 6) */
+
+    RGB_t color = { red >> 4, green >> 4, blue >> 4 };
+
+#   endif
+
+    LedManager_ChangeColor(index, &color);
+}
+
+/*
+ *  12-bit values packed MSB first, two values into three bytes
+ */
+static inline uint8_t _PackedSize(const uint8_t count)
+{
+    return (uint8_t)((count * 3 + 1) >> 1);
+}
+
+static inline uint16_t _Unpack12(const uint8_t *data, const uint8_t index)
+{
+    const uint8_t *packed = data + index + (index >> 1);
+
+    if (index & 1)
+        return ((uint16_t)(packed[0] & 0x0f) << 8) | packed[1];
+    else
+        return ((uint16_t)packed[0] << 4) | (packed[1] >> 4);
+}
+
+/*
+ *  Frame sequence number following the colors at index of the report,
+ *  0 if the host has not sent it
+ */
+static inline uint16_t _Sequence(const uint8_t *report, const uint8_t index, const uint16_t size)
+{
+    if (size < index + 2)
+        return 0;
+
+    return report[index] | ((uint16_t)report[index + 1] << 8);
+}
+
+/*
+ *  Colors report is complete, the timer ISR puts it on the LEDs on the next tick
+ */
+static inline void _FrameReceived(const uint16_t sequence)
+{
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        if (g_Telemetry.isFramePending)
+            g_Telemetry.framesMerged++;
+
+        g_Telemetry.framesReceived++;
+        g_Telemetry.receivedSequence = sequence;
+        g_Telemetry.isFramePending = true;
+
+        // Applied telemetry comes from the same tick as the swap
+        LedManager_EndFrame();
+    }
+}
+
+/*
+ *  CMD_UPDATE_LEDS_PACKED, CMD_UPDATE_LEDS_CHANGED and CMD_FILL_LEDS,
+ *  returns the size of the colors in the report, the frame sequence follows
+ *  them. Reports too short for their colors are ignored and 0 is returned
+ */
+static uint8_t _UpdateLedsPacked(const uint8_t cmd, const uint8_t *data, const uint16_t size)
+{
+    uint16_t mask = (1 << LEDS_COUNT) - 1;
+    uint8_t colorsSize;
+
+    switch (cmd)
+    {
+    case CMD_UPDATE_LEDS_CHANGED:
+    {
+        uint8_t count = 0;
+
+        if (size < 2)
+            return 0;
+
+        // LEDs the hardware doesn't have take their place in the report still
+        const uint16_t sent = (data[0] | ((uint16_t)data[1] << 8)) & ((1 << UPDATE_LEDS_REPORT_LEDS) - 1);
+
+        mask &= sent;
+        data += 2;
+
+        for (uint16_t bits = sent; bits != 0; bits >>= 1)
+            count += bits & 1;
+
+        colorsSize = 2 + _PackedSize(3 * count);
+        if (size < colorsSize)
+            return 0;
+
+        break;
+    }
+    case CMD_FILL_LEDS:
+
+        if (size < _PackedSize(3))
+            return 0;
+
+        for (uint8_t i = 0; i < LEDS_COUNT; i++)
+            _UpdateLed(i, _Unpack12(data, 0), _Unpack12(data, 1), _Unpack12(data, 2));
+
+        return _PackedSize(3);
+
+    default:
+
+        if (size < _PackedSize(3 * LEDS_COUNT))
+            return 0;
+
+        colorsSize = _PackedSize(3 * UPDATE_LEDS_REPORT_LEDS);
+
+        break;
+    }
+
+    uint8_t index = 0;
+
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        if (mask & (1 << i))
+        {
+            _UpdateLed(i, _Unpack12(data, index), _Unpack12(data, index + 1), _Unpack12(data, index + 2));
+            index += 3;
+        }
+    }
+
+    return colorsSize;
+}
+
 /** HID class driver callback function for the processing of HID reports from the host.
  *
  *  \param[in] HIDInterfaceInfo  Pointer to the HID class interface configuration structure being referenced
@@ -126,54 +312,72 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
     case CMD_UPDATE_LEDS:
     {
 
-        _FlagSet(Flag_ChangingColors);
+        LedManager_BeginFrame();
 
         uint8_t reportDataIndex = 1; // new data starts form ReportData_u8[1]
 
         for (uint8_t i = 0; i < LEDS_COUNT; i++)
         {
-            g_Images.start[i].r = g_Images.current[i].r;
-            g_Images.start[i].g = g_Images.current[i].g;
-            g_Images.start[i].b = g_Images.current[i].b;
-
+            uint16_t red   = ((uint16_t)ReportData_u8[reportDataIndex++] << 4);
+            uint16_t green = ((uint16_t)ReportData_u8[reportDataIndex++] << 4);
+            uint16_t blue  = ((uint16_t)ReportData_u8[reportDataIndex++] << 4);
 
-#           if (LIGHTPACK_HW >= 6)
-
-            g_Images.end[i].r = ((uint16_t)ReportData_u8[reportDataIndex++] << 4);
-            g_Images.end[i].g = ((uint16_t)ReportData_u8[reportDataIndex++] << 4);
-            g_Images.end[i].b = ((uint16_t)ReportData_u8[reportDataIndex++] << 4);
-
-            g_Images.end[i].r |= (uint16_t)(ReportData_u8[reportDataIndex++] & 0x0f);
-            g_Images.end[i].g |= (uint16_t)(ReportData_u8[reportDataIndex++] & 0x0f);
-            g_Images.end[i].b |= (uint16_t)(ReportData_u8[reportDataIndex++] & 0x0f);
+            red   |= (uint16_t)(ReportData_u8[reportDataIndex++] & 0x0f);
+            green |= (uint16_t)(ReportData_u8[reportDataIndex++] & 0x0f);
+            blue  |= (uint16_t)(ReportData_u8[reportDataIndex++] & 0x0f);
 
+            _UpdateLed(i, red, green, blue);
+        }
 
-#           else /* (LIGHTPACK_HW >= 6) */
+        _FlagSet(Flag_HaveNewColors);
+        _FrameReceived(_Sequence(ReportData_u8, INDEX_UPDATE_LEDS_SEQUENCE, ReportSize));
 
-            g_Images.end[i].r = ReportData_u8[reportDataIndex++];
-            g_Images.end[i].g = ReportData_u8[reportDataIndex++];
-            g_Images.end[i].b = ReportData_u8[reportDataIndex++];
+        break;
+    }
+    case CMD_UPDATE_LEDS_PACKED:
+    case CMD_UPDATE_LEDS_CHANGED:
+    case CMD_FILL_LEDS:
+    {
+        LedManager_BeginFrame();
 
-            reportDataIndex++;
-            reportDataIndex++;
-            reportDataIndex++;
-#endif
+        const uint8_t colorsSize = _UpdateLedsPacked(cmd, ReportData_u8 + 1, ReportSize - 1);
 
-            // If pixel changed, then restart smooth algorithm
-            // for current pixel by clearing smoothIndex
-            if (g_Images.start[i].r != g_Images.end[i].r ||
-                g_Images.start[i].g != g_Images.end[i].g ||
-                g_Images.start[i].b != g_Images.end[i].b)
-            {
-                g_Images.smoothIndex[i] = 0;
-            }
+        if (colorsSize > 0)
+        {
+            _FrameReceived(_Sequence(ReportData_u8, 1 + colorsSize, ReportSize));
+        } else {
+            // Frame merged into this one is still due
+            LedManager_EndFrame();
+            g_Telemetry.reportsDropped++;
         }
 
-        _FlagClear(Flag_ChangingColors);
         _FlagSet(Flag_HaveNewColors);
 
         break;
     }
+
+    case CMD_SET_EFFECT:
+
+#       if (LIGHTPACK_HW >= 6)
+        if (Effects_Set(ReportData_u8 + 1, ReportSize - 1))
+            break;
+#       endif
+
+        g_Telemetry.reportsDropped++;
+
+        break;
+
+    case CMD_SET_COLOR_CORRECTION:
+
+#       if (LIGHTPACK_HW >= 6)
+        if (ColorCorrection_Set(ReportData_u8 + 1, ReportSize - 1))
+            break;
+#       endif
+
+        g_Telemetry.reportsDropped++;
+
+        break;
+
     case CMD_OFF_ALL:
 
         _FlagSet(Flag_LedsOffAll);
@@ -200,6 +404,15 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
         g_Settings.isSmoothEnabled = ReportData_u8[1];
         g_Settings.smoothSlowdown  = ReportData_u8[1]; /* not a bug */
 
+#       if (LIGHTPACK_HW >= 6)
+        // Smooth changes in progress go on with the new speed,
+        // a frame not swapped in yet keeps its colors
+        LedManager_BeginFrame();
+        for (uint8_t i = 0; i < LEDS_COUNT; i++)
+            LedManager_ChangeColor(i, &g_Images.end[i]);
+        LedManager_EndFrame();
+#       endif
+
         break;
 
     case CMD_SET_BRIGHTNESS:
@@ -211,6 +424,11 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
     case CMD_NOP:
         break;
 
+    default:
+
+        g_Telemetry.reportsDropped++;
+
+        break;
     }
 }
 
@@ -48,6 +48,42 @@ typedef struct
 } RGB_t;
 #endif
 
+#if (LIGHTPACK_HW >= 6)
+// Change of the color per timer tick, 12.4 fixed point
+typedef struct
+{
+    int16_t r;
+    int16_t g;
+    int16_t b;
+
+} RGBDelta_t;
+
+// Low 4 bits of the color in 12.4 fixed point, the high ones are the current color
+typedef struct
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+
+} RGBFraction_t;
+
+typedef struct
+{
+    RGB_t current[LEDS_COUNT];
+    RGB_t end[LEDS_COUNT];
+
+    // Smooth change of the LEDs which have a bit set in smoothMask:
+    // fraction of the current color, its delta and ticks left
+    RGBFraction_t fraction[LEDS_COUNT];
+    RGBDelta_t delta[LEDS_COUNT];
+    uint8_t smoothTicks[LEDS_COUNT];
+    uint16_t smoothMask;
+
+    // LEDs of the frame being received, their end colors are the next image
+    uint16_t nextMask;
+
+} Images_t;
+#else /*(LIGHTPACK_HW >= 6)*/
 typedef struct
 {
     RGB_t start[LEDS_COUNT];
@@ -56,7 +92,12 @@ typedef struct
 
     uint8_t smoothIndex[LEDS_COUNT];
 
+    // Frame being received, LEDs with a bit set in nextMask change on the swap
+    RGB_t next[LEDS_COUNT];
+    uint16_t nextMask;
+
 } Images_t;
+#endif
 
 typedef struct
 {
@@ -68,4 +109,24 @@ typedef struct
 
 } Settings_t;
 
+// Counters of the telemetry feature report, see COMMANDS.h
+typedef struct
+{
+    uint16_t sof;               // USB frames (1 ms) since the power on
+    uint16_t framesReceived;
+    uint16_t frameApplied;
+    uint16_t frameAppliedSof;
+    uint16_t isrOverruns;
+    uint16_t framesMerged;
+    uint16_t reportsDropped;
+
+    // Sequence numbers from the host, see FRAME_SEQUENCE in COMMANDS.h
+    uint16_t receivedSequence;
+    uint16_t appliedSequence;
+
+    // Frame is received, the timer ISR has not put it on the LEDs yet
+    uint8_t isFramePending;
+
+} Telemetry_t;
+
 #endif /* DATATYPES_H_INCLUDED */
@@ -29,8 +29,15 @@
 #define IODEFS_H_INCLUDED
 
 // Bit manipulation macros
+#ifdef LIGHTPACK_SIM
+// Host simulator (see sim/) traces every pin change
+#include "SimAvr.h"
+#define	BIT_CLR(reg,bit)	{ SimAvr_BitWrite(&(reg), (bit), 0); }
+#define	BIT_SET(reg,bit)	{ SimAvr_BitWrite(&(reg), (bit), 1); }
+#else
 #define	BIT_CLR(reg,bit)	{ (reg) &= ~_BV(bit); }
 #define	BIT_SET(reg,bit)	{ (reg) |=  _BV(bit); }
+#endif
 #define	BIT_TST(reg,bit)	(((reg) & _BV(bit)) != 0)
 
 // I/O port manipulation macros
@@ -0,0 +1,479 @@
+/*
+ * SimAvr.c
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <avr/io.h>
+#include "SimAvr.h"
+
+uint64_t g_SimCycles = 0;
+SimIsrStats_t g_SimTimer1Stats = { };
+
+volatile uint8_t PINB, DDRB, PORTB;
+volatile uint8_t PINC, DDRC, PORTC;
+volatile uint8_t PIND, DDRD, PORTD;
+
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint16_t OCR1A;
+
+volatile uint8_t SPCR;
+volatile uint8_t WDTCSR;
+
+// Lightpack.c: ISR( TIMER1_COMPA_vect )
+extern void SimIsr_TIMER1_COMPA_vect(void);
+
+static uint8_t s_isInterruptsEnabled = 0;
+static uint8_t s_isInIsr = 0;
+static uint8_t s_isInTimer1Isr = 0;
+
+static uint8_t s_isTimer1Running = 0;
+static int64_t s_timer1Base = 0;        // cycle when TCNT1 was 0
+static uint16_t s_tcnt1 = 0;            // what the firmware reads and writes
+static uint16_t s_tcnt1Shadow = 0;      // what the simulator gave it last time
+static uint64_t s_timer1CheckedUntil = 0;
+static uint8_t s_isCompareAPending = 0;
+static uint64_t s_compareAPendingSince = 0;
+static uint64_t s_lastIsrStart = 0;
+
+static SimPortHook_t s_portHooks[3] = { };
+
+static uint8_t s_spsr = 0;
+static uint8_t s_spdr = 0;
+static uint8_t s_isSpdrAccessed = 0;
+static uint64_t s_spdrAccessedAt = 0;
+static uint8_t s_isSpiBusy = 0;
+static uint8_t s_spiByte = 0;
+static uint64_t s_spiDoneAt = 0;
+static SimSpiHook_t s_spiHook = NULL;
+
+#define SIM_SOF_PERIOD_CYCLES       (1000 * SIM_CYCLES_PER_US)
+
+static SimIsrHook_t s_sofHook = NULL;
+static SimAtomicHook_t s_atomicBeginHook = NULL;
+static SimAtomicHook_t s_atomicEndHook = NULL;
+static uint64_t s_nextSofAt = 0;
+static uint8_t s_isSofPending = 0;
+
+static inline uint16_t _Timer1Value(void)
+{
+    return (uint16_t)(g_SimCycles - s_timer1Base);
+}
+
+// First compare match later than the cycle passed
+static uint64_t _Timer1NextCompareA(const uint64_t cycle)
+{
+    if (!s_isTimer1Running)
+        return UINT64_MAX;
+
+    // Normal mode: TOP is 0xFFFF, OCR1A only sets the phase of the match
+    int64_t first = s_timer1Base + OCR1A;
+    int64_t sinceFirst = (int64_t)cycle - first;
+    int64_t periods = (sinceFirst < 0) ? 0 : sinceFirst / 0x10000 + 1;
+
+    return (uint64_t)(first + periods * 0x10000);
+}
+
+static void _Timer1Sync(void)
+{
+    uint8_t isRunning = (TCCR1B & 0x07) != 0;
+
+    if ((TCCR1B & 0x07) > _BV(CS10))
+    {
+        fprintf(stderr, "SimAvr: Timer1 prescaler other than 1 is not supported\n");
+        exit(2);
+    }
+
+    if (s_tcnt1 != s_tcnt1Shadow)
+    {
+        // Firmware wrote TCNT1 since the last access
+        s_timer1Base = (int64_t)g_SimCycles - s_tcnt1;
+        s_timer1CheckedUntil = g_SimCycles;
+    }
+
+    if (isRunning != s_isTimer1Running)
+    {
+        if (isRunning)
+            s_timer1Base = (int64_t)g_SimCycles - s_tcnt1;
+        else
+            s_tcnt1 = _Timer1Value();
+
+        s_isTimer1Running = isRunning;
+        s_timer1CheckedUntil = g_SimCycles;
+    }
+
+    if (s_isTimer1Running)
+        s_tcnt1 = _Timer1Value();
+    s_tcnt1Shadow = s_tcnt1;
+
+    // Count compare matches which happened since the last sync
+    uint64_t match = _Timer1NextCompareA(s_timer1CheckedUntil);
+    if (match <= g_SimCycles)
+    {
+        uint32_t matches = (uint32_t)((g_SimCycles - match) / 0x10000 + 1);
+
+        if (s_isInTimer1Isr)
+            g_SimTimer1Stats.overruns += matches;
+
+        if (s_isCompareAPending)
+        {
+            g_SimTimer1Stats.missed += matches;
+        } else {
+            g_SimTimer1Stats.missed += matches - 1;
+            s_isCompareAPending = 1;
+            s_compareAPendingSince = match + (uint64_t)(matches - 1) * 0x10000;
+        }
+    }
+    s_timer1CheckedUntil = g_SimCycles;
+
+    if (s_isCompareAPending)
+        TIFR1 |= _BV(OCF1A);
+    else
+        TIFR1 &= (uint8_t)~_BV(OCF1A);
+}
+
+static void _SofSync(void)
+{
+    if (s_sofHook == NULL || g_SimCycles < s_nextSofAt)
+        return;
+
+    // Frames which came while the previous one was pending are lost
+    s_isSofPending = 1;
+    while (s_nextSofAt <= g_SimCycles)
+        s_nextSofAt += SIM_SOF_PERIOD_CYCLES;
+}
+
+// Next cycle when an interrupt source changes its state
+static uint64_t _NextEvent(const uint64_t cycle)
+{
+    uint64_t next = _Timer1NextCompareA(cycle);
+
+    if (s_sofHook != NULL && s_nextSofAt < next)
+        next = s_nextSofAt;
+
+    return next;
+}
+
+static uint32_t _SpiByteCycles(void)
+{
+    static const uint8_t Dividers[4] = { 4, 16, 64, 128 };
+
+    uint32_t cycles = 8UL * Dividers[SPCR & (_BV(SPR1) | _BV(SPR0))];
+
+    return (s_spsr & _BV(SPI2X)) ? cycles / 2 : cycles;
+}
+
+static void _SpiSync(void)
+{
+    if (s_isSpiBusy && g_SimCycles >= s_spiDoneAt)
+    {
+        s_isSpiBusy = 0;
+        s_spsr |= _BV(SPIF);
+
+        if (s_spiHook != NULL)
+            s_spiHook(s_spiByte);
+    }
+
+    if (s_isSpdrAccessed)
+    {
+        s_isSpdrAccessed = 0;
+
+        if ((SPCR & (_BV(SPE) | _BV(MSTR))) != (_BV(SPE) | _BV(MSTR)))
+            return;
+
+        if (SPCR & _BV(SPIE))
+        {
+            fprintf(stderr, "SimAvr: SPI interrupt is not supported\n");
+            exit(2);
+        }
+
+        if (s_isSpiBusy)
+        {
+            // Byte written during a transfer is lost
+            s_spsr |= _BV(WCOL);
+            return;
+        }
+
+        s_spsr &= (uint8_t)~(_BV(SPIF) | _BV(WCOL));
+        s_isSpiBusy = 1;
+        s_spiByte = s_spdr;
+        s_spiDoneAt = s_spdrAccessedAt + _SpiByteCycles();
+
+        // Sync again in case the byte is already out
+        _SpiSync();
+    }
+}
+
+static void _Timer1DispatchCompareA(void)
+{
+    uint64_t start = g_SimCycles;
+
+    if (g_SimTimer1Stats.calls)
+        g_SimTimer1Stats.periodCycles = (uint32_t)(start - s_lastIsrStart);
+    s_lastIsrStart = start;
+
+    uint32_t latency = (uint32_t)(start - s_compareAPendingSince);
+    if (latency > g_SimTimer1Stats.latencyMax)
+        g_SimTimer1Stats.latencyMax = latency;
+
+    // Hardware clears the flag and the I-bit on the interrupt entry
+    s_isCompareAPending = 0;
+    TIFR1 &= (uint8_t)~_BV(OCF1A);
+    s_isInterruptsEnabled = 0;
+    s_isInIsr = 1;
+    s_isInTimer1Isr = 1;
+    g_SimCycles += SIM_ISR_OVERHEAD_CYCLES / 2;
+
+    SimIsr_TIMER1_COMPA_vect();
+
+    g_SimCycles += SIM_ISR_OVERHEAD_CYCLES - SIM_ISR_OVERHEAD_CYCLES / 2;
+    _Timer1Sync();
+    s_isInTimer1Isr = 0;
+    s_isInIsr = 0;
+    s_isInterruptsEnabled = 1;
+
+    uint32_t cycles = (uint32_t)(g_SimCycles - start);
+
+    g_SimTimer1Stats.calls++;
+    g_SimTimer1Stats.cycles += cycles;
+    if (cycles > g_SimTimer1Stats.cyclesMax)
+        g_SimTimer1Stats.cyclesMax = cycles;
+}
+
+static void _SofDispatch(void)
+{
+    s_isSofPending = 0;
+    s_isInterruptsEnabled = 0;
+    s_isInIsr = 1;
+    g_SimCycles += SIM_ISR_OVERHEAD_CYCLES / 2;
+
+    s_sofHook();
+
+    g_SimCycles += SIM_ISR_OVERHEAD_CYCLES - SIM_ISR_OVERHEAD_CYCLES / 2;
+    s_isInIsr = 0;
+    s_isInterruptsEnabled = 1;
+}
+
+void SimAvr_Poll(void)
+{
+    _SpiSync();
+    _Timer1Sync();
+    _SofSync();
+
+    // A match which came during the ISR is served right after it, as on AVR
+    while (s_isInterruptsEnabled && !s_isInIsr)
+    {
+        if (s_isSofPending)
+            _SofDispatch();
+        else if (s_isCompareAPending && (TIMSK1 & _BV(OCIE1A)))
+            _Timer1DispatchCompareA();
+        else
+            break;
+
+        _Timer1Sync();
+        _SofSync();
+    }
+}
+
+static volatile uint8_t * _PortOfPin(volatile uint8_t *reg)
+{
+    if (reg == &PINB) return &PORTB;
+    if (reg == &PINC) return &PORTC;
+    if (reg == &PIND) return &PORTD;
+    return NULL;
+}
+
+static SimPortHook_t * _HookOfPort(volatile uint8_t *reg)
+{
+    if (reg == &PORTB) return &s_portHooks[0];
+    if (reg == &PORTC) return &s_portHooks[1];
+    if (reg == &PORTD) return &s_portHooks[2];
+    return NULL;
+}
+
+void SimAvr_BitWrite(volatile uint8_t *reg, const uint8_t bit, const uint8_t value)
+{
+    g_SimCycles += SIM_IO_CYCLES;
+
+    volatile uint8_t *port = _PortOfPin(reg);
+    if (port != NULL)
+    {
+        // Writing one to PINx toggles PORTx
+        if (!value)
+            return;
+        reg = port;
+    }
+
+    uint8_t oldValue = *reg;
+    uint8_t newValue;
+
+    if (port != NULL)
+        newValue = oldValue ^ (uint8_t)_BV(bit);
+    else if (value)
+        newValue = oldValue | (uint8_t)_BV(bit);
+    else
+        newValue = oldValue & (uint8_t)~_BV(bit);
+
+    *reg = newValue;
+
+    SimPortHook_t *hook = _HookOfPort(reg);
+    if (hook != NULL && *hook != NULL && oldValue != newValue)
+        (*hook)(oldValue, newValue);
+
+    SimAvr_Poll();
+}
+
+volatile uint16_t * SimAvr_Tcnt1(void)
+{
+    // 16-bit access goes through the TEMP register, two I/O instructions
+    g_SimCycles += 2 * SIM_IO_CYCLES;
+    SimAvr_Poll();
+
+    return &s_tcnt1;
+}
+
+volatile uint8_t * SimAvr_Spsr(void)
+{
+    g_SimCycles += SIM_IO_CYCLES;
+    SimAvr_Poll();
+
+    return &s_spsr;
+}
+
+volatile uint8_t * SimAvr_Spdr(void)
+{
+    g_SimCycles += SIM_IO_CYCLES;
+    SimAvr_Poll();
+
+    // Value is stored after the return, the transfer starts on the next poll
+    s_isSpdrAccessed = 1;
+    s_spdrAccessedAt = g_SimCycles;
+
+    return &s_spdr;
+}
+
+void SimAvr_Sei(void)
+{
+    g_SimCycles += 1;
+    s_isInterruptsEnabled = 1;
+    SimAvr_Poll();
+}
+
+void SimAvr_Cli(void)
+{
+    g_SimCycles += 1;
+    s_isInterruptsEnabled = 0;
+}
+
+uint8_t SimAvr_AtomicBegin(void)
+{
+    if (s_atomicBeginHook != NULL)
+        s_atomicBeginHook();
+
+    uint8_t isInterruptsEnabled = s_isInterruptsEnabled;
+
+    SimAvr_Cli();
+
+    return isInterruptsEnabled;
+}
+
+void SimAvr_AtomicEnd(const uint8_t isInterruptsEnabled)
+{
+    g_SimCycles += 1;
+    s_isInterruptsEnabled = isInterruptsEnabled;
+    SimAvr_Poll();
+
+    if (s_atomicEndHook != NULL)
+        s_atomicEndHook();
+}
+
+void SimAvr_Delay(const uint32_t cycles)
+{
+    // Busy loop: interrupts served meanwhile stretch it, as on AVR
+    uint32_t remaining = cycles;
+
+    SimAvr_Poll();
+    while (remaining > 0)
+    {
+        uint64_t step = remaining;
+        uint64_t match = _NextEvent(g_SimCycles);
+
+        if (match - g_SimCycles < step)
+            step = match - g_SimCycles;
+
+        g_SimCycles += step;
+        remaining -= (uint32_t)step;
+        SimAvr_Poll();
+    }
+}
+
+void SimAvr_SetPortHook(volatile uint8_t *port, SimPortHook_t hook)
+{
+    SimPortHook_t *slot = _HookOfPort(port);
+
+    if (slot != NULL)
+        *slot = hook;
+}
+
+void SimAvr_SetSpiHook(SimSpiHook_t hook)
+{
+    s_spiHook = hook;
+}
+
+void SimAvr_SetSofHook(SimIsrHook_t hook)
+{
+    if (s_sofHook == NULL)
+        s_nextSofAt = g_SimCycles + SIM_SOF_PERIOD_CYCLES;
+
+    s_sofHook = hook;
+}
+
+void SimAvr_SetAtomicHooks(SimAtomicHook_t begin, SimAtomicHook_t end)
+{
+    s_atomicBeginHook = begin;
+    s_atomicEndHook = end;
+}
+
+void SimAvr_AdvanceTo(const uint64_t cycle)
+{
+    SimAvr_Poll();
+    while (g_SimCycles < cycle)
+    {
+        uint64_t match = _NextEvent(g_SimCycles);
+
+        g_SimCycles = (match < cycle) ? match : cycle;
+        SimAvr_Poll();
+    }
+}
+
+uint64_t SimAvr_HostNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
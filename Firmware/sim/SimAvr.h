@@ -0,0 +1,100 @@
+/*
+ * SimAvr.h
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIMAVR_H_INCLUDED
+#define SIMAVR_H_INCLUDED
+
+#include <stdint.h>
+
+/*
+ *  Host model of the at90usb162 core as far as the firmware touches it.
+ *
+ *  Time is counted in CPU cycles. Only instructions with a known cost
+ *  advance it: I/O register accesses done through iodefs.h and TCNT1,
+ *  _delay_us()/_delay_ms() and the interrupt entry/exit. Plain C code takes
+ *  no simulated time, SimMain.c benchmarks it on the host instead.
+ *
+ *  Timer1 runs from the CPU clock (prescaler 1) and raises TIMER1_COMPA_vect
+ *  when TCNT1 passes OCR1A. OCF1A in TIFR1 shows a pending match, but
+ *  writing it does not clear the match, it is served after the ISR anyway.
+ *  USB start of frame interrupt comes every 1 ms once enabled and is served
+ *  before Timer1, as USB_GEN_vect has the higher priority. SPI master shifts a byte out in 8 SCK periods
+ *  and sets SPIF; the SPI interrupt is not modeled. Interrupts are dispatched at every simulator
+ *  call (pin change, TCNT1 access, delay, USB task), never in the middle of
+ *  plain C code.
+ */
+
+#define SIM_F_CPU                   16000000UL
+
+// SBI, CBI, IN and OUT take 2 cycles on AVR8
+#define SIM_IO_CYCLES               2
+// Vector jump, prologue saving call-clobbered registers of an ISR which
+// calls an external function, epilogue and RETI (avr-gcc -Os estimate)
+#define SIM_ISR_OVERHEAD_CYCLES     80
+
+#define SIM_CYCLES_PER_US           (SIM_F_CPU / 1000000UL)
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t overruns;          // compare matches which came while the ISR was still running
+    uint32_t missed;            // compare matches lost because the previous one was still pending
+    uint64_t cycles;            // simulated cycles spent in the ISR, sum
+    uint32_t cyclesMax;
+    uint32_t periodCycles;      // between the last two ISR starts
+    uint32_t latencyMax;        // cycles from the compare match to the ISR start
+
+} SimIsrStats_t;
+
+typedef void (*SimPortHook_t)(const uint8_t oldValue, const uint8_t newValue);
+typedef void (*SimSpiHook_t)(const uint8_t byte);
+typedef void (*SimIsrHook_t)(void);
+typedef void (*SimAtomicHook_t)(void);
+
+extern uint64_t g_SimCycles;
+extern SimIsrStats_t g_SimTimer1Stats;
+
+// Called by the firmware side mocks
+void SimAvr_BitWrite(volatile uint8_t *reg, const uint8_t bit, const uint8_t value);
+volatile uint16_t * SimAvr_Tcnt1(void);
+volatile uint8_t * SimAvr_Spsr(void);
+volatile uint8_t * SimAvr_Spdr(void);
+void SimAvr_Sei(void);
+void SimAvr_Cli(void);
+uint8_t SimAvr_AtomicBegin(void);
+void SimAvr_AtomicEnd(const uint8_t isInterruptsEnabled);
+void SimAvr_Delay(const uint32_t cycles);
+
+// Called by the simulator
+void SimAvr_SetPortHook(volatile uint8_t *port, SimPortHook_t hook);
+// Called when a byte is shifted out completely
+void SimAvr_SetSpiHook(SimSpiHook_t hook);
+// Body of the USB start of frame interrupt
+void SimAvr_SetSofHook(SimIsrHook_t hook);
+// Called when ATOMIC_BLOCK is entered and left, the stress test holds off its ISR meanwhile
+void SimAvr_SetAtomicHooks(SimAtomicHook_t begin, SimAtomicHook_t end);
+void SimAvr_AdvanceTo(const uint64_t cycle);
+void SimAvr_Poll(void);
+uint64_t SimAvr_HostNs(void);
+
+#endif /* SIMAVR_H_INCLUDED */
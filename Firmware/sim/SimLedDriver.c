@@ -0,0 +1,127 @@
+/*
+ * SimLedDriver.c
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include <avr/io.h>
+#include "SimAvr.h"
+#include "SimLedDriver.h"
+
+#if (LIGHTPACK_HW < 6)
+#   error "Led driver model is for hardware 6.x and newer only"
+#endif
+
+// LATCH is PB0 as in LedDriver.c, SCK and MOSI are driven by the SPI
+#define LATCH_BIT   0
+
+#define CHANNELS_PER_DRIVER     16
+#define DRIVERS_COUNT           2
+#define CHAIN_WORDS             (CHANNELS_PER_DRIVER * DRIVERS_COUNT)
+#define CHAIN_BITS              (CHAIN_WORDS * 12)
+
+static const uint8_t LedsNumberForOneDriver = 5;
+
+RGB_t g_SimLeds[LEDS_COUNT];
+SimLedDriverStats_t g_SimLedDriverStats = { };
+
+// Last CHAIN_BITS bits shifted in, s_chainHead points to the oldest one
+static uint8_t s_chain[CHAIN_BITS];
+static uint16_t s_chainHead = 0;
+static uint32_t s_bitsSinceLatch = 0;
+static FILE *s_waveform = NULL;
+
+static uint16_t _ChainWord(const uint8_t word)
+{
+    uint16_t value = 0;
+
+    for (uint16_t bit = 0; bit < 12; bit++)
+        value = (uint16_t)(value << 1) | s_chain[(s_chainHead + word * 12 + bit) % CHAIN_BITS];
+
+    return value;
+}
+
+static void _Latch(void)
+{
+    // Words in shift order, see LedDriver_Update():
+    // 0 B G R (leds 6..10) 0 B G R (leds 1..5)
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        uint8_t word = (i < LedsNumberForOneDriver) ?
+                    CHANNELS_PER_DRIVER + 1 + 3 * i :
+                    1 + 3 * (i - LedsNumberForOneDriver);
+
+        g_SimLeds[i].b = _ChainWord(word);
+        g_SimLeds[i].g = _ChainWord(word + 1);
+        g_SimLeds[i].r = _ChainWord(word + 2);
+    }
+
+    g_SimLedDriverStats.latches++;
+    if (s_bitsSinceLatch < CHAIN_BITS)
+        g_SimLedDriverStats.partialLatches++;
+    s_bitsSinceLatch = 0;
+
+    if (s_waveform != NULL)
+    {
+        fprintf(s_waveform, "%.3f", (double)g_SimCycles / SIM_CYCLES_PER_US);
+        for (uint8_t i = 0; i < LEDS_COUNT; i++)
+            fprintf(s_waveform, ",%u,%u,%u", g_SimLeds[i].r, g_SimLeds[i].g, g_SimLeds[i].b);
+        fprintf(s_waveform, "\n");
+    }
+}
+
+static void _SpiByteShifted(const uint8_t byte)
+{
+    // MSB first
+    for (uint8_t bit = 0x80; bit != 0; bit >>= 1)
+    {
+        s_chain[s_chainHead] = (byte & bit) ? 1 : 0;
+        s_chainHead = (s_chainHead + 1) % CHAIN_BITS;
+        s_bitsSinceLatch++;
+    }
+}
+
+static void _PortBChanged(const uint8_t oldValue, const uint8_t newValue)
+{
+    if (~oldValue & newValue & _BV(LATCH_BIT))
+        _Latch();
+}
+
+void SimLedDriver_Init(FILE *waveform)
+{
+    memset(g_SimLeds, 0, sizeof(g_SimLeds));
+    memset(s_chain, 0, sizeof(s_chain));
+    s_chainHead = 0;
+    s_bitsSinceLatch = 0;
+
+    s_waveform = waveform;
+    if (s_waveform != NULL)
+    {
+        fprintf(s_waveform, "time_us");
+        for (uint8_t i = 1; i <= LEDS_COUNT; i++)
+            fprintf(s_waveform, ",led%u_r,led%u_g,led%u_b", i, i, i);
+        fprintf(s_waveform, "\n");
+    }
+
+    SimAvr_SetPortHook(&PORTB, _PortBChanged);
+    SimAvr_SetSpiHook(_SpiByteShifted);
+}
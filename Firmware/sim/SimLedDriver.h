@@ -0,0 +1,52 @@
+/*
+ * SimLedDriver.h
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIMLEDDRIVER_H_INCLUDED
+#define SIMLEDDRIVER_H_INCLUDED
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "datatypes.h"
+#include "../CommonHeaders/LEDS_COUNT.h"
+
+/*
+ *  Model of the two daisy chained 16 channel 12-bit LED drivers of
+ *  hardware 6.x/7.x. The chain is fed by the SPI and shows what was
+ *  shifted in last when LATCH (PB0) rises.
+ */
+
+typedef struct
+{
+    uint32_t latches;
+    uint32_t partialLatches;    // latched with less than the full chain shifted in
+
+} SimLedDriverStats_t;
+
+extern RGB_t g_SimLeds[LEDS_COUNT];
+extern SimLedDriverStats_t g_SimLedDriverStats;
+
+// waveform: CSV of the latched values, one line per latch, may be NULL
+void SimLedDriver_Init(FILE *waveform);
+
+#endif /* SIMLEDDRIVER_H_INCLUDED */
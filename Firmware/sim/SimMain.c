@@ -0,0 +1,248 @@
+/*
+ * SimMain.c
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Host simulator of the Lightpack firmware, see README.md in the
+ *  repository root for the usage.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Lightpack.h"
+#include "LedManager.h"
+#include "LedDriver.h"
+#include "../CommonHeaders/COMMANDS.h"
+#include "SimAvr.h"
+#include "SimLedDriver.h"
+#include "SimStress.h"
+#include "SimUsb.h"
+
+// Lightpack.c main() is built as Lightpack_Main()
+extern int Lightpack_Main(void);
+extern void EvalCurrentImage_SmoothlyAlg(void);
+extern USB_ClassInfo_HID_Device_t Generic_HID_Interface;
+
+static void _Usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-c] [-w waveform.csv] [-t tail_ms] [-b iterations] stream.txt\n"
+            "       %s [-c] [-w waveform.csv] -s frames\n"
+            "  -c  exit with an error if an expectation failed or the ISR overran\n"
+            "  -w  write latched LED values to CSV\n"
+            "  -t  keep running after the last event, default 100 ms\n"
+            "  -b  EvalCurrentImage_SmoothlyAlg() benchmark iterations, default 100000, 0 to skip\n"
+            "  -s  tearing stress test with the ISR called from a signal, see SimStress.h\n",
+            name, name);
+}
+
+static const RGB_t BenchStart = { 0x123, 0x456, 0x789 };
+
+static double _BenchSmoothlyAlg(const uint32_t iterations, const uint8_t isTransition)
+{
+    uint64_t start = SimAvr_HostNs();
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        // Keep all LEDs in the middle of the smooth change
+        if (isTransition && (i % 128) == 0)
+        {
+            LedManager_BeginFrame();
+            for (uint8_t led = 0; led < LEDS_COUNT; led++)
+            {
+                RGB_t end = { 0xfff - led, 0x800 + led, led };
+
+                g_Images.current[led] = BenchStart;
+                LedManager_ChangeColor(led, &end);
+            }
+            LedManager_EndFrame();
+            LedManager_SwapImages();
+        }
+
+        EvalCurrentImage_SmoothlyAlg();
+    }
+
+    return (double)(SimAvr_HostNs() - start) / iterations;
+}
+
+static void _Bench(const uint32_t iterations)
+{
+    Images_t images = g_Images;
+    Settings_t settings = g_Settings;
+
+    // Timer1 interrupt would change the images in the middle
+    SimAvr_Cli();
+
+    g_Settings.isSmoothEnabled = true;
+    g_Settings.smoothSlowdown = 255;
+
+    LedManager_FillImages(0, 0, 0);
+    double settledNs = _BenchSmoothlyAlg(iterations, 0);
+    double transitionNs = _BenchSmoothlyAlg(iterations, 1);
+
+    printf("EvalCurrentImage_SmoothlyAlg: settled %.1f ns, transition %.1f ns (host, %u calls)\n",
+           settledNs, transitionNs, iterations);
+
+    g_Images = images;
+    g_Settings = settings;
+}
+
+static uint32_t _Stress(const uint32_t frames)
+{
+    static const uint8_t SmoothSlowdowns[] = { 0, 5 };
+    uint32_t failures = 0;
+
+    LedDriver_Init();
+
+    for (uint8_t i = 0; i < sizeof(SmoothSlowdowns); i++)
+    {
+        failures += SimStress_Run(frames, SmoothSlowdowns[i]);
+
+        const SimStressStats_t *stats = &g_SimStressStats;
+
+        printf("Stress, smooth slowdown %u: %u frames, %u ISR ticks (%u during reports), %u latches, %u torn, last frame %s\n",
+               SmoothSlowdowns[i], stats->frames, stats->ticks, stats->ticksInFrames, stats->latches,
+               stats->tornLatches, stats->wrongLastFrames ? "wrong" : "ok");
+    }
+
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    uint8_t isCheck = 0;
+    const char *waveformPath = NULL;
+    unsigned long tailMs = 100;
+    unsigned long benchIterations = 100000;
+    unsigned long stressFrames = 0;
+    int option;
+
+    while ((option = getopt(argc, argv, "cw:t:b:s:")) != -1)
+    {
+        switch (option)
+        {
+        case 'c': isCheck = 1; break;
+        case 'w': waveformPath = optarg; break;
+        case 't': tailMs = strtoul(optarg, NULL, 10); break;
+        case 'b': benchIterations = strtoul(optarg, NULL, 10); break;
+        case 's': stressFrames = strtoul(optarg, NULL, 10); break;
+        default:
+            _Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind != argc - (stressFrames ? 0 : 1))
+    {
+        _Usage(argv[0]);
+        return 2;
+    }
+
+    if (stressFrames)
+    {
+        FILE *waveform = NULL;
+        if (waveformPath != NULL && (waveform = fopen(waveformPath, "w")) == NULL)
+        {
+            perror(waveformPath);
+            return 2;
+        }
+        SimLedDriver_Init(waveform);
+
+        uint32_t failures = _Stress((uint32_t)stressFrames);
+
+        if (waveform != NULL)
+            fclose(waveform);
+
+        if (isCheck && failures)
+        {
+            printf("FAILED\n");
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (SimUsb_Load(argv[optind]) < 0)
+        return 2;
+    SimUsb_SetTail((uint64_t)tailMs * 1000 * SIM_CYCLES_PER_US);
+
+    FILE *waveform = NULL;
+    if (waveformPath != NULL && (waveform = fopen(waveformPath, "w")) == NULL)
+    {
+        perror(waveformPath);
+        return 2;
+    }
+    SimLedDriver_Init(waveform);
+
+    uint8_t version[GENERIC_REPORT_SIZE] = { };
+    uint16_t versionSize = 0;
+    uint8_t reportId = 0;
+    CALLBACK_HID_Device_CreateHIDReport(&Generic_HID_Interface, &reportId, HID_REPORT_ITEM_In,
+                                        version, &versionSize);
+
+    printf("Lightpack firmware %u.%u, simulating %s\n",
+           version[INDEX_FW_VER_MAJOR], version[INDEX_FW_VER_MINOR], argv[optind]);
+
+    if (setjmp(g_SimExit) == 0)
+        Lightpack_Main();
+
+    if (waveform != NULL)
+        fclose(waveform);
+
+    const SimIsrStats_t *isr = &g_SimTimer1Stats;
+    uint32_t cyclesAvg = isr->calls ? (uint32_t)(isr->cycles / isr->calls) : 0;
+    double periodPercent = isr->periodCycles ? 100.0 * isr->cyclesMax / isr->periodCycles : 0;
+
+    printf("Simulated %.3f ms\n", (double)g_SimCycles / SIM_CYCLES_PER_US / 1000);
+    printf("Reports: %u, late %u, max delivery delay %.1f us\n",
+           g_SimUsbStats.reports, g_SimUsbStats.lateReports,
+           (double)g_SimUsbStats.deliveryDelayMax / SIM_CYCLES_PER_US);
+    printf("TIMER1_COMPA ISR: %u calls, period %u cycles (%.1f us)\n",
+           isr->calls, isr->periodCycles, (double)isr->periodCycles / SIM_CYCLES_PER_US);
+    printf("  cycles avg %u, max %u (%.1f%% of period), max latency %u\n",
+           cyclesAvg, isr->cyclesMax, periodPercent, isr->latencyMax);
+    printf("  overruns %u, missed %u\n", isr->overruns, isr->missed);
+    printf("LED driver: %u latches, %u partial\n",
+           g_SimLedDriverStats.latches, g_SimLedDriverStats.partialLatches);
+    SimTelemetry_t telemetry;
+    SimUsb_ReadTelemetry(&telemetry);
+    printf("Telemetry: %u frames received, %u applied %u ms ago, %u merged, %u reports dropped, %u ISR overruns\n",
+           telemetry.framesReceived, telemetry.frameApplied, telemetry.frameAppliedAge,
+           telemetry.framesMerged, telemetry.reportsDropped, telemetry.isrOverruns);
+    printf("Expectations: %u, failed %u\n", g_SimUsbStats.expects, g_SimUsbStats.failedExpects);
+
+    if (benchIterations > 0)
+        _Bench((uint32_t)benchIterations);
+
+    if (isCheck && (g_SimUsbStats.failedExpects || isr->overruns || isr->missed || telemetry.isrOverruns))
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
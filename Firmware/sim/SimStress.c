@@ -0,0 +1,221 @@
+/*
+ * SimStress.c
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "Lightpack.h"
+#include "../CommonHeaders/COMMANDS.h"
+#include "SimAvr.h"
+#include "SimLedDriver.h"
+#include "SimStress.h"
+
+// Lightpack.c: ISR( TIMER1_COMPA_vect )
+extern void SimIsr_TIMER1_COMPA_vect(void);
+extern USB_ClassInfo_HID_Device_t Generic_HID_Interface;
+
+SimStressStats_t g_SimStressStats = { };
+
+static volatile sig_atomic_t s_atomicDepth = 0;
+static volatile sig_atomic_t s_isInIsr = 0;
+static volatile sig_atomic_t s_isTickPending = 0;
+static volatile sig_atomic_t s_isInFrame = 0;
+
+static uint8_t _IsTorn(void)
+{
+    for (uint8_t i = 1; i < LEDS_COUNT; i++)
+    {
+        if (memcmp(&g_SimLeds[i], &g_SimLeds[0], sizeof(RGB_t)) != 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+static void _Tick(void)
+{
+    do {
+        s_isTickPending = 0;
+        s_isInIsr = 1;
+
+        uint32_t latches = g_SimLedDriverStats.latches;
+
+        SimIsr_TIMER1_COMPA_vect();
+
+        g_SimStressStats.ticks++;
+        if (s_isInFrame)
+            g_SimStressStats.ticksInFrames++;
+
+        if (g_SimLedDriverStats.latches != latches)
+        {
+            g_SimStressStats.latches++;
+            if (_IsTorn())
+                g_SimStressStats.tornLatches++;
+        }
+
+        s_isInIsr = 0;
+
+    // Signal which came during the ISR is served right after it
+    } while (s_isTickPending);
+}
+
+static void _TimerSignal(int signal)
+{
+    (void)signal;
+
+    if (s_atomicDepth > 0 || s_isInIsr)
+        s_isTickPending = 1;
+    else
+        _Tick();
+}
+
+static void _AtomicBegin(void)
+{
+    s_atomicDepth++;
+}
+
+static void _AtomicEnd(void)
+{
+    // Interrupt which came during ATOMIC_BLOCK is served right after it
+    if (--s_atomicDepth == 0 && s_isTickPending && !s_isInIsr)
+        _Tick();
+}
+
+static void _StartTimer(const long intervalUs)
+{
+    struct itimerval timer = { { 0, intervalUs }, { 0, intervalUs } };
+
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+// Same as _Unpack12() of LightpackUSB.c
+static void _Pack12(uint8_t *data, const uint8_t index, const uint16_t value)
+{
+    uint8_t *packed = data + index + (index >> 1);
+
+    if (index & 1)
+    {
+        packed[0] = (packed[0] & 0xf0) | (value >> 8);
+        packed[1] = value & 0xff;
+    } else {
+        packed[0] = value >> 4;
+        packed[1] = (packed[1] & 0x0f) | ((value & 0x0f) << 4);
+    }
+}
+
+// Far apart colors of the successive frames
+static uint16_t _FrameValue(const uint32_t frame)
+{
+    return (uint16_t)((frame * 0x2c9 + 0x17) & 0xfff);
+}
+
+static uint16_t _CreateReport(uint8_t *report, const uint32_t frame)
+{
+    uint16_t value = _FrameValue(frame);
+    uint8_t *data = report + 1;
+
+    memset(report, 0, GENERIC_REPORT_SIZE);
+
+    switch (frame % 3)
+    {
+    case 0:
+        report[0] = CMD_UPDATE_LEDS;
+        for (uint8_t i = 0; i < LEDS_COUNT; i++, data += 6)
+        {
+            data[0] = data[1] = data[2] = value >> 4;
+            data[3] = data[4] = data[5] = value & 0x0f;
+        }
+        return 1 + 6 * LEDS_COUNT;
+
+    case 1:
+        report[0] = CMD_UPDATE_LEDS_PACKED;
+        for (uint8_t i = 0; i < 3 * LEDS_COUNT; i++)
+            _Pack12(data, i, value);
+        return 1 + (3 * 3 * LEDS_COUNT + 1) / 2;
+
+    default:
+        report[0] = CMD_FILL_LEDS;
+        for (uint8_t i = 0; i < 3; i++)
+            _Pack12(data, i, value);
+        return 1 + 5;
+    }
+}
+
+static void _SendReport(const uint8_t *report, const uint16_t size)
+{
+    s_isInFrame = 1;
+    CALLBACK_HID_Device_ProcessHIDReport(&Generic_HID_Interface, 0, HID_REPORT_ITEM_Out, report, size);
+    s_isInFrame = 0;
+}
+
+uint32_t SimStress_Run(const uint32_t frames, const uint8_t smoothSlowdown)
+{
+    uint8_t report[GENERIC_REPORT_SIZE];
+    struct sigaction action;
+
+    memset(&g_SimStressStats, 0, sizeof(g_SimStressStats));
+
+    report[0] = CMD_SET_SMOOTH_SLOWDOWN;
+    report[1] = smoothSlowdown;
+    _SendReport(report, 2);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = _TimerSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+
+    SimAvr_SetAtomicHooks(_AtomicBegin, _AtomicEnd);
+    _StartTimer(SIM_STRESS_TICK_US);
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        uint16_t size = _CreateReport(report, frame);
+
+        _SendReport(report, size);
+        g_SimStressStats.frames++;
+    }
+
+    _StartTimer(0);
+    SimAvr_SetAtomicHooks(NULL, NULL);
+    signal(SIGALRM, SIG_DFL);
+
+    // Smooth change of the last frame completes, then the LED drivers are updated
+    for (uint16_t i = 0; i < smoothSlowdown + 2; i++)
+        _Tick();
+
+    uint16_t last = _FrameValue(frames - 1);
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        if (g_SimLeds[i].r != last || g_SimLeds[i].g != last || g_SimLeds[i].b != last)
+        {
+            g_SimStressStats.wrongLastFrames++;
+            break;
+        }
+    }
+
+    return g_SimStressStats.tornLatches + g_SimStressStats.wrongLastFrames;
+}
@@ -0,0 +1,61 @@
+/*
+ * SimStress.h
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIMSTRESS_H_INCLUDED
+#define SIMSTRESS_H_INCLUDED
+
+#include <stdint.h>
+
+/*
+ *  Tearing stress test. The Timer1 ISR is called from a SIGALRM handler
+ *  every SIM_STRESS_TICK_US of host time, so it comes between any two
+ *  instructions of the report processing, as a real interrupt does. Inside
+ *  ATOMIC_BLOCK it is held off and called when the block is left, as with
+ *  the I-bit on AVR. The main code sends colors reports back to back, far
+ *  above the 1 ms USB report rate. Every frame puts the same color on all
+ *  LEDs, in turn as CMD_UPDATE_LEDS, CMD_UPDATE_LEDS_PACKED and
+ *  CMD_FILL_LEDS, so a latch with different LED colors shows a torn frame.
+ *
+ *  Simulated time is not used, the test runs as fast as the host does.
+ */
+
+#define SIM_STRESS_TICK_US      5
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t ticks;             // ISR calls
+    uint32_t ticksInFrames;     // came while a report was processed
+    uint32_t latches;
+    uint32_t tornLatches;       // LEDs showed different colors
+    uint32_t wrongLastFrames;   // LEDs did not settle on the last frame
+
+} SimStressStats_t;
+
+extern SimStressStats_t g_SimStressStats;
+
+// Runs the firmware with smoothSlowdown, 0 is without smoothing,
+// returns the number of torn latches and wrong last frames
+uint32_t SimStress_Run(const uint32_t frames, const uint8_t smoothSlowdown);
+
+#endif /* SIMSTRESS_H_INCLUDED */
@@ -0,0 +1,362 @@
+/*
+ * SimUsb.c
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <LUFA/Drivers/USB/USB.h>
+#include "Descriptors.h"
+#include "SimAvr.h"
+#include "SimLedDriver.h"
+#include "SimUsb.h"
+
+#include "../../CommonHeaders/COMMANDS.h"
+
+typedef enum
+{
+    SimEvent_Report,
+    SimEvent_Expect,
+    SimEvent_Telemetry,
+    SimEvent_Applied,
+
+} SimEventType_t;
+
+typedef struct
+{
+    uint64_t time;      // cycles
+    SimEventType_t type;
+    uint16_t size;
+    uint8_t data[GENERIC_REPORT_SIZE];
+    uint16_t expected[4];   // led, r, g, b, telemetry counters or sequence
+
+} SimEvent_t;
+
+// LightpackUSB.c
+extern USB_ClassInfo_HID_Device_t Generic_HID_Interface;
+
+SimUsbStats_t g_SimUsbStats = { };
+jmp_buf g_SimExit;
+
+volatile uint8_t USB_DeviceState = DEVICE_STATE_Unattached;
+
+static SimEvent_t *s_events = NULL;
+static size_t s_eventsCount = 0;
+static size_t s_nextEvent = 0;
+static uint64_t s_tail = 0;
+
+static int _ParseLine(char *line, SimEvent_t *event)
+{
+    char *comment = strchr(line, '#');
+    if (comment != NULL)
+        *comment = '\0';
+
+    char *token = strtok(line, " \t\r\n");
+    if (token == NULL)
+        return 0;
+
+    char *end;
+    unsigned long long time = strtoull(token, &end, 10);
+    if (*end != '\0')
+        return -1;
+
+    memset(event, 0, sizeof(*event));
+    event->time = time * SIM_CYCLES_PER_US;
+
+    token = strtok(NULL, " \t\r\n");
+    if (token == NULL)
+        return -1;
+
+    if (strcmp(token, "report") == 0)
+    {
+        event->type = SimEvent_Report;
+        while ((token = strtok(NULL, " \t\r\n")) != NULL)
+        {
+            unsigned long byte = strtoul(token, &end, 16);
+            if (*end != '\0' || byte > 0xff || event->size >= GENERIC_REPORT_SIZE)
+                return -1;
+            event->data[event->size++] = (uint8_t)byte;
+        }
+        if (event->size == 0)
+            return -1;
+    }
+    else if (strcmp(token, "expect") == 0)
+    {
+        event->type = SimEvent_Expect;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            token = strtok(NULL, " \t\r\n");
+            if (token == NULL)
+                return -1;
+            unsigned long value = strtoul(token, &end, 0);
+            if (*end != '\0' || value > 0xfff)
+                return -1;
+            event->expected[i] = (uint16_t)value;
+        }
+        if (event->expected[0] < 1 || event->expected[0] > LEDS_COUNT)
+            return -1;
+    }
+    else if (strcmp(token, "telemetry") == 0)
+    {
+        event->type = SimEvent_Telemetry;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            token = strtok(NULL, " \t\r\n");
+            if (token == NULL)
+                return -1;
+            unsigned long value = strtoul(token, &end, 0);
+            if (*end != '\0' || value > 0xffff)
+                return -1;
+            event->expected[i] = (uint16_t)value;
+        }
+    }
+    else if (strcmp(token, "applied") == 0)
+    {
+        event->type = SimEvent_Applied;
+        token = strtok(NULL, " \t\r\n");
+        if (token == NULL)
+            return -1;
+        unsigned long value = strtoul(token, &end, 0);
+        if (*end != '\0' || value > 0xffff)
+            return -1;
+        event->expected[0] = (uint16_t)value;
+    } else {
+        return -1;
+    }
+
+    return 1;
+}
+
+int SimUsb_Load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    char line[1024];
+    unsigned lineNumber = 0;
+    size_t capacity = 0;
+    uint64_t lastTime = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+
+        if (s_eventsCount == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 256;
+            s_events = realloc(s_events, capacity * sizeof(SimEvent_t));
+            if (s_events == NULL)
+            {
+                perror("realloc");
+                exit(2);
+            }
+        }
+
+        int result = _ParseLine(line, &s_events[s_eventsCount]);
+        if (result == 0)
+            continue;
+
+        if (result < 0 || s_events[s_eventsCount].time < lastTime)
+        {
+            fprintf(stderr, "%s:%u: bad event\n", path, lineNumber);
+            fclose(file);
+            return -1;
+        }
+
+        lastTime = s_events[s_eventsCount].time;
+        s_eventsCount++;
+    }
+
+    fclose(file);
+    s_nextEvent = 0;
+
+    return 0;
+}
+
+void SimUsb_SetTail(const uint64_t cycles)
+{
+    s_tail = cycles;
+}
+
+static void _Expect(const SimEvent_t *event)
+{
+    const uint16_t *expected = event->expected;
+    const RGB_t *led = &g_SimLeds[expected[0] - 1];
+
+    g_SimUsbStats.expects++;
+
+    if (led->r != expected[1] || led->g != expected[2] || led->b != expected[3])
+    {
+        g_SimUsbStats.failedExpects++;
+        fprintf(stderr, "%.3f us: led %u is %u %u %u, expected %u %u %u\n",
+                (double)g_SimCycles / SIM_CYCLES_PER_US, expected[0],
+                led->r, led->g, led->b, expected[1], expected[2], expected[3]);
+    }
+}
+
+static uint16_t _Get16(const uint8_t *data, const uint8_t index)
+{
+    return data[index] | ((uint16_t)data[index + 1] << 8);
+}
+
+void SimUsb_ReadTelemetry(SimTelemetry_t *telemetry)
+{
+    uint8_t data[GENERIC_REPORT_SIZE] = { };
+    uint16_t size = 0;
+    uint8_t reportId = 0;
+
+    // GET_REPORT of the Feature report type
+    CALLBACK_HID_Device_CreateHIDReport(&Generic_HID_Interface, &reportId, HID_REPORT_ITEM_Feature,
+                                        data, &size);
+
+    telemetry->framesReceived = _Get16(data, INDEX_TELEMETRY_FRAMES_RECEIVED);
+    telemetry->frameApplied = _Get16(data, INDEX_TELEMETRY_FRAME_APPLIED);
+    telemetry->frameAppliedAge = _Get16(data, INDEX_TELEMETRY_SOF) - _Get16(data, INDEX_TELEMETRY_FRAME_APPLIED_SOF);
+    telemetry->isrOverruns = _Get16(data, INDEX_TELEMETRY_ISR_OVERRUNS);
+    telemetry->framesMerged = _Get16(data, INDEX_TELEMETRY_FRAMES_MERGED);
+    telemetry->reportsDropped = _Get16(data, INDEX_TELEMETRY_REPORTS_DROPPED);
+}
+
+static void _ExpectTelemetry(const SimEvent_t *event)
+{
+    const uint16_t *expected = event->expected;
+    SimTelemetry_t telemetry;
+
+    SimUsb_ReadTelemetry(&telemetry);
+
+    g_SimUsbStats.expects++;
+
+    if (telemetry.framesReceived != expected[0] || telemetry.frameApplied != expected[1] ||
+            telemetry.framesMerged != expected[2] || telemetry.reportsDropped != expected[3])
+    {
+        g_SimUsbStats.failedExpects++;
+        fprintf(stderr, "%.3f us: telemetry is %u %u %u %u, expected %u %u %u %u\n",
+                (double)g_SimCycles / SIM_CYCLES_PER_US,
+                telemetry.framesReceived, telemetry.frameApplied,
+                telemetry.framesMerged, telemetry.reportsDropped,
+                expected[0], expected[1], expected[2], expected[3]);
+    }
+}
+
+static void _ExpectApplied(const SimEvent_t *event)
+{
+    uint8_t data[GENERIC_REPORT_SIZE] = { };
+    uint16_t size = 0;
+    uint8_t reportId = 0;
+
+    // Input report the host gets on every poll of the IN endpoint
+    CALLBACK_HID_Device_CreateHIDReport(&Generic_HID_Interface, &reportId, HID_REPORT_ITEM_In,
+                                        data, &size);
+
+    const uint16_t applied = _Get16(data, INDEX_APPLIED_SEQUENCE);
+
+    g_SimUsbStats.expects++;
+
+    if (applied != event->expected[0])
+    {
+        g_SimUsbStats.failedExpects++;
+        fprintf(stderr, "%.3f us: applied sequence is %u, expected %u\n",
+                (double)g_SimCycles / SIM_CYCLES_PER_US, applied, event->expected[0]);
+    }
+}
+
+void USB_Init(void)
+{
+    USB_DeviceState = DEVICE_STATE_Configured;
+
+    EVENT_USB_Device_Connect();
+    EVENT_USB_Device_ConfigurationChanged();
+}
+
+void USB_USBTask(void)
+{
+}
+
+void USB_Device_EnableSOFEvents(void)
+{
+    SimAvr_SetSofHook(EVENT_USB_Device_StartOfFrame);
+}
+
+void HID_Device_USBTask(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo)
+{
+    if (s_nextEvent >= s_eventsCount)
+    {
+        uint64_t end = (s_eventsCount ? s_events[s_eventsCount - 1].time : 0) + s_tail;
+
+        SimAvr_AdvanceTo(end);
+        longjmp(g_SimExit, 1);
+    }
+
+    const SimEvent_t *event = &s_events[s_nextEvent++];
+
+    SimAvr_AdvanceTo(event->time);
+
+    switch (event->type)
+    {
+    case SimEvent_Report:
+    {
+        uint32_t delay = (uint32_t)(g_SimCycles - event->time);
+
+        g_SimUsbStats.reports++;
+        if (delay > g_SimUsbStats.deliveryDelayMax)
+            g_SimUsbStats.deliveryDelayMax = delay;
+        if (delay > 1000 * SIM_CYCLES_PER_US)
+            g_SimUsbStats.lateReports++;
+
+        CALLBACK_HID_Device_ProcessHIDReport(HIDInterfaceInfo, 0, HID_REPORT_ITEM_Out,
+                                             event->data, event->size);
+        break;
+    }
+    case SimEvent_Expect:
+        _Expect(event);
+        break;
+
+    case SimEvent_Telemetry:
+        _ExpectTelemetry(event);
+        break;
+
+    case SimEvent_Applied:
+        _ExpectApplied(event);
+        break;
+    }
+}
+
+bool HID_Device_ConfigureEndpoints(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo)
+{
+    (void)HIDInterfaceInfo;
+    return true;
+}
+
+void HID_Device_ProcessControlRequest(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo)
+{
+    (void)HIDInterfaceInfo;
+}
+
+void HID_Device_MillisecondElapsed(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo)
+{
+    (void)HIDInterfaceInfo;
+}
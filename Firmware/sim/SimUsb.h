@@ -0,0 +1,80 @@
+/*
+ * SimUsb.h
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIMUSB_H_INCLUDED
+#define SIMUSB_H_INCLUDED
+
+#include <setjmp.h>
+#include <stdint.h>
+
+/*
+ *  Replays a recorded stream of HID reports into the firmware.
+ *
+ *  Stream is a text file, one event per line, times in microseconds from
+ *  the power on and never decreasing:
+ *
+ *      <time> report <byte> <byte> ...     HID OUT report of that size, bytes in hex
+ *      <time> expect <led> <r> <g> <b>     LED driver shows these 12-bit values,
+ *                                          led is 1-based as in Prismatik
+ *      <time> telemetry <received> <applied> <merged> <dropped>
+ *                                          telemetry feature report has these
+ *                                          counters, see COMMANDS.h
+ *      <time> applied <sequence>           input report has this frame sequence
+ *  Everything after '#' is a comment.
+ *
+ *  Every HID_Device_USBTask() call from the firmware main loop takes the
+ *  next event. When the stream is over the simulator runs for the tail time
+ *  and leaves the firmware main loop with longjmp(g_SimExit).
+ */
+
+typedef struct
+{
+    uint32_t reports;
+    uint32_t lateReports;       // delivered more than 1 ms after the recorded time
+    uint32_t deliveryDelayMax;  // cycles
+    uint32_t expects;           // including telemetry and applied ones
+    uint32_t failedExpects;
+
+} SimUsbStats_t;
+
+typedef struct
+{
+    uint16_t framesReceived;
+    uint16_t frameApplied;
+    uint16_t frameAppliedAge;   // ms
+    uint16_t isrOverruns;
+    uint16_t framesMerged;
+    uint16_t reportsDropped;
+
+} SimTelemetry_t;
+
+extern SimUsbStats_t g_SimUsbStats;
+extern jmp_buf g_SimExit;
+
+// Returns 0 on success, prints the error and returns -1 otherwise
+int SimUsb_Load(const char *path);
+void SimUsb_SetTail(const uint64_t cycles);
+// Telemetry feature report as the host gets it
+void SimUsb_ReadTelemetry(SimTelemetry_t *telemetry);
+
+#endif /* SIMUSB_H_INCLUDED */
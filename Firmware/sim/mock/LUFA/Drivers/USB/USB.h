@@ -0,0 +1,121 @@
+/*
+ * LUFA/Drivers/USB/USB.h (host simulator mock)
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIM_LUFA_USB_H_INCLUDED
+#define SIM_LUFA_USB_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ *  Just enough of the LUFA device and HID class API for LightpackUSB.c.
+ *  SimUsb.c implements the functions by replaying a recorded report stream.
+ */
+
+#define ATTR_WARN_UNUSED_RESULT         __attribute__ ((warn_unused_result))
+#define ATTR_NON_NULL_PTR_ARG(...)      __attribute__ ((nonnull (__VA_ARGS__)))
+
+#define ENDPOINT_DIR_IN                 0x80
+
+enum USB_Device_States_t
+{
+    DEVICE_STATE_Unattached     = 0,
+    DEVICE_STATE_Powered        = 1,
+    DEVICE_STATE_Default        = 2,
+    DEVICE_STATE_Addressed      = 3,
+    DEVICE_STATE_Configured     = 4,
+    DEVICE_STATE_Suspended      = 5,
+};
+
+enum HID_ReportItemTypes_t
+{
+    HID_REPORT_ITEM_In          = 0,
+    HID_REPORT_ITEM_Out         = 1,
+    HID_REPORT_ITEM_Feature     = 2,
+};
+
+typedef struct
+{
+    struct
+    {
+        uint8_t InterfaceNumber;
+
+        struct
+        {
+            uint8_t  Address;
+            uint16_t Size;
+            uint8_t  Banks;
+        } ReportINEndpoint;
+
+        void *   PrevReportINBuffer;
+        uint8_t  PrevReportINBufferSize;
+    } Config;
+
+    struct
+    {
+        bool     UsingReportProtocol;
+        uint16_t PrevFrameNum;
+        uint16_t IdleCount;
+        uint16_t IdleMSRemaining;
+    } State;
+
+} USB_ClassInfo_HID_Device_t;
+
+// Descriptor types referenced by Descriptors.h, contents are never used
+typedef struct { uint8_t Size; uint8_t Type; } USB_Descriptor_Header_t;
+typedef struct { USB_Descriptor_Header_t Header; uint16_t TotalConfigurationSize; } USB_Descriptor_Configuration_Header_t;
+typedef struct { USB_Descriptor_Header_t Header; uint8_t InterfaceNumber; } USB_Descriptor_Interface_t;
+typedef struct { USB_Descriptor_Header_t Header; uint16_t HIDSpec; } USB_HID_Descriptor_HID_t;
+typedef struct { USB_Descriptor_Header_t Header; uint8_t EndpointAddress; } USB_Descriptor_Endpoint_t;
+
+extern volatile uint8_t USB_DeviceState;
+
+void USB_Init(void);
+void USB_USBTask(void);
+void USB_Device_EnableSOFEvents(void);
+
+void HID_Device_USBTask(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo);
+bool HID_Device_ConfigureEndpoints(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo);
+void HID_Device_ProcessControlRequest(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo);
+void HID_Device_MillisecondElapsed(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo);
+
+// Implemented by the application
+void EVENT_USB_Device_Connect(void);
+void EVENT_USB_Device_Disconnect(void);
+void EVENT_USB_Device_ConfigurationChanged(void);
+void EVENT_USB_Device_ControlRequest(void);
+void EVENT_USB_Device_StartOfFrame(void);
+
+bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo,
+                                         uint8_t * const ReportID,
+                                         const uint8_t ReportType,
+                                         void * ReportData,
+                                         uint16_t * const ReportSize);
+
+void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t * const HIDInterfaceInfo,
+                                          const uint8_t ReportID,
+                                          const uint8_t ReportType,
+                                          const void * ReportData,
+                                          const uint16_t ReportSize);
+
+#endif /* SIM_LUFA_USB_H_INCLUDED */
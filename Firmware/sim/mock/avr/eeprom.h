@@ -0,0 +1,55 @@
+/*
+ * avr/eeprom.h (host simulator mock)
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIM_AVR_EEPROM_H_INCLUDED
+#define SIM_AVR_EEPROM_H_INCLUDED
+
+#include <stdint.h>
+#include "SimAvr.h"
+
+// Byte write takes 3.4 ms, the CPU waits for the previous one to complete
+#define SIM_EEPROM_WRITE_CYCLES     (3400UL * SIM_CYCLES_PER_US)
+
+// EEPROM variables live in RAM and start zeroed, the erased EEPROM reads 0xff
+#define EEMEM
+
+static inline uint8_t eeprom_read_byte(const uint8_t *address)
+{
+    return *address;
+}
+
+static inline uint16_t eeprom_read_word(const uint16_t *address)
+{
+    return *address;
+}
+
+static inline void eeprom_update_byte(uint8_t *address, const uint8_t value)
+{
+    if (*address != value)
+    {
+        SimAvr_Delay(SIM_EEPROM_WRITE_CYCLES);
+        *address = value;
+    }
+}
+
+#endif /* SIM_AVR_EEPROM_H_INCLUDED */
@@ -0,0 +1,70 @@
+/*
+ * avr/io.h (host simulator mock)
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIM_AVR_IO_H_INCLUDED
+#define SIM_AVR_IO_H_INCLUDED
+
+#include <stdint.h>
+#include "SimAvr.h"
+
+#define _BV(bit)    (1 << (bit))
+
+// Ports
+extern volatile uint8_t PINB, DDRB, PORTB;
+extern volatile uint8_t PINC, DDRC, PORTC;
+extern volatile uint8_t PIND, DDRD, PORTD;
+
+// Timer1
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern volatile uint16_t OCR1A;
+#define TCNT1       (*SimAvr_Tcnt1())
+
+#define CS10        0
+#define CS11        1
+#define CS12        2
+#define OCIE1A      1
+#define OCF1A       1
+
+// SPI, every SPDR access is taken as a write which starts a transfer
+extern volatile uint8_t SPCR;
+#define SPSR        (*SimAvr_Spsr())
+#define SPDR        (*SimAvr_Spdr())
+
+#define SPR0        0
+#define SPR1        1
+#define CPHA        2
+#define CPOL        3
+#define MSTR        4
+#define DORD        5
+#define SPE         6
+#define SPIE        7
+#define SPI2X       0
+#define WCOL        6
+#define SPIF        7
+
+// Watchdog
+extern volatile uint8_t WDTCSR;
+
+#define WDIE        6
+
+#endif /* SIM_AVR_IO_H_INCLUDED */
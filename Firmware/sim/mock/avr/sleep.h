@@ -0,0 +1,31 @@
+/*
+ * avr/sleep.h (host simulator mock)
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIM_AVR_SLEEP_H_INCLUDED
+#define SIM_AVR_SLEEP_H_INCLUDED
+
+#define SLEEP_MODE_IDLE         0
+#define set_sleep_mode(mode)    do { (void)(mode); } while (0)
+#define sleep_mode()            do { } while (0)
+
+#endif /* SIM_AVR_SLEEP_H_INCLUDED */
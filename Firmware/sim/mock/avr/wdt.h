@@ -0,0 +1,33 @@
+/*
+ * avr/wdt.h (host simulator mock)
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIM_AVR_WDT_H_INCLUDED
+#define SIM_AVR_WDT_H_INCLUDED
+
+// The simulator has no watchdog
+#define WDTO_250MS          4
+#define wdt_reset()         do { } while (0)
+#define wdt_enable(value)   do { (void)(value); } while (0)
+#define wdt_disable()       do { } while (0)
+
+#endif /* SIM_AVR_WDT_H_INCLUDED */
@@ -0,0 +1,39 @@
+/*
+ * util/atomic.h (host simulator mock)
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIM_UTIL_ATOMIC_H_INCLUDED
+#define SIM_UTIL_ATOMIC_H_INCLUDED
+
+#include <stdint.h>
+#include "SimAvr.h"
+
+#define ATOMIC_RESTORESTATE     0
+#define ATOMIC_FORCEON          1
+
+// Interrupts are held off for the block and restored after it
+#define ATOMIC_BLOCK(type) \
+    for (uint8_t sim_sreg_i = SimAvr_AtomicBegin(), sim_once = 1; \
+         sim_once; \
+         sim_once = 0, SimAvr_AtomicEnd((type) == ATOMIC_FORCEON ? 1 : sim_sreg_i))
+
+#endif /* SIM_UTIL_ATOMIC_H_INCLUDED */
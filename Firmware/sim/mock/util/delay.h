@@ -0,0 +1,32 @@
+/*
+ * util/delay.h (host simulator mock)
+ *
+ *  Created on: 18.10.2026
+ *     Project: Lightpack
+ *
+ *  Copyright (c) 2026 Lightpack contributors
+ *
+ *  Lightpack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Lightpack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIM_UTIL_DELAY_H_INCLUDED
+#define SIM_UTIL_DELAY_H_INCLUDED
+
+#include "SimAvr.h"
+
+#define _delay_us(us)   SimAvr_Delay((uint32_t)((us) * SIM_CYCLES_PER_US))
+#define _delay_ms(ms)   SimAvr_Delay((uint32_t)((ms) * 1000UL * SIM_CYCLES_PER_US))
+
+#endif /* SIM_UTIL_DELAY_H_INCLUDED */
@@ -31,7 +31,7 @@
 #error LIGHTPACK_HW should be passed as argument to make
 #endif
 
-#define SOFTWARE_VERSION 0x06UL
+#define SOFTWARE_VERSION 0x07UL
 
 #if(LIGHTPACK_HW == 7)
 #define VERSION_OF_FIRMWARE              (0x0700UL + SOFTWARE_VERSION)
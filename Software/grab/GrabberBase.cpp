@@ -226,6 +226,28 @@ const GrabbedScreen * GrabberBase::screenOfRect(const QRect &rect) const {
     return NULL;
 }
 
+void GrabberBase::detectLetterbox() {
+    if (!_context->isLetterboxDetectionEnabled) {
+        _letterboxDetectors.clear();
+        return;
+    }
+
+    // Detectors keep hysteresis state between frames, so they are only recreated
+    // when the set of screens changes
+    if (_letterboxDetectors.size() != _screensWithWidgets.size()) {
+        _letterboxDetectors.clear();
+        for (int i = 0; i < _screensWithWidgets.size(); ++i)
+            _letterboxDetectors.append(Grab::LetterboxDetector());
+    }
+
+    const int bytesPerPixel = 4;
+    for (int i = 0; i < _screensWithWidgets.size(); ++i) {
+        GrabbedScreen &screen = _screensWithWidgets[i];
+        const QSize screenSize = screen.screenInfo.rect.size();
+        screen.letterbox = _letterboxDetectors[i].update(screen.imgData, screen.imgFormat, screenSize.width() * bytesPerPixel, screenSize);
+    }
+}
+
 bool GrabberBase::isReallocationNeeded(const QList< ScreenInfo > &screensWithWidgets) const  {
     if (_screensWithWidgets.size() == 0 || screensWithWidgets.size() != _screensWithWidgets.size())
         return true;
@@ -445,6 +467,8 @@ void GrabberBase::grab() {
     if (_lastGrabResult == GrabResultOk) {
         _context->grabResult->clear();
 
+        detectLetterbox();
+
         for (int i = 0; i < _context->grabWidgets->size(); ++i) {
             QRect widgetRect = _context->grabWidgets->at(i)->frameGeometry();
             getValidRect(widgetRect);
@@ -472,6 +496,11 @@ void GrabberBase::grab() {
             // Convert coordinates from "Main" desktop coord-system to capture-monitor coord-system
             QRect preparedRect = clippedRect.translated(-monitorRect.x(), -monitorRect.y());
 
+            // Zones lying on black bars take the color from the nearest picture edge instead,
+            // saved widget geometry stays untouched
+            if (_context->isLetterboxDetectionEnabled)
+                preparedRect = Grab::LetterboxDetector::remap(preparedRect, monitorRect.size(), grabbedScreen->letterbox);
+
             // Align width by 4 for accelerated calculations
             preparedRect.setWidth(preparedRect.width() - (preparedRect.width() % 4));
 
@@ -487,7 +516,7 @@ void GrabberBase::grab() {
             const int bytesPerPixel = 4;
             QRgb avgColor;
             if (_context->grabWidgets->at(i)->isAreaEnabled()) {
-                Calculations::calculateAvgColor(&avgColor, grabbedScreen->imgData, grabbedScreen->imgFormat, grabbedScreen->screenInfo.rect.width() * bytesPerPixel, preparedRect );
+                Calculations::calculateColor(&avgColor, grabbedScreen->imgData, grabbedScreen->imgFormat, grabbedScreen->screenInfo.rect.width() * bytesPerPixel, preparedRect, _context->grabWidgets->at(i)->getReductionMode());
                 _context->grabResult->append(avgColor);
             } else {
                 _context->grabResult->append(qRgb(0,0,0));
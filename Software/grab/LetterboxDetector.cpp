@@ -0,0 +1,185 @@
+/*
+ * LetterboxDetector.cpp
+ *
+ *  Created on: 10/18/2026
+ *     Project: Prismatik
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LetterboxDetector.hpp"
+#include <QtAlgorithms>
+
+namespace {
+    const char bytesPerPixel = 4;
+
+    // Offset of the first color byte, the alpha byte is either the last or the first one
+    inline int colorOffset(BufferFormat bufferFormat) {
+        return (bufferFormat == BufferFormatRgba || bufferFormat == BufferFormatBgra) ? 1 : 0;
+    }
+
+    inline bool isBlack(const unsigned char *pixel) {
+        return pixel[0] < Grab::LetterboxDetector::kBlackThreshold
+            && pixel[1] < Grab::LetterboxDetector::kBlackThreshold
+            && pixel[2] < Grab::LetterboxDetector::kBlackThreshold;
+    }
+
+    // Counts black pixels from the beginning of a line of \a length pixels,
+    // \a step is a distance between neighbour pixels in bytes (may be negative)
+    inline int blackRun(const unsigned char *pixel, int step, int length) {
+        int i = 0;
+        while (i < length && isBlack(pixel)) {
+            pixel += step;
+            ++i;
+        }
+        return i;
+    }
+
+    // Median of sampled runs: a logo or subtitles inside a bar shouldn't
+    // collapse it, as well as a dark spot on the picture edge shouldn't widen it
+    inline int median(int *runs, int count) {
+        qSort(runs, runs + count);
+        return runs[count / 2];
+    }
+
+    inline bool isClose(const QMargins &a, const QMargins &b) {
+        const int t = Grab::LetterboxDetector::kTolerance;
+        return qAbs(a.left() - b.left()) <= t
+            && qAbs(a.top() - b.top()) <= t
+            && qAbs(a.right() - b.right()) <= t
+            && qAbs(a.bottom() - b.bottom()) <= t;
+    }
+
+    inline bool isNarrower(const QMargins &a, const QMargins &b) {
+        const int t = Grab::LetterboxDetector::kTolerance;
+        return a.left() < b.left() - t
+            || a.top() < b.top() - t
+            || a.right() < b.right() - t
+            || a.bottom() < b.bottom() - t;
+    }
+} // namespace
+
+namespace Grab {
+
+LetterboxDetector::LetterboxDetector()
+    : m_candidateFrames(0)
+{
+}
+
+void LetterboxDetector::reset()
+{
+    m_bars = QMargins();
+    m_candidate = QMargins();
+    m_candidateFrames = 0;
+}
+
+bool LetterboxDetector::measure(QMargins *result, const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QSize &screenSize)
+{
+    const int width = screenSize.width();
+    const int height = screenSize.height();
+
+    if (buffer == NULL || width < kSamplesCount || height < kSamplesCount || bufferFormat == BufferFormatUnknown)
+        return false;
+
+    const unsigned char *base = buffer + colorOffset(bufferFormat);
+    const int maxVertical = height / 2;
+    const int maxHorizontal = width / 2;
+
+    int top[kSamplesCount], bottom[kSamplesCount], left[kSamplesCount], right[kSamplesCount];
+
+    for (int i = 0; i < kSamplesCount; ++i) {
+        const int x = (2 * i + 1) * width / (2 * kSamplesCount);
+        const int y = (2 * i + 1) * height / (2 * kSamplesCount);
+
+        const unsigned char *column = base + x * bytesPerPixel;
+        const unsigned char *row = base + y * pitch;
+
+        top[i]    = blackRun(column, pitch, maxVertical);
+        bottom[i] = blackRun(column + (height - 1) * pitch, -(int)pitch, maxVertical);
+        left[i]   = blackRun(row, bytesPerPixel, maxHorizontal);
+        right[i]  = blackRun(row + (width - 1) * bytesPerPixel, -bytesPerPixel, maxHorizontal);
+    }
+
+    const int t = median(top, kSamplesCount);
+    const int b = median(bottom, kSamplesCount);
+    const int l = median(left, kSamplesCount);
+    const int r = median(right, kSamplesCount);
+
+    // Bars reaching the middle of the screen mean the whole frame is dark
+    if (t >= maxVertical || b >= maxVertical || l >= maxHorizontal || r >= maxHorizontal)
+        return false;
+
+    *result = QMargins(l, t, r, b);
+    return true;
+}
+
+const QMargins & LetterboxDetector::update(const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QSize &screenSize)
+{
+    QMargins measured;
+    if (!measure(&measured, buffer, bufferFormat, pitch, screenSize))
+        return m_bars;
+
+    if (isClose(measured, m_bars)) {
+        m_candidateFrames = 0;
+        return m_bars;
+    }
+
+    if (m_candidateFrames > 0 && isClose(measured, m_candidate)) {
+        ++m_candidateFrames;
+    } else {
+        m_candidate = measured;
+        m_candidateFrames = 1;
+    }
+
+    const int framesNeeded = isNarrower(m_candidate, m_bars) ? kFramesToRelease : kFramesToConfirm;
+    if (m_candidateFrames >= framesNeeded) {
+        m_bars = m_candidate;
+        m_candidateFrames = 0;
+    }
+
+    return m_bars;
+}
+
+QRect LetterboxDetector::remap(const QRect &rect, const QSize &screenSize, const QMargins &bars)
+{
+    const QRect picture = QRect(QPoint(0, 0), screenSize).marginsRemoved(bars);
+    if (bars.isNull() || !picture.isValid() || picture.contains(rect))
+        return rect;
+
+    QRect result = rect;
+    if (result.width() > picture.width())
+        result.setWidth(picture.width());
+    if (result.height() > picture.height())
+        result.setHeight(picture.height());
+
+    if (result.left() < picture.left())
+        result.moveLeft(picture.left());
+    else if (result.right() > picture.right())
+        result.moveRight(picture.right());
+
+    if (result.top() < picture.top())
+        result.moveTop(picture.top());
+    else if (result.bottom() > picture.bottom())
+        result.moveBottom(picture.bottom());
+
+    return result;
+}
+
+}
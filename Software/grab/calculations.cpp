@@ -23,149 +23,309 @@
  *
  */
 
+
 #include "calculations.hpp"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CALCULATIONS_SSE2
+#endif
 
 namespace {
     const char bytesPerPixel = 4;
 
-    struct ColorValue {
+    // Byte offsets of color channels inside one pixel
+    struct ChannelOffsets {
         int r, g, b;
     };
 
-    static int accumulateBufferFormatArgb(
-            const unsigned char *buffer,
-            unsigned int pitch,
-            const QRect &rect,
-            ColorValue *resultColor) {
-        register unsigned int r=0, g=0, b=0;
-        int count = 0; // count the amount of pixels taken into account
+    static bool channelOffsets(BufferFormat bufferFormat, ChannelOffsets *offsets) {
+        switch(bufferFormat) {
+        case BufferFormatArgb: offsets->r = 2; offsets->g = 1; offsets->b = 0; return true;
+        case BufferFormatAbgr: offsets->r = 0; offsets->g = 1; offsets->b = 2; return true;
+        case BufferFormatRgba: offsets->r = 3; offsets->g = 2; offsets->b = 1; return true;
+        case BufferFormatBgra: offsets->r = 1; offsets->g = 2; offsets->b = 3; return true;
+        default:
+            return false;
+        }
+    }
+
+    /*
+     * All kernels are fed by the same traversal: each row of the rect is
+     * visited exactly once and the kernel accumulates everything it needs in
+     * that single pass. Sums are kept per byte lane of a pixel, lanes are
+     * mapped to r, g, b only when the result is taken.
+     */
+    template <class Kernel>
+    static void traverse(const unsigned char *buffer, unsigned int pitch, const QRect &rect, Kernel &kernel) {
         for(int currentY = 0; currentY < rect.height(); currentY++) {
-            int index = pitch * (rect.y()+currentY) + rect.x()*bytesPerPixel;
-            for(int currentX = 0; currentX < rect.width(); currentX += 4) {
-                b += buffer[index]   + buffer[index + 4] + buffer[index + 8 ] + buffer[index + 12];
-                g += buffer[index+1] + buffer[index + 5] + buffer[index + 9 ] + buffer[index + 13];
-                r += buffer[index+2] + buffer[index + 6] + buffer[index + 10] + buffer[index + 14];
-                count += 4;
-                index += bytesPerPixel * 4;
-            }
+            const unsigned char *row = buffer + pitch * (rect.y() + currentY) + rect.x() * bytesPerPixel;
+            kernel.row(row, rect.width(), currentY);
         }
+    }
 
-        resultColor->r = r;
-        resultColor->g = g;
-        resultColor->b = b;
-        return count;
+#ifdef CALCULATIONS_SSE2
+    // Adds 32-bit lanes of the row accumulator to 64-bit totals
+    static inline void flushLanes(__m128i acc, quint64 *lanes) {
+        quint32 tmp[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(tmp), acc);
+        for (int i = 0; i < 4; ++i)
+            lanes[i] += tmp[i];
     }
+#endif
 
-    static int accumulateBufferFormatAbgr(
-            const unsigned char *buffer,
-            unsigned int pitch,
-            const QRect &rect,
-            ColorValue *resultColor) {
-        register unsigned int r=0, g=0, b=0;
-        int count = 0; // count the amount of pixels taken into account
-        for(int currentY = 0; currentY < rect.height(); currentY++) {
-            int index = pitch * (rect.y()+currentY) + rect.x()*bytesPerPixel;
-            for(int currentX = 0; currentX < rect.width(); currentX += 4) {
-                r += buffer[index]   + buffer[index + 4] + buffer[index + 8 ] + buffer[index + 12];
-                g += buffer[index+1] + buffer[index + 5] + buffer[index + 9 ] + buffer[index + 13];
-                b += buffer[index+2] + buffer[index + 6] + buffer[index + 10] + buffer[index + 14];
-                count += 4;
-                index += bytesPerPixel * 4;
+    struct MeanKernel {
+        quint64 lanes[4];
+        quint64 weight;
+
+        MeanKernel() : weight(0) { memset(lanes, 0, sizeof(lanes)); }
+
+        void row(const unsigned char *p, int width, int) {
+#ifdef CALCULATIONS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            __m128i acc = zero;
+            for (int x = 0; x < width; x += 4, p += bytesPerPixel * 4) {
+                const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                const __m128i pairs = _mm_add_epi16(_mm_unpacklo_epi8(px, zero), _mm_unpackhi_epi8(px, zero));
+                acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(pairs, zero));
+                acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(pairs, zero));
             }
+            flushLanes(acc, lanes);
+#else
+            unsigned int l0 = 0, l1 = 0, l2 = 0, l3 = 0;
+            for (int x = 0; x < width; x += 4, p += bytesPerPixel * 4) {
+                l0 += p[0] + p[4] + p[8 ] + p[12];
+                l1 += p[1] + p[5] + p[9 ] + p[13];
+                l2 += p[2] + p[6] + p[10] + p[14];
+                l3 += p[3] + p[7] + p[11] + p[15];
+            }
+            lanes[0] += l0; lanes[1] += l1; lanes[2] += l2; lanes[3] += l3;
+#endif
+            weight += width;
         }
+    };
 
-        resultColor->r = r;
-        resultColor->g = g;
-        resultColor->b = b;
-        return count;
-    }
+    // Weights fall linearly from the center of the zone to its borders
+    struct CenterWeightedKernel {
+        static const int MaxWeight = 16;
 
-    static int accumulateBufferFormatRgba(
-            const unsigned char *buffer,
-            unsigned int pitch,
-            const QRect &rect,
-            ColorValue *resultColor) {
-        register unsigned int r=0, g=0, b=0;
-        int count = 0; // count the amount of pixels taken into account
-        for(int currentY = 0; currentY < rect.height(); currentY++) {
-            int index = pitch * (rect.y()+currentY) + rect.x()*bytesPerPixel;
-            for(int currentX = 0; currentX < rect.width(); currentX += 4) {
-                b += buffer[index+1] + buffer[index + 5] + buffer[index + 9 ] + buffer[index + 13];
-                g += buffer[index+2] + buffer[index + 6] + buffer[index + 10] + buffer[index + 14];
-                r += buffer[index+3] + buffer[index + 7] + buffer[index + 11] + buffer[index + 15];
-                count += 4;
-                index += bytesPerPixel * 4;
+        quint64 lanes[4];
+        quint64 weight;
+        quint32 columnStep; // 16.16 fixed point slope of the column weights
+        quint32 columnsWeight;
+        int height;
+
+        CenterWeightedKernel(const QRect &rect) : weight(0), columnsWeight(0), height(rect.height()) {
+            memset(lanes, 0, sizeof(lanes));
+            // rounded up, so the top of the tent still reaches MaxWeight
+            const quint32 span = qMax(rect.width() - 1, 1);
+            columnStep = (((MaxWeight - 1) * 2 << 16) + span - 1) / span;
+            for (int x = 0; x < rect.width(); ++x)
+                columnsWeight += columnWeight(x, rect.width());
+        }
+
+        static quint16 tentWeight(int i, int n) {
+            const int distance = qMin(i, n - 1 - i);
+            return 1 + (MaxWeight - 1) * 2 * distance / qMax(n - 1, 1);
+        }
+
+        // Same tent as tentWeight(), without a division for every pixel
+        inline quint16 columnWeight(int x, int width) const {
+            const quint32 distance = qMin(x, width - 1 - x);
+            return 1 + qMin<quint32>((distance * columnStep) >> 16, MaxWeight - 1);
+        }
+
+        void row(const unsigned char *p, int width, int y) {
+            const quint16 rowWeight = tentWeight(y, height);
+            quint32 sum[4] = {0, 0, 0, 0};
+#ifdef CALCULATIONS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            __m128i acc = zero;
+            for (int x = 0; x < width; x += 4, p += bytesPerPixel * 4) {
+                const short w0 = columnWeight(x, width), w1 = columnWeight(x + 1, width);
+                const short w2 = columnWeight(x + 2, width), w3 = columnWeight(x + 3, width);
+                const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                const __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), _mm_set_epi16(w1, w1, w1, w1, w0, w0, w0, w0));
+                const __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), _mm_set_epi16(w3, w3, w3, w3, w2, w2, w2, w2));
+                // 255 * MaxWeight * 2 still fits into 16 bits
+                const __m128i pairs = _mm_add_epi16(lo, hi);
+                acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(pairs, zero));
+                acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(pairs, zero));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sum), acc);
+#else
+            for (int x = 0; x < width; ++x, p += bytesPerPixel) {
+                const quint32 w = columnWeight(x, width);
+                sum[0] += p[0] * w;
+                sum[1] += p[1] * w;
+                sum[2] += p[2] * w;
+                sum[3] += p[3] * w;
             }
+#endif
+            for (int lane = 0; lane < 4; ++lane)
+                lanes[lane] += (quint64)sum[lane] * rowWeight;
+            weight += (quint64)columnsWeight * rowWeight;
         }
+    };
 
-        resultColor->r = r;
-        resultColor->g = g;
-        resultColor->b = b;
-        return count;
-    }
+    // Bright pixels dominate, so dark parts of the zone don't wash out the color
+    struct LuminanceWeightedKernel {
+        quint64 lanes[4];
+        quint64 weight;
+        quint16 coefs[8]; // Rec. 709 luma coefficients (x256) for two pixels
 
-    static int accumulateBufferFormatBgra(
-            const unsigned char *buffer,
-            unsigned int pitch,
-            const QRect &rect,
-            ColorValue *resultColor) {
-        register unsigned int r=0, g=0, b=0;
-        int count = 0; // count the amount of pixels taken into account
-        for(int currentY = 0; currentY < rect.height(); currentY++) {
-            int index = pitch * (rect.y()+currentY) + rect.x()*bytesPerPixel;
-            for(int currentX = 0; currentX < rect.width(); currentX += 4) {
-                r += buffer[index+1] + buffer[index + 5] + buffer[index + 9 ] + buffer[index + 13];
-                g += buffer[index+2] + buffer[index + 6] + buffer[index + 10] + buffer[index + 14];
-                b += buffer[index+3] + buffer[index + 7] + buffer[index + 11] + buffer[index + 15];
-                count += 4;
-                index += bytesPerPixel * 4;
+        LuminanceWeightedKernel(const ChannelOffsets &offsets) : weight(0) {
+            memset(lanes, 0, sizeof(lanes));
+            memset(coefs, 0, sizeof(coefs));
+            for (int i = 0; i < 8; i += 4) {
+                coefs[i + offsets.r] = 54;
+                coefs[i + offsets.g] = 183;
+                coefs[i + offsets.b] = 19;
+            }
+        }
+
+        void row(const unsigned char *p, int width, int) {
+            quint32 sum[4] = {0, 0, 0, 0};
+            quint32 rowWeight = 0;
+#ifdef CALCULATIONS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(coefs));
+            __m128i acc = zero;
+            __m128i accWeight = zero;
+            for (int x = 0; x < width; x += 2, p += bytesPerPixel * 2) {
+                const __m128i px = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), zero);
+                // [l0a, l0b, l1a, l1b] -> [L0, L0, L1, L1]
+                __m128i luma = _mm_madd_epi16(px, k);
+                luma = _mm_add_epi32(luma, _mm_shuffle_epi32(luma, _MM_SHUFFLE(2, 3, 0, 1)));
+                const __m128i w32 = _mm_add_epi32(_mm_srli_epi32(luma, 8), one);
+                accWeight = _mm_add_epi32(accWeight, w32);
+                // spread weights to the lanes of their pixels: [W0 x4, W1 x4]
+                const __m128i w16 = _mm_shuffle_epi32(_mm_packs_epi32(w32, w32), _MM_SHUFFLE(1, 1, 0, 0));
+                // 255 * 256 fits into unsigned 16 bits
+                const __m128i prod = _mm_mullo_epi16(px, w16);
+                acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(prod, zero));
+                acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(prod, zero));
             }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sum), acc);
+            quint32 weights[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(weights), accWeight);
+            // each pixel weight sits in two lanes
+            rowWeight = (weights[0] + weights[2]);
+#else
+            for (int x = 0; x < width; ++x, p += bytesPerPixel) {
+                const quint32 w = ((p[0] * coefs[0] + p[1] * coefs[1] + p[2] * coefs[2] + p[3] * coefs[3]) >> 8) + 1;
+                sum[0] += p[0] * w;
+                sum[1] += p[1] * w;
+                sum[2] += p[2] * w;
+                sum[3] += p[3] * w;
+                rowWeight += w;
+            }
+#endif
+            for (int lane = 0; lane < 4; ++lane)
+                lanes[lane] += sum[lane];
+            weight += rowWeight;
+        }
+    };
+
+    // Most frequent color of a coarse 8x8x8 histogram, returned as a mean of the pixels in that bin
+    struct DominantKernel {
+        static const int BinBits = 3;
+        static const int BinsCount = 1 << (BinBits * 3);
+
+        quint32 counts[BinsCount];
+        quint32 sums[BinsCount][3];
+        ChannelOffsets offsets;
+
+        DominantKernel(const ChannelOffsets &channelOffsets) : offsets(channelOffsets) {
+            memset(counts, 0, sizeof(counts));
+            memset(sums, 0, sizeof(sums));
+        }
+
+        void row(const unsigned char *p, int width, int) {
+            // scatter into bins doesn't vectorize, unroll by 4 as the rest of the code does
+            for (int x = 0; x < width; x += 4, p += bytesPerPixel * 4) {
+                add(p);
+                add(p + 4);
+                add(p + 8);
+                add(p + 12);
+            }
+        }
+
+        inline void add(const unsigned char *p) {
+            const int shift = 8 - BinBits;
+            const int r = p[offsets.r], g = p[offsets.g], b = p[offsets.b];
+            const int bin = ((r >> shift) << (BinBits * 2)) | ((g >> shift) << BinBits) | (b >> shift);
+            ++counts[bin];
+            sums[bin][0] += r;
+            sums[bin][1] += g;
+            sums[bin][2] += b;
         }
 
-        resultColor->r = r;
-        resultColor->g = g;
-        resultColor->b = b;
-        return count;
+        QRgb result() const {
+            int best = 0;
+            for (int i = 1; i < BinsCount; ++i)
+                if (counts[i] > counts[best])
+                    best = i;
+            if (counts[best] == 0)
+                return qRgb(0, 0, 0);
+            return qRgb(sums[best][0] / counts[best], sums[best][1] / counts[best], sums[best][2] / counts[best]);
+        }
+    };
+
+    template <class Kernel>
+    static QRgb weightedResult(const Kernel &kernel, const ChannelOffsets &offsets) {
+        if (kernel.weight == 0)
+            return qRgb(0, 0, 0);
+        return qRgb((kernel.lanes[offsets.r] / kernel.weight) & 0xff,
+                    (kernel.lanes[offsets.g] / kernel.weight) & 0xff,
+                    (kernel.lanes[offsets.b] / kernel.weight) & 0xff);
     }
 } // namespace
 
 namespace Grab {
     namespace Calculations {
         QRgb calculateAvgColor(QRgb *result, const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QRect &rect ) {
+            return calculateColor(result, buffer, bufferFormat, pitch, rect, ReductionModeMean);
+        }
 
-            Q_ASSERT_X(rect.width() % 4 == 0, "average color calculation", "rect width should be aligned by 4 bytes");
+        QRgb calculateColor(QRgb *result, const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QRect &rect, ReductionMode reductionMode) {
 
-            int count = 0; // count the amount of pixels taken into account
-            ColorValue color = {0, 0, 0};
+            Q_ASSERT_X(rect.width() % 4 == 0, "color calculation", "rect width should be aligned by 4 bytes");
 
-            switch(bufferFormat) {
-            case BufferFormatArgb:
-                count = accumulateBufferFormatArgb(buffer, pitch, rect, &color);
-                break;
+            ChannelOffsets offsets;
+            if (!channelOffsets(bufferFormat, &offsets))
+                return -1;
 
-            case BufferFormatAbgr:
-                count = accumulateBufferFormatAbgr(buffer, pitch, rect, &color);
+            switch(reductionMode) {
+            case ReductionModeCenterWeighted: {
+                CenterWeightedKernel kernel(rect);
+                traverse(buffer, pitch, rect, kernel);
+                *result = weightedResult(kernel, offsets);
                 break;
-
-            case BufferFormatRgba:
-                count = accumulateBufferFormatRgba(buffer, pitch, rect, &color);
+            }
+            case ReductionModeLuminanceWeighted: {
+                LuminanceWeightedKernel kernel(offsets);
+                traverse(buffer, pitch, rect, kernel);
+                *result = weightedResult(kernel, offsets);
                 break;
-
-            case BufferFormatBgra:
-                count = accumulateBufferFormatBgra(buffer, pitch, rect, &color);
+            }
+            case ReductionModeDominant: {
+                DominantKernel kernel(offsets);
+                traverse(buffer, pitch, rect, kernel);
+                *result = kernel.result();
                 break;
-            default:
-                return -1;
+            }
+            case ReductionModeMean:
+            default: {
+                MeanKernel kernel;
+                traverse(buffer, pitch, rect, kernel);
+                *result = weightedResult(kernel, offsets);
                 break;
             }
-
-            if ( count > 1 ) {
-                color.r = ( color.r / count) & 0xff;
-                color.g = ( color.g / count) & 0xff;
-                color.b = ( color.b / count) & 0xff;
             }
 
-            *result = qRgb(color.r, color.g, color.b);
             return *result;
         }
 
@@ -77,12 +77,14 @@ HEADERS += \
     include/GrabberBase.hpp \
     include/ColorProvider.hpp \
     include/GrabberContext.hpp \
+    include/LetterboxDetector.hpp \
     $${GRABBERS_HEADERS}
 
 SOURCES += \
     calculations.cpp \
     TimeredGrabber.cpp \
     GrabberBase.cpp \
+    LetterboxDetector.cpp \
     include/ColorProvider.cpp \
     $${GRABBERS_SOURCES}
 
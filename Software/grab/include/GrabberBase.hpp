@@ -32,6 +32,7 @@
 #include "../src/GrabWidget.hpp"
 #include "calculations.hpp"
 #include "GrabberContext.hpp"
+#include "LetterboxDetector.hpp"
 
 
 #include <CL/cl.hpp>
@@ -65,6 +66,8 @@ struct GrabbedScreen {
     BufferFormat imgFormat;
     ScreenInfo screenInfo;
     void * associatedData;
+    // Black bars around the picture, grab areas are moved out of them
+    QMargins letterbox;
 };
 
 #define DECLARE_GRABBER_NAME(grabber_name) \
@@ -171,6 +174,7 @@ protected slots:
 
 protected:
     const GrabbedScreen * screenOfRect(const QRect &rect) const;
+    void detectLetterbox();
 
 signals:
     void frameGrabAttempted(GrabResult grabResult);
@@ -184,5 +188,6 @@ protected:
     GrabberContext *_context;
     GrabResult _lastGrabResult;
     QList<GrabbedScreen> _screensWithWidgets;
+    QList<Grab::LetterboxDetector> _letterboxDetectors;
 
 };
@@ -48,6 +48,9 @@ struct AllocatedBuf {
 class GrabberContext {
 public:
     GrabberContext()
+        : grabWidgets(NULL)
+        , grabResult(NULL)
+        , isLetterboxDetectionEnabled(false)
     {}
 
     ~GrabberContext(){
@@ -98,6 +101,7 @@ public:
 public:
     QList<GrabWidget *> *grabWidgets;
     QList<QRgb> *grabResult;
+    bool isLetterboxDetectionEnabled;
 
 
 private:
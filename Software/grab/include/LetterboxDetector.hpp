@@ -0,0 +1,86 @@
+/*
+ * LetterboxDetector.hpp
+ *
+ *  Created on: 10/18/2026
+ *     Project: Prismatik
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QMargins>
+#include <QRect>
+#include <QSize>
+#include "../common/BufferFormat.h"
+
+namespace Grab {
+
+/*!
+  Finds static black bars (letterbox / pillarbox) around the picture of one
+  grabbed screen. Only a handful of rows and columns are sampled per frame so
+  the cost stays negligible compared to the average color calculation.
+
+  Measured bars are not applied immediately: a new (wider) bar has to be seen
+  for \a kFramesToConfirm frames in a row, while bars that got narrower (the
+  picture moved into the bar area) are released after \a kFramesToRelease
+  frames. This keeps dark scenes and fades from making the zones flap.
+*/
+class LetterboxDetector
+{
+public:
+    LetterboxDetector();
+
+    /*!
+      Measures bars on \a buffer and feeds the result to the hysteresis.
+      \return currently accepted bars
+    */
+    const QMargins & update(const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QSize &screenSize);
+
+    /*!
+      One-shot measurement without hysteresis.
+      \return false if the frame is (almost) completely black and nothing can
+      be said about bars, \a result is left untouched in this case
+    */
+    static bool measure(QMargins *result, const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QSize &screenSize);
+
+    /*!
+      Moves \a rect (in screen coordinates) out of the bars onto the edge of
+      the picture. Rects which are already inside the picture are returned
+      as is, the size of a rect is only reduced if it doesn't fit the picture.
+    */
+    static QRect remap(const QRect &rect, const QSize &screenSize, const QMargins &bars);
+
+    const QMargins & bars() const { return m_bars; }
+    void reset();
+
+    static const int kSamplesCount = 16;
+    static const int kBlackThreshold = 24;
+    static const int kFramesToConfirm = 25;
+    static const int kFramesToRelease = 3;
+    static const int kTolerance = 4;
+
+private:
+    QMargins m_bars;
+    QMargins m_candidate;
+    int m_candidateFrames;
+};
+
+}
@@ -33,6 +33,19 @@
 namespace Grab {
     namespace Calculations {
 
+        /*!
+          The way colors of a zone are reduced to one color. Stored per zone in
+          the profile, so new modes must be appended to keep saved values valid.
+        */
+        enum ReductionMode {
+            ReductionModeMean = 0,
+            ReductionModeCenterWeighted,
+            ReductionModeLuminanceWeighted,
+            ReductionModeDominant,
+            ReductionModesCount
+        };
+
+        QRgb calculateColor(QRgb *result, const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QRect &rect, ReductionMode reductionMode);
         QRgb calculateAvgColor(QRgb *result, const unsigned char *buffer, BufferFormat bufferFormat, unsigned int pitch, const QRect &rect );
         QRgb calculateAvgColor(QList<QRgb> *colors);
     }
@@ -31,28 +31,50 @@
 
 void AbstractLedDevice::setGamma(double value) {
     m_gamma = value;
-    setColors(m_colorsSaved);
+    colorModificationsChanged();
+    resendColors();
 }
 
 void AbstractLedDevice::setBrightness(int value) {
     m_brightness = value;
-    setColors(m_colorsSaved);
+    colorModificationsChanged();
+    resendColors();
 }
 
 void AbstractLedDevice::setLuminosityThreshold(int value) {
     m_luminosityThreshold = value;
-    setColors(m_colorsSaved);
+    colorModificationsChanged();
+    resendColors();
 }
 
 void AbstractLedDevice::setMinimumLuminosityThresholdEnabled(bool value) {
     m_isMinimumLuminosityEnabled = value;
-    setColors(m_colorsSaved);
+    colorModificationsChanged();
+    resendColors();
 }
 
 void AbstractLedDevice::updateWBAdjustments(const QList<WBAdjustment> &coefs) {
     m_wbAdjustments.clear();
     m_wbAdjustments.append(coefs);
-    setColors(m_colorsSaved);
+    colorModificationsChanged();
+    resendColors();
+}
+
+void AbstractLedDevice::setEffect(const LedEffect &effect) {
+    QList<QRgb> colors;
+    const QRgb color = effect.keyframes.isEmpty() ? 0 : effect.keyframes.last().color;
+
+    for (int i = 0; i < m_colorsSaved.count(); i++)
+        colors << color;
+
+    setColors(colors);
+}
+
+void AbstractLedDevice::resendColors() {
+    if (m_isEffectSaved)
+        setEffect(m_effectSaved);
+    else
+        setColors(m_colorsSaved);
 }
 
 void AbstractLedDevice::updateDeviceSettings()
@@ -62,7 +84,7 @@ void AbstractLedDevice::updateDeviceSettings()
     setBrightness(Settings::getDeviceBrightness());
     setLuminosityThreshold(Settings::getLuminosityThreshold());
     setMinimumLuminosityThresholdEnabled(Settings::isMinimumLuminosityEnabled());
-    updateWBAdjustments(Settings::getLedCoefs());
+    updateWBAdjustments(Settings::getLedCoefs().mid(m_firstLed));
 }
 
 /*!
@@ -72,7 +94,7 @@ void AbstractLedDevice::updateDeviceSettings()
 */
 void AbstractLedDevice::applyColorModifications(const QList<QRgb> &inColors, QList<StructRgb> &outColors) {
 
-    bool isApplyWBAdjustments = m_wbAdjustments.count() == inColors.count();
+    bool isApplyWBAdjustments = m_wbAdjustments.count() >= inColors.count();
 
     for(int i = 0; i < inColors.count(); i++) {
 
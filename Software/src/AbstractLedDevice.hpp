@@ -29,6 +29,7 @@
 #include <QtGui>
 #include "colorspace_types.h"
 #include "types.h"
+#include "LedEffect.hpp"
 
 /*!
     Abstract class representing any LED device.
@@ -38,7 +39,7 @@ class AbstractLedDevice : public QObject
 {
     Q_OBJECT
 public:
-    AbstractLedDevice(QObject * parent) : QObject(parent) {}
+    AbstractLedDevice(QObject * parent) : QObject(parent), m_firstLed(0), m_isEffectSaved(false) {}
     virtual ~AbstractLedDevice(){}
 
 signals:
@@ -53,6 +54,15 @@ signals:
     */
     void commandCompleted(bool ok);
     void colorsUpdated(QList<QRgb> colors);
+    /*!
+      Device plays \a LedEffect by itself, sent when the firmware version is known
+    */
+    void effectsSupported(bool isSupported);
+    /*!
+      Frames passed to setColors() the device hasn't shown yet, sent only by
+      devices which report the frame they show
+    */
+    void framesInFlight(int count);
 
 public slots:
     virtual const QString name() const = 0;
@@ -60,6 +70,11 @@ public slots:
     virtual void close() = 0;
     virtual void setColors(const QList<QRgb> & colors) = 0;
     virtual void switchOffLeds() = 0;
+    /*!
+      Plays the effect until the next setColors() or switchOffLeds().
+      Devices without effects show the last keyframe color.
+    */
+    virtual void setEffect(const LedEffect & effect);
 
     /*!
       \obsolete only form compatibility with Lightpack ver.<=5.5 hardware
@@ -76,6 +91,11 @@ public slots:
     virtual void updateWBAdjustments(const QList<WBAdjustment> &coefs);
     virtual void requestFirmwareVersion() = 0;
     virtual void updateDeviceSettings();
+    /*!
+      Index of the LED in the whole frame shown by the first LED of this device,
+      selects per-LED settings of the device. Non zero for additional devices only.
+    */
+    void setFirstLed(int firstLed) { m_firstLed = firstLed; }
 
     virtual size_t maxLedsCount() = 0;
     virtual size_t defaultLedsCount() = 0;
@@ -88,6 +108,10 @@ public slots:
 
 protected:
     virtual void applyColorModifications(const QList<QRgb> & inColors, QList<StructRgb> & outColors);
+    //! Sends the saved colors or effect again, e.g. with the new gamma
+    void resendColors();
+    //! Gamma, brightness, luminosity threshold or white balance is changed, colors are sent again next
+    virtual void colorModificationsChanged() {}
 
 protected:
     QString m_colorSequence;
@@ -95,9 +119,13 @@ protected:
     int m_brightness;
     int m_luminosityThreshold;
     bool m_isMinimumLuminosityEnabled;
+    int m_firstLed;
 
     QList<WBAdjustment> m_wbAdjustments;
 
     QList<QRgb> m_colorsSaved;
+    // Effect is saved instead of the colors by devices which play it
+    LedEffect m_effectSaved;
+    bool m_isEffectSaved;
     QList<StructRgb> m_colorsBuffer;
 };
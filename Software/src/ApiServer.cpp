@@ -25,11 +25,14 @@
  */
 
 #include <QtNetwork>
+#include <QtEndian>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ApiServer.hpp"
 #include "LightpackPluginInterface.hpp"
 #include "ApiServerSetColorTask.hpp"
+#include "ApiUdpServer.hpp"
 #include "Settings.hpp"
 #include "TimeEvaluations.hpp"
 #include "version.h"
@@ -143,13 +146,35 @@ const char * ApiServer::CmdSetBacklight = "setmode:";
 const char * ApiServer::CmdSetBacklight_Ambilight = "ambilight";
 const char * ApiServer::CmdSetBacklight_Moodlamp = "moodlamp";
 
+// After this command the connection carries binary frames (see ApiBinaryFrame)
+const char * ApiServer::CmdBinaryMode = "binarymode";
+const char * ApiServer::CmdResultBinaryMode_Ok = "binarymode:ok\r\n";
+
+// Subscribed clients receive "frame:RRGGBB..." lines when the colors change
+// and "event:..." lines when the status, profile or lock changes.
+// Optional argument limits frames per second: "subscribe:30"
+const char * ApiServer::CmdSubscribe = "subscribe";
+const char * ApiServer::CmdResultSubscribe_Ok = "subscribe:ok\r\n";
+const char * ApiServer::CmdUnsubscribe = "unsubscribe";
+const char * ApiServer::CmdResultUnsubscribe_Ok = "unsubscribe:ok\r\n";
+const char * ApiServer::PushColors = "frame:";
+const char * ApiServer::PushEvent = "event:";
+
 const int ApiServer::SignalWaitTimeoutMs = 1000; // 1 second
+const int ApiServer::PushRateDefault = 30;
+const int ApiServer::PushRateMax = 120;
+// A client which has not read this much of pushed data is dropped
+const int ApiServer::PushBacklogMaxBytes = 64 * 1024;
 
 ApiServer::ApiServer(QObject *parent)
     : QTcpServer(parent)
 {
+    qRegisterMetaType< QList<QRect> >("QList<QRect>");
+
     initPrivateVariables();
     initApiSetColorTask();
+    initPushTimer();
+    m_udpServer = new ApiUdpServer(this);
     initHelpMessage();
     initShortHelpMessage();
 }
@@ -159,8 +184,12 @@ ApiServer::ApiServer(quint16 port, QObject *parent)
 {
     // This constructor is for using in ApiTests
 
+    qRegisterMetaType< QList<QRect> >("QList<QRect>");
+
     initPrivateVariables();
     initApiSetColorTask();
+    initPushTimer();
+    m_udpServer = new ApiUdpServer(this);
     initHelpMessage();
     initShortHelpMessage();
 
@@ -178,8 +207,15 @@ void ApiServer::setInterface(LightpackPluginInterface *lightpackInterface)
     QString test = lightpack->Version();
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << test;
     lightpack = lightpackInterface;
-    connect(m_apiSetColorTask, SIGNAL(taskParseSetColorDone(QList<QRgb>)), lightpack, SIGNAL(updateLedsColors(QList<QRgb>)), Qt::QueuedConnection);
-    connect(m_apiSetColorTask, SIGNAL(taskParseSetColorDone(const QList<QRgb> &)), lightpack, SLOT(updateColors(const QList<QRgb> &)), Qt::QueuedConnection);
+    // Keeps colors for getcolors, frames go to devices through updateLedsColors()
+    connect(this, SIGNAL(updateLedsColors(QList<QRgb>)), lightpack, SLOT(updateColors(QList<QRgb>)), Qt::QueuedConnection);
+
+    connect(lightpack, SIGNAL(ColorsUpdated(QList<QRgb>)), this, SLOT(pushColors(QList<QRgb>)));
+    connect(lightpack, SIGNAL(ChangeStatus(int)), this, SLOT(pushStatus(int)));
+    connect(lightpack, SIGNAL(ChangeProfile(QString)), this, SLOT(pushProfile(QString)));
+    connect(lightpack, SIGNAL(ChangeLockStatus(bool)), this, SLOT(pushLockStatus(bool)));
+
+    m_udpServer->setInterface(lightpack);
 
 }
 
@@ -229,6 +265,11 @@ void ApiServer::incomingConnection(qintptr socketDescriptor)
     cs.isAuthorized = !m_isAuthEnabled;
     // set default sessionkey (disable lock priority)
     cs.sessionKey = "API"+lightpack->GetSessionKey("API")+QString(m_clients.count());
+    cs.isBinaryMode = false;
+    cs.isSetColorPending = false;
+    cs.isSubscribed = false;
+    cs.isPushPending = false;
+    cs.pushIntervalMs = 1000 / PushRateDefault;
 
     m_clients.insert(client, cs);
 
@@ -252,6 +293,10 @@ void ApiServer::clientDisconnected()
 
     m_clients.remove(client);
 
+    // Parse results for this client have nowhere to go
+    forgetSetColorRequests(client);
+    m_slowClients.removeAll(client);
+
     disconnect(client, SIGNAL(readyRead()), this, SLOT(clientProcessCommands()));
     disconnect(client, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
 
@@ -264,7 +309,21 @@ void ApiServer::clientProcessCommands()
 
     QTcpSocket *client = dynamic_cast<QTcpSocket*>(sender());
 
-    while (m_clients.contains(client) && client->canReadLine())
+    processCommands(client);
+}
+
+void ApiServer::processCommands(QTcpSocket *client)
+{
+    if (m_clients.contains(client) && m_clients[client].isBinaryMode)
+        clientProcessBinaryFrames(client);
+
+    // Commands are handled strictly in order: while a setcolor is being
+    // parsed, the following lines stay in the socket buffer and are picked
+    // up again from taskSetColorIsSuccess()
+    while (m_clients.contains(client)
+           && m_clients[client].isBinaryMode == false
+           && m_clients[client].isSetColorPending == false
+           && client->canReadLine())
     {
         QString sessionKey =  m_clients[client].sessionKey;
         int m_lockedClient = lightpack->CheckLock(sessionKey);
@@ -277,7 +336,7 @@ void ApiServer::clientProcessCommands()
         if (cmdBuffer.isEmpty())
         {
             // Ignore empty lines
-            return;
+            continue;
         }
         else if (cmdBuffer == CmdExit)
         {
@@ -289,12 +348,12 @@ void ApiServer::clientProcessCommands()
         else if (cmdBuffer == CmdHelp)
         {
             writeData(client, m_helpMessage);
-            return;
+            continue;
         }
         else if (cmdBuffer == CmdHelpShort)
         {
             writeData(client, m_shortHelpMessage);
-            return;
+            continue;
         }
         else if (cmdBuffer.startsWith(CmdApiKey))
         {
@@ -327,13 +386,13 @@ void ApiServer::clientProcessCommands()
             }
 
             writeData(client, result);
-            return;
+            continue;
         }
 
         if (m_isAuthEnabled && m_clients[client].isAuthorized == false)
         {
             writeData(client, CmdApiCheck_AuthRequired);
-            return;
+            continue;
         }
 
         // We are working only with authorized clients!
@@ -342,7 +401,8 @@ void ApiServer::clientProcessCommands()
         {
             API_DEBUG_OUT << CmdGetStatus;
 
-            int status = lightpack->GetStatus();
+            int status = -2;
+            invokeInterface("GetStatus", Q_RETURN_ARG(int, status));
             if (status== 1) result = CmdResultStatus_On;
             if (status== 0) result = CmdResultStatus_Off;
             if (status==-1) result = CmdResultStatus_DeviceError;
@@ -529,6 +589,56 @@ void ApiServer::clientProcessCommands()
                 break;
             }
         }
+        else if (cmdBuffer == CmdBinaryMode)
+        {
+            API_DEBUG_OUT << CmdBinaryMode;
+
+            ClientInfo & clientInfo = m_clients[client];
+            clientInfo.isBinaryMode = true;
+            clientInfo.frameBuffer.resize(ApiBinaryFrame::MaxPayloadSize);
+
+            writeData(client, CmdResultBinaryMode_Ok);
+
+            // Frames may already be buffered right after the command line
+            clientProcessBinaryFrames(client);
+            continue;
+        }
+        else if (cmdBuffer == CmdSubscribe || cmdBuffer.startsWith(QByteArray(CmdSubscribe) + ':'))
+        {
+            API_DEBUG_OUT << CmdSubscribe;
+
+            int rate = PushRateDefault;
+            bool ok = true;
+
+            if (cmdBuffer != CmdSubscribe)
+            {
+                cmdBuffer.remove(0, cmdBuffer.indexOf(':') + 1);
+                rate = QString(cmdBuffer).toInt(&ok);
+            }
+
+            if (ok && rate > 0 && rate <= PushRateMax)
+            {
+                ClientInfo & clientInfo = m_clients[client];
+                clientInfo.isSubscribed = true;
+                clientInfo.isPushPending = false;
+                clientInfo.pushIntervalMs = 1000 / rate;
+                clientInfo.lastPushTime.invalidate();
+
+                result = CmdResultSubscribe_Ok;
+            } else {
+                API_DEBUG_OUT << CmdSubscribe << "Error (rate is not valid):" << QString(cmdBuffer);
+                result = CmdSetResult_Error;
+            }
+        }
+        else if (cmdBuffer == CmdUnsubscribe)
+        {
+            API_DEBUG_OUT << CmdUnsubscribe;
+
+            m_clients[client].isSubscribed = false;
+            m_clients[client].isPushPending = false;
+
+            result = CmdResultUnsubscribe_Ok;
+        }
         else if (cmdBuffer.startsWith(CmdGuid))
         {
             API_DEBUG_OUT << CmdGuid;
@@ -595,44 +705,13 @@ void ApiServer::clientProcessCommands()
                 cmdBuffer.remove(0, cmdBuffer.indexOf(':') + 1);
                 API_DEBUG_OUT << QString(cmdBuffer);
 
-                if (m_isTaskSetColorDone)
-                {
-                    m_isTaskSetColorDone = false;
-                    m_isTaskSetColorParseSuccess = false;
-
-                    // Start task
-                    emit startParseSetColorTask(cmdBuffer);
-
-                    // Wait signal from m_apiSetColorTask with success or fail result of parsing buffer.
-                    // After SignalWaitTimeoutMs milliseconds, the cycle of waiting will end and the
-                    // variable m_isTaskSetColorDone will be reset to 'true' state.
-                    // Also in cycle we process requests from over clients, if this request is setcolor when
-                    // it will be ignored because of m_isTaskSetColorDone == false
-
-                    m_time.restart();
-
-                    while (m_isTaskSetColorDone == false && m_time.elapsed() < SignalWaitTimeoutMs)
-                    {
-                        QApplication::processEvents(QEventLoop::WaitForMoreEvents, SignalWaitTimeoutMs);
-                    }
+                // The result is written when the parse task reports back,
+                // other clients are served in the meantime
+                m_clients[client].isSetColorPending = true;
+                m_setColorRequests.enqueue(client);
 
-                    if (m_isTaskSetColorDone)
-                    {
-                        if (m_isTaskSetColorParseSuccess)
-                        {
-                            lightpack->SetLockAlive(sessionKey);
-                            result = CmdSetResult_Ok;
-                        }
-                        else
-                            result = CmdSetResult_Error;
-                    } else {
-                        m_isTaskSetColorDone = true; // cmd setcolor is available
-                        result = CmdSetResult_Error;
-                        qWarning() << Q_FUNC_INFO << "Timeout waiting taskIsSuccess() signal from m_apiSetColorTask";
-                    }
-                } else {
-                    qWarning() << Q_FUNC_INFO << "Task setcolor is not completed (you should increase the delay to not skip commands), skip setcolor.";
-                }
+                emit startParseSetColorTask(cmdBuffer);
+                continue;
             }
             else if (m_lockedClient == 0)
             {
@@ -784,7 +863,9 @@ void ApiServer::clientProcessCommands()
                 cmdBuffer.remove(0, cmdBuffer.indexOf(':') + 1);
                 API_DEBUG_OUT << QString(cmdBuffer);
                 QString setProfileName = QString(cmdBuffer);
-                if (lightpack->SetProfile(sessionKey, setProfileName))
+                bool isOk = false;
+                invokeInterface("SetProfile", Q_RETURN_ARG(bool, isOk), Q_ARG(QString, sessionKey), Q_ARG(QString, setProfileName));
+                if (isOk)
                 {
                     API_DEBUG_OUT << CmdSetProfile << "OK:" << setProfileName;
                     result = CmdSetResult_Ok;
@@ -811,7 +892,9 @@ void ApiServer::clientProcessCommands()
                 cmdBuffer.remove(0, cmdBuffer.indexOf(':') + 1);
                 API_DEBUG_OUT << QString(cmdBuffer);
                 QString setDeviceName = QString(cmdBuffer);
-                if (lightpack->SetDevice(sessionKey, setDeviceName))
+                bool isOk = false;
+                invokeInterface("SetDevice", Q_RETURN_ARG(bool, isOk), Q_ARG(QString, sessionKey), Q_ARG(QString, setDeviceName));
+                if (isOk)
                 {
                     API_DEBUG_OUT << CmdSetDevice << "OK:" << setDeviceName;
                     result = CmdSetResult_Ok;
@@ -842,7 +925,9 @@ void ApiServer::clientProcessCommands()
 
                 if (ok)
                 {
-                    if (lightpack->SetCountLeds(sessionKey,countleds))
+                    bool isOk = false;
+                    invokeInterface("SetCountLeds", Q_RETURN_ARG(bool, isOk), Q_ARG(QString, sessionKey), Q_ARG(int, countleds));
+                    if (isOk)
                     {
                         API_DEBUG_OUT << CmdSetCountLeds << "OK:" << countleds;
                         result = CmdSetResult_Ok;
@@ -901,7 +986,7 @@ void ApiServer::clientProcessCommands()
                         }
                     }
                 }
-                lightpack->SetLeds(sessionKey,rectLeds);
+                invokeInterface("SetLeds", QGenericReturnArgument(), Q_ARG(QString, sessionKey), Q_ARG(QList<QRect>, rectLeds));
                 result = CmdSetResult_Ok;
             }
             else if (m_lockedClient == 0)
@@ -922,7 +1007,9 @@ void ApiServer::clientProcessCommands()
                 cmdBuffer.remove(0, cmdBuffer.indexOf(':') + 1);
                 API_DEBUG_OUT << QString(cmdBuffer);
                 QString newProfileName = QString(cmdBuffer);
-                if (lightpack->NewProfile(sessionKey, newProfileName))
+                bool isOk = false;
+                invokeInterface("NewProfile", Q_RETURN_ARG(bool, isOk), Q_ARG(QString, sessionKey), Q_ARG(QString, newProfileName));
+                if (isOk)
                 {
                      API_DEBUG_OUT << CmdNewProfile << "OK:" << newProfileName;
                     result = CmdSetResult_Ok;
@@ -950,7 +1037,9 @@ void ApiServer::clientProcessCommands()
 
                 QString deleteProfileName = QString(cmdBuffer);
 
-                if (lightpack->DeleteProfile(sessionKey, deleteProfileName))
+                bool isOk = false;
+                invokeInterface("DeleteProfile", Q_RETURN_ARG(bool, isOk), Q_ARG(QString, sessionKey), Q_ARG(QString, deleteProfileName));
+                if (isOk)
                 {
                     API_DEBUG_OUT << CmdDeleteProfile << "OK:" << deleteProfileName;
                     result = CmdSetResult_Ok;
@@ -988,7 +1077,7 @@ void ApiServer::clientProcessCommands()
                 {
                     API_DEBUG_OUT << CmdSetStatus << "OK:" << status;
 
-                    lightpack->SetStatus(sessionKey,status);
+                    invokeInterface("SetStatus", QGenericReturnArgument(), Q_ARG(QString, sessionKey), Q_ARG(int, status));
 
                     result = CmdSetResult_Ok;
                 } else {
@@ -1024,7 +1113,7 @@ void ApiServer::clientProcessCommands()
                 if (status != 0)
                 {
                     API_DEBUG_OUT << CmdSetBacklight << "OK:" << status;
-                    lightpack->SetBacklight(sessionKey,status);
+                    invokeInterface("SetBacklight", QGenericReturnArgument(), Q_ARG(QString, sessionKey), Q_ARG(int, status));
                     result = CmdSetResult_Ok;
                 } else {
                     API_DEBUG_OUT << CmdSetBacklight << "Error (status not recognized):" << status;
@@ -1051,8 +1140,306 @@ void ApiServer::clientProcessCommands()
 
 void ApiServer::taskSetColorIsSuccess(bool isSuccess)
 {
-    m_isTaskSetColorDone = true;
-    m_isTaskSetColorParseSuccess = isSuccess;
+    // The parse task handles requests one by one in the order they were
+    // emitted, so its results always belong to the oldest request
+    if (m_setColorRequests.isEmpty())
+    {
+        qWarning() << Q_FUNC_INFO << "Unexpected setcolor task result";
+        return;
+    }
+
+    QTcpSocket *client = m_setColorRequests.dequeue();
+
+    if (client == NULL || m_clients.contains(client) == false)
+    {
+        API_DEBUG_OUT << Q_FUNC_INFO << "client disconnected before setcolor was done";
+        return;
+    }
+
+    ClientInfo & clientInfo = m_clients[client];
+    clientInfo.isSetColorPending = false;
+
+    if (isSuccess)
+    {
+        lightpack->SetLockAlive(clientInfo.sessionKey);
+        writeData(client, CmdSetResult_Ok);
+    } else {
+        writeData(client, CmdSetResult_Error);
+    }
+
+    // Continue with commands pipelined behind the setcolor
+    processCommands(client);
+}
+
+void ApiServer::forgetSetColorRequests(QTcpSocket *client)
+{
+    for (int i = 0; i < m_setColorRequests.count(); i++)
+    {
+        if (client == NULL || m_setColorRequests[i] == client)
+            m_setColorRequests[i] = NULL;
+    }
+}
+
+void ApiServer::clientProcessBinaryFrames(QTcpSocket* client)
+{
+    uchar header[ApiBinaryFrame::HeaderSize];
+
+    while (m_clients.contains(client) && client->bytesAvailable() >= ApiBinaryFrame::HeaderSize)
+    {
+        client->peek(reinterpret_cast<char *>(header), ApiBinaryFrame::HeaderSize);
+
+        const quint8 type = header[1];
+        const quint16 sequence = qFromBigEndian<quint16>(header + 2);
+        const quint16 length = qFromBigEndian<quint16>(header + 4);
+
+        if (header[0] != ApiBinaryFrame::Magic
+                || (type != ApiBinaryFrame::SetColors && type != ApiBinaryFrame::Exit)
+                || length > ApiBinaryFrame::MaxPayloadSize)
+        {
+            // There is no way to find the next frame boundary, drop the client
+            qWarning() << Q_FUNC_INFO << "Invalid binary frame header from" << client->peerAddress().toString();
+            writeBinaryAck(client, type, sequence, ApiBinaryFrame::StatusError);
+            client->close();
+            return;
+        }
+
+        if (client->bytesAvailable() < ApiBinaryFrame::HeaderSize + length)
+        {
+            // Wait for the rest of the frame
+            return;
+        }
+
+        ClientInfo & clientInfo = m_clients[client];
+
+        client->read(reinterpret_cast<char *>(header), ApiBinaryFrame::HeaderSize);
+        client->read(clientInfo.frameBuffer.data(), length);
+
+        if (type == ApiBinaryFrame::Exit)
+        {
+            clientInfo.isBinaryMode = false;
+            clientInfo.frameBuffer.clear();
+            writeBinaryAck(client, type, sequence, ApiBinaryFrame::StatusOk);
+            return;
+        }
+
+        const uchar * payload = reinterpret_cast<const uchar *>(clientInfo.frameBuffer.constData());
+        writeBinaryAck(client, type, sequence, applyBinaryFrame(client, payload, length));
+    }
+}
+
+quint8 ApiServer::applyBinaryFrame(QTcpSocket* client, const uchar * payload, int length)
+{
+    const QString & sessionKey = m_clients[client].sessionKey;
+
+    switch (lightpack->CheckLock(sessionKey))
+    {
+    case 1:
+        break;
+    case 0:
+        return ApiBinaryFrame::StatusNotLocked;
+    default:
+        return ApiBinaryFrame::StatusBusy;
+    }
+
+    if (length == 0 || length % 3 != 0 || length / 3 > m_frameColors.count())
+    {
+        API_DEBUG_OUT << Q_FUNC_INFO << "frame length is not valid:" << length;
+        return ApiBinaryFrame::StatusError;
+    }
+
+    // LEDs missing in the frame keep their last colors, as with setcolor
+    const int count = length / 3;
+    for (int i = 0; i < count; i++, payload += 3)
+        m_frameColors[i] = qRgb(payload[0], payload[1], payload[2]);
+
+    emit updateLedsColors(m_frameColors);
+
+    lightpack->SetLockAlive(sessionKey);
+
+    return ApiBinaryFrame::StatusOk;
+}
+
+void ApiServer::writeBinaryAck(QTcpSocket* client, quint8 type, quint16 sequence, quint8 status)
+{
+    uchar ack[ApiBinaryFrame::HeaderSize];
+
+    ack[0] = ApiBinaryFrame::Magic;
+    ack[1] = type | ApiBinaryFrame::AckFlag;
+    qToBigEndian<quint16>(sequence, ack + 2);
+    ack[4] = status;
+    ack[5] = 0;
+
+    client->write(reinterpret_cast<const char *>(ack), ApiBinaryFrame::HeaderSize);
+}
+
+void ApiServer::setFrameNumberOfLeds(int value)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
+
+    m_frameNumberOfLeds = value;
+
+    reinitFrameColors();
+}
+
+void ApiServer::reinitFrameColors()
+{
+    m_frameColors.clear();
+
+    for (int i = 0; i < m_frameNumberOfLeds; i++)
+        m_frameColors << 0;
+}
+
+void ApiServer::pushColors(const QList<QRgb> & colors)
+{
+    bool hasSubscribers = false;
+
+    QMap<QTcpSocket*, ClientInfo>::iterator i;
+    for (i = m_clients.begin(); i != m_clients.end(); ++i)
+    {
+        if (i.value().isSubscribed && i.value().isBinaryMode == false)
+        {
+            i.value().isPushPending = true;
+            hasSubscribers = true;
+        }
+    }
+
+    if (hasSubscribers == false)
+        return;
+
+    // One line for all subscribers, 6 hex digits per led
+    static const char hexDigits[] = "0123456789abcdef";
+    const int prefixLength = strlen(PushColors);
+
+    m_pushColorsLine.resize(prefixLength + colors.count() * 6 + 2);
+    char *out = m_pushColorsLine.data();
+
+    memcpy(out, PushColors, prefixLength);
+    out += prefixLength;
+
+    for (int led = 0; led < colors.count(); led++)
+    {
+        const QRgb rgb = colors[led];
+        const int components[3] = { qRed(rgb), qGreen(rgb), qBlue(rgb) };
+
+        for (int c = 0; c < 3; c++)
+        {
+            *out++ = hexDigits[components[c] >> 4];
+            *out++ = hexDigits[components[c] & 0x0f];
+        }
+    }
+    *out++ = '\r';
+    *out++ = '\n';
+
+    flushPendingPushes();
+}
+
+void ApiServer::pushStatus(int status)
+{
+    if (status == 1)
+        pushEvent(CmdResultStatus_On);
+    else if (status == 0)
+        pushEvent(CmdResultStatus_Off);
+    else
+        pushEvent(CmdResultStatus_DeviceError);
+}
+
+void ApiServer::pushProfile(const QString & profile)
+{
+    pushEvent(CmdResultProfile + profile.toUtf8() + "\r\n");
+}
+
+void ApiServer::pushLockStatus(bool isLocked)
+{
+    pushEvent(isLocked ? CmdResultStatusAPI_Busy : CmdResultStatusAPI_Idle);
+}
+
+void ApiServer::pushEvent(const QByteArray & event)
+{
+    // Events are rare and never coalesced
+    const QByteArray line = PushEvent + event;
+
+    QMap<QTcpSocket*, ClientInfo>::iterator i;
+    for (i = m_clients.begin(); i != m_clients.end(); ++i)
+    {
+        if (i.value().isSubscribed && i.value().isBinaryMode == false)
+            writePush(i.key(), i.value(), line);
+    }
+}
+
+void ApiServer::flushPendingPushes()
+{
+    int nextPushMs = -1;
+
+    QMap<QTcpSocket*, ClientInfo>::iterator i;
+    for (i = m_clients.begin(); i != m_clients.end(); ++i)
+    {
+        ClientInfo & clientInfo = i.value();
+
+        if (clientInfo.isPushPending == false)
+            continue;
+
+        if (clientInfo.isBinaryMode)
+        {
+            clientInfo.isPushPending = false;
+            continue;
+        }
+
+        if (clientInfo.lastPushTime.isValid())
+        {
+            const int waitMs = clientInfo.pushIntervalMs - static_cast<int>(clientInfo.lastPushTime.elapsed());
+            if (waitMs > 0)
+            {
+                // Too early for this client, it gets the latest frame later
+                if (nextPushMs < 0 || waitMs < nextPushMs)
+                    nextPushMs = waitMs;
+                continue;
+            }
+        }
+
+        clientInfo.isPushPending = false;
+        if (writePush(i.key(), clientInfo, m_pushColorsLine))
+            clientInfo.lastPushTime.start();
+    }
+
+    if (nextPushMs >= 0)
+        m_pushTimer->start(nextPushMs);
+}
+
+bool ApiServer::writePush(QTcpSocket* client, ClientInfo & clientInfo, const QByteArray & data)
+{
+    if (client->bytesToWrite() > PushBacklogMaxBytes)
+    {
+        // The client does not keep up, don't let its send buffer grow
+        qWarning() << Q_FUNC_INFO << "Client is too slow, dropping:" << client->peerAddress().toString()
+                   << "pending bytes:" << client->bytesToWrite();
+
+        clientInfo.isSubscribed = false;
+        clientInfo.isPushPending = false;
+
+        // Aborting here would remove the client from m_clients while the
+        // caller iterates over it
+        if (m_slowClients.isEmpty())
+            QMetaObject::invokeMethod(this, "dropSlowClients", Qt::QueuedConnection);
+        m_slowClients << client;
+
+        return false;
+    }
+
+    client->write(data);
+    return true;
+}
+
+void ApiServer::dropSlowClients()
+{
+    QList<QTcpSocket*> slowClients = m_slowClients;
+    m_slowClients.clear();
+
+    for (int i = 0; i < slowClients.count(); i++)
+    {
+        // Emits disconnected(), the rest is done in clientDisconnected()
+        if (m_clients.contains(slowClients[i]))
+            slowClients[i]->abort();
+    }
 }
 
 void ApiServer::initPrivateVariables()
@@ -1065,13 +1452,12 @@ void ApiServer::initPrivateVariables()
 
 void ApiServer::initApiSetColorTask()
 {
-    m_isTaskSetColorDone = true;
-
     m_apiSetColorTaskThread = new QThread();
     m_apiSetColorTask = new ApiServerSetColorTask();
     m_apiSetColorTask->setApiDeviceNumberOfLeds(Settings::getNumberOfLeds(Settings::getConnectedDevice()));
 
-    //connect(m_apiSetColorTask, SIGNAL(taskParseSetColorDone(QList<QRgb>)), this, SIGNAL(updateLedsColors(QList<QRgb>)), Qt::QueuedConnection);
+    // Emitted right from the task thread, receivers are queued to their own threads
+    connect(m_apiSetColorTask, SIGNAL(taskParseSetColorDone(QList<QRgb>)), this, SIGNAL(updateLedsColors(QList<QRgb>)), Qt::DirectConnection);
     connect(m_apiSetColorTask, SIGNAL(taskParseSetColorIsSuccess(bool)), this, SLOT(taskSetColorIsSuccess(bool)), Qt::QueuedConnection);
 
     connect(this, SIGNAL(startParseSetColorTask(QByteArray)), m_apiSetColorTask, SLOT(startParseSetColorTask(QByteArray)), Qt::QueuedConnection);
@@ -1081,6 +1467,21 @@ void ApiServer::initApiSetColorTask()
 
     m_apiSetColorTask->moveToThread(m_apiSetColorTaskThread);
     m_apiSetColorTaskThread->start();
+
+    // Binary frames are decoded in place on the server thread
+    m_frameNumberOfLeds = Settings::getNumberOfLeds(Settings::getConnectedDevice());
+    reinitFrameColors();
+
+    connect(this, SIGNAL(updateApiDeviceNumberOfLeds(int)), this, SLOT(setFrameNumberOfLeds(int)));
+    connect(this, SIGNAL(clearColorBuffers()),              this, SLOT(reinitFrameColors()));
+}
+
+void ApiServer::initPushTimer()
+{
+    m_pushTimer = new QTimer(this);
+    m_pushTimer->setSingleShot(true);
+
+    connect(m_pushTimer, SIGNAL(timeout()), this, SLOT(flushPendingPushes()));
 }
 
 void ApiServer::startListening()
@@ -1099,6 +1500,36 @@ void ApiServer::startListening()
 
         emit errorOnStartListening(errorStr);
     }
+
+    if (Settings::isApiUdpEnabled())
+    {
+        if (!m_apiAuthKey.isEmpty())
+        {
+            // Datagrams carry no key, keep the endpoint closed when the API is protected
+            qWarning() << Q_FUNC_INFO << "UDP frames are disabled while API authorization key is set";
+        }
+        else
+        {
+            QString multicastGroup = Settings::getApiUdpMulticastGroup();
+            if (m_listenOnlyOnLoInterface && !multicastGroup.isEmpty())
+            {
+                // Multicast needs the socket bound to any address, it would take frames from the whole network
+                qWarning() << Q_FUNC_INFO << "UDP multicast group" << multicastGroup
+                           << "is ignored while API listens only on the loopback interface";
+                multicastGroup.clear();
+            }
+
+            if (!m_udpServer->start(address, Settings::getApiUdpPort(), multicastGroup))
+            {
+                QString errorStr = tr("API server unable to receive UDP frames (port: %1).")
+                        .arg(Settings::getApiUdpPort());
+
+                qCritical() << Q_FUNC_INFO << errorStr;
+
+                emit errorOnStartListening(errorStr);
+            }
+        }
+    }
 }
 
 void ApiServer::stopListening()
@@ -1107,6 +1538,7 @@ void ApiServer::stopListening()
 
     // Closes the server. The server will no longer listen for incoming connections.
     close();
+    m_udpServer->stop();
 
     QMap<QTcpSocket*, ClientInfo>::iterator i;
     for (i = m_clients.begin(); i != m_clients.end(); ++i)
@@ -1126,6 +1558,25 @@ void ApiServer::stopListening()
     }
 
     m_clients.clear();
+
+    forgetSetColorRequests(NULL);
+    m_slowClients.clear();
+    m_pushTimer->stop();
+}
+
+bool ApiServer::invokeInterface(const char *method, QGenericReturnArgument ret, QGenericArgument val0, QGenericArgument val1)
+{
+    // Commands which change profiles, settings or backlight state are run on
+    // the interface thread (GUI thread in the application), the server
+    // thread waits for the result
+    Qt::ConnectionType type = (lightpack->thread() == QThread::currentThread())
+            ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
+
+    bool ok = QMetaObject::invokeMethod(lightpack, method, type, ret, val0, val1);
+    if (!ok)
+        qWarning() << Q_FUNC_INFO << "Unable to invoke" << method;
+
+    return ok;
 }
 
 void ApiServer::writeData(QTcpSocket* client, const QString & data)
@@ -1259,6 +1710,25 @@ void ApiServer::initHelpMessage()
                 formatHelp(CmdResultBacklight_Ambilight) +
                 formatHelp(CmdResultBacklight_Moodlamp)
                 );
+    m_helpMessage += formatHelp(
+                CmdSubscribe,
+                QString("Push colors and events to this connection instead of polling getcolors. "
+                        "Colors are sent as \"frame:RRGGBB...\", 6 hex digits per led starting from the first one, "
+                        "at most %1 frames per second by default or as many as set in the argument [1 - %2]. "
+                        "Status, profile and lock changes are sent as \"event:\" followed by the getstatus, getprofile or getstatusapi result. "
+                        "Connections which don't read the pushed data are closed.")
+                .arg(PushRateDefault).arg(PushRateMax),
+                formatHelp(CmdSubscribe) +
+                formatHelp(CmdSubscribe + QString(":60")),
+                formatHelp(CmdResultSubscribe_Ok) +
+                formatHelp(PushColors + QString("ff0000000000")) +
+                formatHelp(PushEvent + QString(CmdResultStatus_On)) +
+                formatHelp(CmdSetResult_Error));
+    m_helpMessage += formatHelp(
+                CmdUnsubscribe,
+                "Stop pushing colors and events",
+                formatHelp(CmdResultUnsubscribe_Ok)
+                );
 
     // Set-commands
 
@@ -1275,6 +1745,13 @@ void ApiServer::initHelpMessage()
                 formatHelp(CmdSetColor + QString("1-255,255,30;2-12,12,12;3-1,2,3;")),
                 helpCmdSetResults);
 
+    m_helpMessage += formatHelp(
+                CmdBinaryMode,
+                "Switch the connection to binary frames. Each frame is a 6 byte header (0xA5, type, 16-bit sequence, 16-bit payload length; big-endian) "
+                "followed by packed R,G,B bytes starting from the first led. Type 1 sets colors, type 2 returns to text commands. "
+                "Every frame is acknowledged with a 6 byte header (0xA5, type | 0x80, sequence, status, 0), status: 0 - ok, 1 - error, 2 - busy, 3 - not locked.",
+                formatHelp(CmdResultBinaryMode_Ok));
+
     m_helpMessage += formatHelp(
                 CmdSetLeds,
                 "Set areas on several LEDs. Format: \"N-X,Y,W,H;\", where N - number of led, X,Y - position, H,W-size. Works only on locking time (see lock).",
@@ -1359,7 +1836,8 @@ void ApiServer::initShortHelpMessage()
          << CmdGetStatus << CmdGetStatusAPI
          << CmdGetProfile << CmdGetProfiles << CmdGetCountLeds
          << CmdSetColor << CmdSetGamma << CmdSetBrightness
-         << CmdSetSmooth << CmdSetProfile << CmdSetStatus
+         << CmdSetSmooth << CmdSetProfile << CmdSetStatus << CmdBinaryMode
+         << CmdSubscribe << CmdUnsubscribe
          << CmdExit << CmdHelp << CmdHelpShort;
 
     QString line = "    ";
@@ -32,18 +32,58 @@
 #include <QTcpSocket>
 #include <QMap>
 #include <QSet>
+#include <QQueue>
 #include <QRgb>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QTimer>
 #include "SettingsWindow.hpp"
 #include "LightpackPluginInterface.hpp"
 #include "ApiServerSetColorTask.hpp"
 #include "debug.h"
 #include "enums.hpp"
 
+// Binary frame stream, enabled per client by the "binarymode" text command.
+// Every frame starts with a fixed header:
+//   [0] Magic, [1] type, [2..3] sequence, [4..5] payload length (big-endian)
+// SetColors payload is packed R,G,B bytes for LEDs 1..N. Each frame is
+// answered with a header-sized ack:
+//   [0] Magic, [1] type | AckFlag, [2..3] sequence, [4] status, [5] reserved
+namespace ApiBinaryFrame
+{
+enum Layout {
+    HeaderSize = 6,
+    MaxPayloadSize = MaximumNumberOfLeds::AbsoluteMaximum * 3
+};
+enum Marker {
+    Magic = 0xA5,
+    AckFlag = 0x80
+};
+enum Type {
+    SetColors = 0x01,
+    Exit = 0x02
+};
+enum Status {
+    StatusOk = 0,
+    StatusError = 1,
+    StatusBusy = 2,
+    StatusNotLocked = 3
+};
+}
+
+class ApiUdpServer;
+
 struct ClientInfo
 {
     bool isAuthorized;
     QString sessionKey;
+    bool isBinaryMode;
+    bool isSetColorPending; // the next commands wait for the setcolor result
+    QByteArray frameBuffer; // reused for every binary frame payload
+    bool isSubscribed;
+    bool isPushPending;     // colors changed since the last pushed frame
+    int pushIntervalMs;
+    QElapsedTimer lastPushTime;
     // Think about it. May be we need to save gamma,
     // smooth and brightness and after success lock send
     // this values to device?
@@ -58,7 +98,6 @@ public:
     ApiServer(quint16 port, QObject *parent = 0);
 
     void setInterface(LightpackPluginInterface *lightpackInterface);
-    void firstStart();
 
 public:
     static const char * ApiVersion;   
@@ -161,15 +200,30 @@ public:
     static const char * CmdSetBacklight_Ambilight;
     static const char * CmdSetBacklight_Moodlamp;
 
+    static const char * CmdBinaryMode;
+    static const char * CmdResultBinaryMode_Ok;
+
+    static const char * CmdSubscribe;
+    static const char * CmdResultSubscribe_Ok;
+    static const char * CmdUnsubscribe;
+    static const char * CmdResultUnsubscribe_Ok;
+    static const char * PushColors;
+    static const char * PushEvent;
+
     static const int SignalWaitTimeoutMs;
+    static const int PushRateDefault;
+    static const int PushRateMax;
+    static const int PushBacklogMaxBytes;
 
 signals:
     void startParseSetColorTask(QByteArray buffer);
     void errorOnStartListening(QString errorMessage);
     void clearColorBuffers();
     void updateApiDeviceNumberOfLeds(int value);
+    void updateLedsColors(const QList<QRgb> & colors);
 
 public slots:
+    void firstStart();
     void apiServerSettingsChanged();
     void updateApiKey(const QString &key);
 
@@ -180,14 +234,32 @@ private slots:
     void clientDisconnected();
     void clientProcessCommands();
     void taskSetColorIsSuccess(bool isSuccess);
+    void setFrameNumberOfLeds(int value);
+    void reinitFrameColors();
+    void pushColors(const QList<QRgb> & colors);
+    void pushStatus(int status);
+    void pushProfile(const QString & profile);
+    void pushLockStatus(bool isLocked);
+    void flushPendingPushes();
+    void dropSlowClients();
 
 private:
     LightpackPluginInterface *lightpack;
     void initPrivateVariables();
     void initApiSetColorTask();
+    void initPushTimer();
     void startListening();
     void stopListening();
+    void processCommands(QTcpSocket* client);
+    void forgetSetColorRequests(QTcpSocket* client);
+    bool invokeInterface(const char *method, QGenericReturnArgument ret,
+                         QGenericArgument val0 = QGenericArgument(0), QGenericArgument val1 = QGenericArgument());
     void writeData(QTcpSocket* client, const QString & data);
+    void clientProcessBinaryFrames(QTcpSocket* client);
+    quint8 applyBinaryFrame(QTcpSocket* client, const uchar * payload, int length);
+    void writeBinaryAck(QTcpSocket* client, quint8 type, quint16 sequence, quint8 status);
+    void pushEvent(const QByteArray & event);
+    bool writePush(QTcpSocket* client, ClientInfo & clientInfo, const QByteArray & data);
     QString formatHelp(const QString & cmd);
     QString formatHelp(const QString & cmd, const QString & description);
     QString formatHelp(const QString & cmd, const QString & description, const QString & results);
@@ -200,15 +272,26 @@ private:
     bool m_listenOnlyOnLoInterface;
     QString m_apiAuthKey;
     bool m_isAuthEnabled;
-    QTime m_time;
 
     QMap <QTcpSocket*, ClientInfo> m_clients;
 
     QThread *m_apiSetColorTaskThread;
     ApiServerSetColorTask *m_apiSetColorTask;
 
-    bool m_isTaskSetColorDone;
-    bool m_isTaskSetColorParseSuccess;
+    ApiUdpServer *m_udpServer;
+
+    // Clients waiting for the setcolor parse task, in request order.
+    // Disconnected clients are replaced with NULL to keep the order.
+    QQueue<QTcpSocket*> m_setColorRequests;
+
+    int m_frameNumberOfLeds;
+    QList<QRgb> m_frameColors;
+
+    // Subscribed clients get the latest colors at most once per their
+    // push interval, frames in between are coalesced
+    QByteArray m_pushColorsLine;
+    QTimer *m_pushTimer;
+    QList<QTcpSocket*> m_slowClients;
 
     QString m_helpMessage;
     QString m_shortHelpMessage;
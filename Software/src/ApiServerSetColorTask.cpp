@@ -38,135 +38,95 @@ ApiServerSetColorTask::ApiServerSetColorTask(QObject *parent) :
     reinitColorBuffers();
 }
 
-void ApiServerSetColorTask::startParseSetColorTask(QByteArray buffer)
+// Reads an unsigned number of at most maxValue, returns false if there is no
+// digit at the cursor or the number is too big. Leading zeros are accepted.
+static inline bool readNumber(const char *&it, const char *end, int maxValue, int &value)
 {
-    API_DEBUG_OUT << QString(buffer) << "task thread:" << thread()->currentThreadId();
-    bool isReadFail = false;
+    if (it == end || PrismatikMath::getDigit(*it) < 0)
+        return false;
+
+    value = 0;
+    do {
+        value = value * 10 + PrismatikMath::getDigit(*it);
+        if (value > maxValue)
+            return false;
+        ++it;
+    } while (it != end && PrismatikMath::getDigit(*it) >= 0);
+
+    return true;
+}
 
-    // buffer can contains only something like this:
+int ApiServerSetColorTask::parseSetColor(const char *begin, const char *end, QRgb *colors, int numberOfLeds)
+{
+    // begin..end can contains only something like this:
     // 1-34,9,125
-    // 2-0,255,0;3-0,255,0;6-0,255,0;
+    // 2-0,255,0;3-0,255,0;255-0,255,0;
 
-    while (buffer.isEmpty() == false)
-    {
-        if (isReadFail == true)
-        {
-            qWarning() << "got it!";
-        }
+    const char *it = begin;
 
-        // Check buffer length, minimum 7 - '2-0,0,0'
-        if (buffer.length() < 7)
-        {
-            API_DEBUG_OUT << "error: buffer.length() < 7";
-            isReadFail = true;
-            goto end;
-        }
+    if (it == end)
+        return 0;
 
-        // Read led number
-        int ledNumber = PrismatikMath::getDigit(buffer[0]); // first char of ledNumber
-        int ledNumber2 = PrismatikMath::getDigit(buffer[1]); // second char of ledNumber
-        if (ledNumber > 0)
-        {
-            if (buffer[1] == '-')
-            {
-                buffer.remove(0, 2); // remove "2-"
-            }
-            else if (ledNumber2 >= 0 && buffer[2] == '-')
-            {
-                ledNumber = ledNumber * 10 + ledNumber2; // 10,11,12..99
-                buffer.remove(0, 3); // remove "10-"
-            } else {
-                API_DEBUG_OUT << "lednumber fail:" << QString(buffer);
-                isReadFail = true;
-                goto end;
-            }
-        } else {
-            API_DEBUG_OUT << "isdigit fail:" << QString(buffer);
-            isReadFail = true;
-            goto end;
-        }
+    while (it != end)
+    {
+        // Led number, zero and leading zeros are not allowed
+        int ledNumber = 0;
+        if (*it == '0' || readNumber(it, end, numberOfLeds, ledNumber) == false)
+            return it - begin;
 
-        API_DEBUG_OUT << "lednumber-" << ledNumber << "buff-" << QString(buffer);
+        if (it == end || *it != '-')
+            return it - begin;
+        ++it;
 
-        if (ledNumber <= 0 || ledNumber > m_numberOfLeds)
+        int rgb[3];
+        for (int i = 0; i < 3; i++)
         {
-            API_DEBUG_OUT << "ledNumber is out of bounds:" << ledNumber;
-            isReadFail = true;
-            goto end;
-        }
+            if (readNumber(it, end, 255, rgb[i]) == false)
+                return it - begin;
 
-        // Convert for using in zero-based arrays
-        ledNumber = ledNumber - 1;
-
-        // Read led red, green and blue colors to buffer buffRgb[]
-        int indexBuffer = 0;
-        int indexRgb = 0;        
-        memset(buffRgb, 0, sizeof(buffRgb));
-
-        bool isDigitExpected = true;
-        for (indexBuffer = 0; indexBuffer < buffer.length(); indexBuffer++)
-        {
-            int d = PrismatikMath::getDigit(buffer[indexBuffer]);
-            if (d < 0)
+            if (i < 2)
             {
-                if (buffer[indexBuffer] == ';')
-                {
-                    break;
-                }
-                else if (buffer[indexBuffer] != ',')
-                {
-                    API_DEBUG_OUT << "expected comma, buffer:" << QString(buffer) << indexBuffer << buffer[indexBuffer];
-                    isReadFail = true;
-                    goto end;
-                }
-                else if (isDigitExpected)
-                {
-                    API_DEBUG_OUT << "expected digit, buffer:" << QString(buffer) << indexBuffer << buffer[indexBuffer];
-                    isReadFail = true;
-                    goto end;
-                }
-                isDigitExpected = true;
-                indexRgb++;
-            } else {
-                buffRgb[indexRgb] *= 10;
-                buffRgb[indexRgb] += d;
-
-                isDigitExpected = false;
-
-                if (buffRgb[indexRgb] > 255)
-                {
-                    API_DEBUG_OUT << "rgb value > 255";
-                    isReadFail = true;
-                    goto end;
-                }
+                if (it == end || *it != ',')
+                    return it - begin;
+                ++it;
             }
         }
 
-        // Remove read colors
-        buffer.remove(0, indexBuffer);
+        colors[ledNumber - 1] = qRgb(rgb[0], rgb[1], rgb[2]);
 
-        // Save colors
-        m_colors[ledNumber] = qRgb(buffRgb[bRed], buffRgb[bGreen], buffRgb[bBlue]);
+        if (it == end)
+            break;
 
-        API_DEBUG_OUT << "result color:" << buffRgb[bRed] << buffRgb[bGreen] << buffRgb[bBlue]
-                      << "buffer:" << QString(buffer);
+        if (*it != ';')
+            return it - begin;
+        ++it;
+    }
 
-        if (buffer[0] == ';')
-        {
-            // Remove semicolon
-            buffer.remove(0, 1);
+    return ParseOk;
+}
 
-            API_DEBUG_OUT << "buffer.isEmpty() == " << buffer.isEmpty();
-        }
-    }
+void ApiServerSetColorTask::startParseSetColorTask(QByteArray buffer)
+{
+    API_DEBUG_OUT << QString(buffer) << "task thread:" << thread()->currentThreadId();
+
+    const char *begin = buffer.constData();
+    int errorOffset = parseSetColor(begin, begin + buffer.length(), m_parsedColors, m_numberOfLeds);
 
-end:
-    if (isReadFail)
+    if (errorOffset != ParseOk)
     {
-        API_DEBUG_OUT << "errors while reading buffer";
+        API_DEBUG_OUT << "errors while reading buffer at" << errorOffset << QString(buffer.mid(errorOffset));
+
+        // Drop colors written before the error
+        for (int i = 0; i < m_numberOfLeds; i++)
+            m_parsedColors[i] = m_colors[i];
+
         emit taskParseSetColorIsSuccess(false);
     } else {
         API_DEBUG_OUT << "read setcolor buffer - ok";
+
+        for (int i = 0; i < m_numberOfLeds; i++)
+            m_colors[i] = m_parsedColors[i];
+
         emit taskParseSetColorDone(m_colors);
         emit taskParseSetColorIsSuccess(true);
     }
@@ -179,16 +139,14 @@ void ApiServerSetColorTask::reinitColorBuffers()
     for (int i = 0; i < m_numberOfLeds; i++)
         m_colors << 0;
 
-    buffRgb[bRed] = 0;
-    buffRgb[bGreen] = 0;
-    buffRgb[bBlue] = 0;
+    memset(m_parsedColors, 0, sizeof(m_parsedColors));
 }
 
 void ApiServerSetColorTask::setApiDeviceNumberOfLeds(int value)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
 
-    m_numberOfLeds = value;
+    m_numberOfLeds = qBound(0, value, static_cast<int>(MaximumNumberOfLeds::AbsoluteMaximum));
 
     reinitColorBuffers();
 }
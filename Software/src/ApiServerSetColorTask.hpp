@@ -29,6 +29,7 @@
 #include <QObject>
 #include <QRgb>
 #include "debug.h"
+#include "enums.hpp"
 
 class ApiServerSetColorTask : public QObject
 {
@@ -36,6 +37,15 @@ class ApiServerSetColorTask : public QObject
 public:
     explicit ApiServerSetColorTask(QObject *parent = 0);
 
+    enum { ParseOk = -1 };
+
+    // Parses setcolor arguments "N-R,G,B;N-R,G,B;..." (N = 1..numberOfLeds,
+    // R,G,B = 0..255, last semicolon is optional) in one pass, writing
+    // colors to colors[N-1]. Returns ParseOk or the offset of the first
+    // invalid character (end - begin if the command is truncated). On error
+    // the LEDs before that offset are already written.
+    static int parseSetColor(const char *begin, const char *end, QRgb *colors, int numberOfLeds);
+
 signals:
     void taskParseSetColorDone(const QList<QRgb> & colors);
     void taskParseSetColorIsSuccess(bool isSuccess);
@@ -49,9 +59,6 @@ private:
     QList<QRgb> m_colors;
     int m_numberOfLeds;
 
-    enum BuffRgbIndexes{
-        bRed, bGreen, bBlue, bSize
-    };
-    int buffRgb[bSize]; // buffer for store temp red, green and blue values
-
+    // Parser output, kept in sync with m_colors between commands
+    QRgb m_parsedColors[MaximumNumberOfLeds::AbsoluteMaximum];
 };
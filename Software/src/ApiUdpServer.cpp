@@ -0,0 +1,220 @@
+/*
+ * ApiUdpServer.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QUdpSocket>
+#include <QTimer>
+#include <QtEndian>
+#include "ApiUdpServer.hpp"
+#include "LightpackPluginInterface.hpp"
+#include "debug.h"
+
+// Contains "API" so the interface treats it as an API client lock
+const char * ApiUdpServer::SessionKey = "API-UDP";
+const int ApiUdpServer::LockTimeoutMs = 2000;
+
+ApiUdpServer::ApiUdpServer(QObject *parent)
+    : QObject(parent)
+    , m_lightpack(NULL)
+    , m_socket(NULL)
+    , m_lockHandle(0)
+    , m_hasSequence(false)
+    , m_lastSequence(0)
+    , m_lastSenderPort(0)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    m_lockTimer = new QTimer(this);
+    m_lockTimer->setSingleShot(true);
+    m_lockTimer->setInterval(LockTimeoutMs);
+    connect(m_lockTimer, SIGNAL(timeout()), this, SLOT(releaseLock()));
+
+    m_datagram.resize(ApiUdpFrame::MaxDatagramSize);
+}
+
+ApiUdpServer::~ApiUdpServer()
+{
+    stop();
+}
+
+void ApiUdpServer::setInterface(LightpackPluginInterface *lightpackInterface)
+{
+    m_lightpack = lightpackInterface;
+}
+
+bool ApiUdpServer::start(const QHostAddress & address, quint16 port, const QString & multicastGroup)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << address.toString() << port << multicastGroup;
+
+    stop();
+
+    m_socket = new QUdpSocket(this);
+
+    QHostAddress bindAddress = address;
+    if (!multicastGroup.isEmpty())
+    {
+        m_multicastGroup = QHostAddress(multicastGroup);
+        // Multicast datagrams are only delivered to sockets bound to any address
+        bindAddress = QHostAddress::AnyIPv4;
+    }
+
+    if (!m_socket->bind(bindAddress, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint))
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to bind UDP port" << port << m_socket->errorString();
+        stop();
+        return false;
+    }
+
+    if (!m_multicastGroup.isNull() && !m_socket->joinMulticastGroup(m_multicastGroup))
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to join multicast group" << multicastGroup << m_socket->errorString();
+        stop();
+        return false;
+    }
+
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
+
+    return true;
+}
+
+void ApiUdpServer::stop()
+{
+    if (m_socket == NULL)
+        return;
+
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+
+    if (!m_multicastGroup.isNull())
+        m_socket->leaveMulticastGroup(m_multicastGroup);
+    m_multicastGroup.clear();
+
+    m_socket->close();
+    m_socket->deleteLater();
+    m_socket = NULL;
+
+    m_lockTimer->stop();
+    releaseLock();
+}
+
+bool ApiUdpServer::isListening() const
+{
+    return m_socket != NULL;
+}
+
+void ApiUdpServer::readPendingDatagrams()
+{
+    QHostAddress sender;
+    quint16 senderPort = 0;
+
+    while (m_socket != NULL && m_socket->hasPendingDatagrams())
+    {
+        // Oversized datagrams are truncated to the buffer and fail the size check
+        qint64 pendingSize = m_socket->pendingDatagramSize();
+        qint64 size = m_socket->readDatagram(m_datagram.data(), m_datagram.size(), &sender, &senderPort);
+
+        m_stats.received++;
+
+        if (size < 0 || pendingSize > m_datagram.size())
+        {
+            m_stats.invalid++;
+            continue;
+        }
+
+        applyDatagram(reinterpret_cast<const uchar *>(m_datagram.constData()), size, sender, senderPort);
+    }
+}
+
+void ApiUdpServer::applyDatagram(const uchar *data, int size, const QHostAddress & sender, quint16 senderPort)
+{
+    const int payloadSize = size - ApiUdpFrame::HeaderSize;
+
+    if (payloadSize <= 0 || payloadSize % 3 != 0 || data[0] != ApiUdpFrame::Magic)
+    {
+        m_stats.invalid++;
+        return;
+    }
+
+    if ((data[1] & ApiUdpFrame::HasSequence) && isStale(qFromBigEndian<quint16>(data + 2), sender, senderPort))
+    {
+        m_stats.stale++;
+        return;
+    }
+
+    const int count = payloadSize / 3;
+    const uchar *rgb = data + ApiUdpFrame::HeaderSize;
+
+    for (int i = 0; i < count; i++, rgb += 3)
+        m_frame[i] = qRgb(rgb[0], rgb[1], rgb[2]);
+
+    if (!m_lightpack->SetFrameByHandle(m_lockHandle, m_frame, count))
+    {
+        // First frame of the session or the lock was lost, lock again
+        if (m_lightpack->CheckLock(SessionKey) != 1 && !m_lightpack->Lock(SessionKey))
+        {
+            m_stats.busy++;
+            return;
+        }
+
+        m_lockHandle = m_lightpack->LockHandle(SessionKey);
+
+        if (!m_lightpack->SetFrameByHandle(m_lockHandle, m_frame, count))
+        {
+            m_stats.busy++;
+            return;
+        }
+    }
+
+    m_lockTimer->start();
+    m_stats.applied++;
+}
+
+bool ApiUdpServer::isStale(quint16 sequence, const QHostAddress & sender, quint16 senderPort)
+{
+    if (m_hasSequence && sender == m_lastSender && senderPort == m_lastSenderPort)
+    {
+        // Serial number arithmetic: newer if ahead by less than half the range
+        qint16 distance = static_cast<qint16>(sequence - m_lastSequence);
+        if (distance <= 0)
+            return true;
+    }
+
+    m_hasSequence = true;
+    m_lastSequence = sequence;
+    m_lastSender = sender;
+    m_lastSenderPort = senderPort;
+
+    return false;
+}
+
+void ApiUdpServer::releaseLock()
+{
+    m_hasSequence = false;
+    m_lockHandle = 0;
+
+    if (m_lightpack != NULL && m_lightpack->CheckLock(SessionKey) == 1)
+    {
+        DEBUG_LOW_LEVEL << Q_FUNC_INFO << "no frames for" << LockTimeoutMs << "ms, unlock";
+        m_lightpack->UnLock(SessionKey);
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * ApiUdpServer.hpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QHostAddress>
+#include <QColor>
+#include <QList>
+#include "enums.hpp"
+
+class QUdpSocket;
+class QTimer;
+class LightpackPluginInterface;
+
+// Datagram layout of the UDP frame endpoint:
+//   [0] Magic, [1] flags, [2..3] sequence (big-endian), [4..] R,G,B bytes for LEDs 1..N
+// With HasSequence flag, datagrams not newer than the last applied one from
+// the same sender are dropped as stale (16-bit wrap-around comparison).
+namespace ApiUdpFrame
+{
+enum Layout {
+    HeaderSize = 4,
+    MaxDatagramSize = HeaderSize + MaximumNumberOfLeds::AbsoluteMaximum * 3
+};
+enum Marker {
+    Magic = 0xA6
+};
+enum Flags {
+    HasSequence = 0x01
+};
+}
+
+// Receives whole frames over UDP and applies them through
+// LightpackPluginInterface::SetFrameByHandle() under its own API session. The
+// lock is taken on the first frame and released after LockTimeoutMs without
+// frames.
+class ApiUdpServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ApiUdpServer(QObject *parent = 0);
+    ~ApiUdpServer();
+
+    void setInterface(LightpackPluginInterface *lightpackInterface);
+
+    // Empty multicastGroup means unicast only. Joining a group binds to any
+    // address instead of the given one, callers restricted to loopback pass none
+    bool start(const QHostAddress & address, quint16 port, const QString & multicastGroup);
+    void stop();
+    bool isListening() const;
+
+    struct Stats
+    {
+        quint32 received;
+        quint32 applied;
+        quint32 stale;
+        quint32 invalid;
+        quint32 busy;
+    };
+    Stats stats() const { return m_stats; }
+
+    static const char * SessionKey;
+    static const int LockTimeoutMs;
+
+private slots:
+    void readPendingDatagrams();
+    void releaseLock();
+
+private:
+    void applyDatagram(const uchar *data, int size, const QHostAddress & sender, quint16 senderPort);
+    bool isStale(quint16 sequence, const QHostAddress & sender, quint16 senderPort);
+
+private:
+    LightpackPluginInterface *m_lightpack;
+    QUdpSocket *m_socket;
+    QTimer *m_lockTimer;
+    QHostAddress m_multicastGroup;
+
+    QByteArray m_datagram;
+    QRgb m_frame[MaximumNumberOfLeds::AbsoluteMaximum];
+    int m_lockHandle;
+
+    bool m_hasSequence;
+    quint16 m_lastSequence;
+    QHostAddress m_lastSender;
+    quint16 m_lastSenderPort;
+
+    Stats m_stats;
+};
@@ -50,6 +50,7 @@ GrabConfigWidget::GrabConfigWidget(QWidget *parent) :
     connect(ui->spinBox_Red,    SIGNAL(valueChanged(int)), this, SLOT(onCoefRed_ValueChanged(int)));
     connect(ui->spinBox_Green,  SIGNAL(valueChanged(int)), this, SLOT(onCoefGreen_ValueChanged(int)));
     connect(ui->spinBox_Blue,   SIGNAL(valueChanged(int)), this, SLOT(onCoefBlue_ValueChanged(int)));
+    connect(ui->comboBox_ReductionMode, SIGNAL(currentIndexChanged(int)), this, SIGNAL(reductionMode_Changed(int)));
 }
 
 GrabConfigWidget::~GrabConfigWidget()
@@ -104,6 +105,11 @@ bool GrabConfigWidget::isAreaEnabled()
     return ui->checkBox_IsAreaEnabled->isChecked();
 }
 
+void GrabConfigWidget::setReductionMode(int reductionMode)
+{
+    ui->comboBox_ReductionMode->setCurrentIndex(reductionMode);
+}
+
 void GrabConfigWidget::setArrow(ArrowSide arrowSide)
 {
     m_arrowSide = arrowSide;
@@ -261,6 +267,7 @@ void GrabConfigWidget::onIsAreaEnabled_Toggled(bool state)
     ui->spinBox_Red->setEnabled(state);
     ui->spinBox_Green->setEnabled(state);
     ui->spinBox_Blue->setEnabled(state);
+    ui->comboBox_ReductionMode->setEnabled(state);
 
     emit isAreaEnabled_Toggled(state);
 }
@@ -44,12 +44,14 @@ public:
     void setCoefs(double red, double green, double blue);
     void setIsAreaEnabled(bool isAreaEnabled);
     bool isAreaEnabled();
+    void setReductionMode(int reductionMode);
 
 signals:
     void isAreaEnabled_Toggled(bool state);
     void coefRed_ValueChanged(double value);
     void coefGreen_ValueChanged(double value);
     void coefBlue_ValueChanged(double value);
+    void reductionMode_Changed(int reductionMode);
 
 private:
     enum ArrowSide {
@@ -41,6 +41,25 @@ void *GetMainWindowHandle()
 }
 #endif
 
+// Frames a smaller change has to hold before it is sent anyway
+static const int ChangeHoldFrames = 4;
+
+static inline bool isChannelChanged(int current, int updated, int threshold)
+{
+    // Reaching full off or full on is always sent, so fades end exactly there
+    return qAbs(current - updated) > threshold || (current != updated && (updated == 0 || updated == 0xff));
+}
+
+static inline bool isColorChanged(QRgb current, QRgb updated, int threshold)
+{
+    if (current == updated)
+        return false;
+
+    return isChannelChanged(qRed(current),   qRed(updated),   threshold)
+        || isChannelChanged(qGreen(current), qGreen(updated), threshold)
+        || isChannelChanged(qBlue(current),  qBlue(updated),  threshold);
+}
+
 GrabManager::GrabManager(QWidget *parent) : QObject(parent)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO;
@@ -57,6 +76,7 @@ GrabManager::GrabManager(QWidget *parent) : QObject(parent)
     m_grabberContext = new GrabberContext();
 
     m_isSendDataOnlyIfColorsChanged = Settings::isSendDataOnlyIfColorsChanges();
+    m_changeThreshold = Settings::getGrabChangeThreshold();
 
 //    m_grabbersThread = new QThread();
     initGrabbers();
@@ -199,12 +219,24 @@ void GrabManager::onGrabAvgColorsEnabledChanged(bool state)
     m_avgColorsOnAllLeds = state;
 }
 
+void GrabManager::onGrabLetterboxDetectionEnabledChanged(bool state)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << state;
+    m_grabberContext->isLetterboxDetectionEnabled = state;
+}
+
 void GrabManager::onSendDataOnlyIfColorsEnabledChanged(bool state)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << state;
     m_isSendDataOnlyIfColorsChanged = state;
 }
 
+void GrabManager::onGrabChangeThresholdChanged(int value)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
+    m_changeThreshold = value;
+}
+
 void GrabManager::setNumberOfLeds(int numberOfLeds)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << numberOfLeds;
@@ -231,6 +263,8 @@ void GrabManager::settingsProfileChanged(const QString &profileName)
 
     m_isSendDataOnlyIfColorsChanged = Settings::isSendDataOnlyIfColorsChanges();
     m_avgColorsOnAllLeds = Settings::isGrabAvgColorsEnabled();
+    m_changeThreshold = Settings::getGrabChangeThreshold();
+    m_grabberContext->isLetterboxDetectionEnabled = Settings::isGrabLetterboxDetectionEnabled();
 
     setNumberOfLeds(Settings::getNumberOfLeds(Settings::getConnectedDevice()));
 }
@@ -343,11 +377,21 @@ void GrabManager::handleGrabbedColors()
 //        m_colorsNew[i] = qRgb(r, g, b);
 //    }
 
+    // LED is updated only if one of its channels moved further than the threshold,
+    // otherwise it keeps the last sent color and devices see it unchanged.
+    // Smaller differences are sent once they hold for a few frames, so the
+    // output still converges to the grabbed color
     for (int i = 0; i < m_ledWidgets.size(); i++)
     {
-        if (m_colorsCurrent[i] != m_colorsNew[i])
+        if (m_colorsCurrent[i] == m_colorsNew[i])
+        {
+            m_colorsHeldFrames[i] = 0;
+        }
+        else if (isColorChanged(m_colorsCurrent[i], m_colorsNew[i], m_changeThreshold)
+                 || ++m_colorsHeldFrames[i] >= ChangeHoldFrames)
         {
             m_colorsCurrent[i] = m_colorsNew[i];
+            m_colorsHeldFrames[i] = 0;
             isColorsChanged = true;
         }
     }
@@ -534,11 +578,13 @@ void GrabManager::initColorLists(int numberOfLeds)
 
     m_colorsCurrent.clear();
     m_colorsNew.clear();
+    m_colorsHeldFrames.clear();
 
     for (int i = 0; i < numberOfLeds; i++)
     {
-        m_colorsCurrent << 0;
-        m_colorsNew     << 0;
+        m_colorsCurrent    << 0;
+        m_colorsNew        << 0;
+        m_colorsHeldFrames << 0;
     }
 }
 
@@ -559,6 +605,7 @@ void GrabManager::clearColorsCurrent()
     for (int i = 0; i < m_colorsCurrent.size(); i++)
     {
         m_colorsCurrent[i] = 0;
+        m_colorsHeldFrames[i] = 0;
     }
 }
 
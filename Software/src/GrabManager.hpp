@@ -68,7 +68,9 @@ public slots:
     void onGrabberTypeChanged(const Grab::GrabberType grabberType);
     void onGrabSlowdownChanged(int ms);
     void onGrabAvgColorsEnabledChanged(bool state);
+    void onGrabLetterboxDetectionEnabledChanged(bool state);
     void onSendDataOnlyIfColorsEnabledChanged(bool state);
+    void onGrabChangeThresholdChanged(int value);
     void start(bool isGrabEnabled);
     void settingsProfileChanged(const QString &profileName);
     void setVisibleLedWidgets(bool state);
@@ -115,6 +117,7 @@ private:
 
     QList<QRgb> m_colorsCurrent;
     QList<QRgb> m_colorsNew;
+    QList<int> m_colorsHeldFrames; // frames the new color stayed within the threshold
 
     QRect m_screenSavedRect;
     int m_screenSavedIndex;
@@ -122,6 +125,7 @@ private:
     bool m_isPauseGrabWhileResizeOrMoving;
     bool m_isSendDataOnlyIfColorsChanged;
     bool m_avgColorsOnAllLeds;
+    int m_changeThreshold;
 
     // Store last grabbing time in milliseconds
     double m_fpsMs;
@@ -81,6 +81,7 @@ GrabWidget::GrabWidget(int id, QWidget *parent) :
     connect(m_configWidget, SIGNAL(coefRed_ValueChanged(double)),   this, SLOT(onRedCoef_ValueChanged(double)));
     connect(m_configWidget, SIGNAL(coefGreen_ValueChanged(double)), this, SLOT(onGreenCoef_ValueChanged(double)));
     connect(m_configWidget, SIGNAL(coefBlue_ValueChanged(double)),  this, SLOT(onBlueCoef_ValueChanged(double)));
+    connect(m_configWidget, SIGNAL(reductionMode_Changed(int)),     this, SLOT(onReductionMode_Changed(int)));
     connect(ui->button_OpenConfig, SIGNAL(clicked()), this, SLOT(onOpenConfigButton_Clicked()));
 }
 
@@ -113,9 +114,11 @@ void GrabWidget::settingsProfileChanged()
     m_coefRed = Settings::getLedCoefRed(m_selfId);
     m_coefGreen = Settings::getLedCoefGreen(m_selfId);
     m_coefBlue = Settings::getLedCoefBlue(m_selfId);
+    m_reductionMode = Settings::getLedReductionMode(m_selfId);
 
     m_configWidget->setIsAreaEnabled(Settings::isLedEnabled(m_selfId));
     m_configWidget->setCoefs(m_coefRed, m_coefGreen, m_coefBlue);
+    m_configWidget->setReductionMode(m_reductionMode);
 
     move(Settings::getLedPosition(m_selfId));
     resize(Settings::getLedSize(m_selfId));
@@ -588,6 +591,13 @@ void GrabWidget::onBlueCoef_ValueChanged(double value)
     m_coefBlue = Settings::getLedCoefBlue(m_selfId);
 }
 
+void GrabWidget::onReductionMode_Changed(int reductionMode)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << reductionMode;
+    Settings::setLedReductionMode(m_selfId, static_cast<Grab::Calculations::ReductionMode>(reductionMode));
+    m_reductionMode = Settings::getLedReductionMode(m_selfId);
+}
+
 void GrabWidget::setBackgroundColor(QColor color)
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO << hex << color.rgb();
@@ -28,6 +28,7 @@
 
 //#include <QtWidgets/QWidget>
 #include "GrabConfigWidget.hpp"
+#include "calculations.hpp"
 
 namespace Ui {
     class GrabWidget;
@@ -46,6 +47,7 @@ public:
     double getCoefGreen();
     double getCoefBlue();
     bool isAreaEnabled();
+    Grab::Calculations::ReductionMode getReductionMode() const { return m_reductionMode; }
     void fillBackgroundWhite();
     void fillBackgroundColored();
 
@@ -67,6 +69,7 @@ private slots:
     void onRedCoef_ValueChanged(double value);
     void onGreenCoef_ValueChanged(double value);
     void onBlueCoef_ValueChanged(double value);
+    void onReductionMode_Changed(int reductionMode);
 
 private:
     virtual void closeEvent(QCloseEvent *event);
@@ -113,6 +116,8 @@ private:
     double m_coefGreen;
     double m_coefBlue;
 
+    Grab::Calculations::ReductionMode m_reductionMode;
+
     Ui::GrabWidget *ui;
 
     GrabConfigWidget *m_configWidget;
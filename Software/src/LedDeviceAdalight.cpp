@@ -75,56 +75,7 @@ void LedDeviceAdalight::setColors(const QList<QRgb> & colors)
     applyColorModifications(colors, m_colorsBuffer);
 
 
-    m_writeBuffer.clear();
-    m_writeBuffer.append(m_writeBufferHeader);
-
-    for (int i = 0; i < m_colorsBuffer.count(); i++)
-    {
-        StructRgb color = m_colorsBuffer[i];
-
-        color.r = color.r >> 4;
-        color.g = color.g >> 4;
-        color.b = color.b >> 4;
-
-        if (m_colorSequence == "RBG")
-        {
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.g);
-        }
-        else if (m_colorSequence == "BRG")
-        {
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.g);
-        }
-        else if (m_colorSequence == "BGR")
-        {
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.r);
-        }
-        else if (m_colorSequence == "GRB")
-        {
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.b);
-        }
-        else if (m_colorSequence == "GBR")
-        {
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.r);
-        }
-        else
-        {
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.b);
-        }
-    }
-
-    bool ok = writeBuffer(m_writeBuffer);
+    bool ok = writeBuffer(m_encoder.encode(m_colorsBuffer));
 
     emit commandCompleted(ok);
 }
@@ -137,16 +88,7 @@ void LedDeviceAdalight::switchOffLeds()
     for (int i = 0; i < count; i++)
         m_colorsSaved << 0;
 
-    m_writeBuffer.clear();
-    m_writeBuffer.append(m_writeBufferHeader);
-
-    for (int i = 0; i < count; i++) {
-        m_writeBuffer.append((char)0)
-                     .append((char)0)
-                     .append((char)0);
-    }
-
-    bool ok = writeBuffer(m_writeBuffer);
+    bool ok = writeBuffer(m_encoder.encodeBlack(count));
     emit commandCompleted(ok);
 }
 
@@ -170,6 +112,8 @@ void LedDeviceAdalight::setColorSequence(QString value)
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
 
     m_colorSequence = value;
+    if (!m_encoder.setColorSequence(value))
+        qWarning() << Q_FUNC_INFO << "unknown color sequence" << value << ", RGB is used";
     setColors(m_colorsSaved);
 }
 
@@ -300,4 +244,6 @@ void LedDeviceAdalight::reinitBufferHeader(int ledsCount)
     m_writeBufferHeader.append((char)ledsCountHi);
     m_writeBufferHeader.append((char)ledsCountLo);
     m_writeBufferHeader.append((char)(ledsCountHi ^ ledsCountLo ^ 0x55));
+
+    m_encoder.setHeader(m_writeBufferHeader);
 }
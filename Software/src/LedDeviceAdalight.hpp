@@ -28,6 +28,7 @@
 
 #include "AbstractLedDevice.hpp"
 #include "colorspace_types.h"
+#include "SerialFrameEncoder.hpp"
 #include <QtSerialPort/QSerialPort>
 
 class LedDeviceAdalight : public AbstractLedDevice
@@ -61,7 +62,7 @@ private:
     QSerialPort *m_AdalightDevice;
 
     QByteArray m_writeBufferHeader;
-    QByteArray m_writeBuffer;
+    SerialFrameEncoder m_encoder;
     QString m_portName;
     int m_baudRate;
 };
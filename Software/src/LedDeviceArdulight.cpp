@@ -44,6 +44,9 @@ LedDeviceArdulight::LedDeviceArdulight(const QString &portName, const int baudRa
 //    m_brightness = Settings::getDeviceBrightness();
 
     m_writeBufferHeader.append((char)255);
+    m_encoder.setHeader(m_writeBufferHeader);
+    // 255 is the start of the frame, keep it out of the colors
+    m_encoder.setMaxChannelValue(254);
 
 //    m_colorSequence = Settings::getColorSequence(SupportedDevices::DeviceTypeArdulight);
     m_ArdulightDevice = NULL;
@@ -77,59 +80,7 @@ void LedDeviceArdulight::setColors(const QList<QRgb> & colors)
 
     applyColorModifications(colors, m_colorsBuffer);
 
-    for(int i=0; i < m_colorsBuffer.count(); i++) {
-        m_colorsBuffer[i].r = m_colorsBuffer[i].r >> 4;
-        m_colorsBuffer[i].g = m_colorsBuffer[i].g >> 4;
-        m_colorsBuffer[i].b = m_colorsBuffer[i].b >> 4;
-        PrismatikMath::maxCorrection(254, m_colorsBuffer[i]);
-    }
-
-    m_writeBuffer.clear();
-    m_writeBuffer.append(m_writeBufferHeader);
-
-    for (int i = 0; i < m_colorsBuffer.count(); i++)
-    {
-        StructRgb color = m_colorsBuffer[i];
-
-        if (m_colorSequence == "RBG")
-        {
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.g);
-        }
-        else if (m_colorSequence == "BRG")
-        {
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.g);
-        }
-        else if (m_colorSequence == "BGR")
-        {
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.r);
-        }
-        else if (m_colorSequence == "GRB")
-        {
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.b);
-        }
-        else if (m_colorSequence == "GBR")
-        {
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.b);
-            m_writeBuffer.append(color.r);
-        }
-        else
-        {
-            m_writeBuffer.append(color.r);
-            m_writeBuffer.append(color.g);
-            m_writeBuffer.append(color.b);
-        }
-    }
-
-    bool ok = writeBuffer(m_writeBuffer);
+    bool ok = writeBuffer(m_encoder.encode(m_colorsBuffer));
 
     emit commandCompleted(ok);
 }
@@ -142,16 +93,7 @@ void LedDeviceArdulight::switchOffLeds()
     for (int i = 0; i < count; i++)
         m_colorsSaved << 0;
 
-    m_writeBuffer.clear();
-    m_writeBuffer.append(m_writeBufferHeader);
-
-    for (int i = 0; i < count; i++) {
-        m_writeBuffer.append((char)0)
-                     .append((char)0)
-                     .append((char)0);
-    }
-
-    bool ok = writeBuffer(m_writeBuffer);
+    bool ok = writeBuffer(m_encoder.encodeBlack(count));
 
     emit commandCompleted(ok);
 }
@@ -176,6 +118,8 @@ void LedDeviceArdulight::setColorSequence(QString value)
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
 
     m_colorSequence = value;
+    if (!m_encoder.setColorSequence(value))
+        qWarning() << Q_FUNC_INFO << "unknown color sequence" << value << ", RGB is used";
     setColors(m_colorsSaved);
 }
 
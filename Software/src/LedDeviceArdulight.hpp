@@ -28,6 +28,7 @@
 
 #include "AbstractLedDevice.hpp"
 #include "colorspace_types.h"
+#include "SerialFrameEncoder.hpp"
 #include <QtSerialPort/QSerialPort>
 
 class LedDeviceArdulight : public AbstractLedDevice
@@ -60,7 +61,7 @@ private:
     QSerialPort *m_ArdulightDevice;
 
     QByteArray m_writeBufferHeader;
-    QByteArray m_writeBuffer;
+    SerialFrameEncoder m_encoder;
 
     QString m_portName;
     int m_baudRate;
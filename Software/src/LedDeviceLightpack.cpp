@@ -28,6 +28,7 @@
 
 #include <algorithm>
 #include <QtDebug>
+#include <QtEndian>
 #include "debug.h"
 #include "Settings.hpp"
 #include <QApplication>
@@ -36,9 +37,27 @@ using namespace SettingsScope;
 
 const int LedDeviceLightpack::kPingDeviceInterval = 1000;
 const int LedDeviceLightpack::kLedsPerDevice = 10;
+const int LedDeviceLightpack::kSizeOfLedColor = 6;
+const int LedDeviceLightpack::kFirstCompactCommandsFirmwareMinor = 7;
+const int LedDeviceLightpack::kFirstTelemetryFirmwareMinor = 7;
+const int LedDeviceLightpack::kTelemetryInterval = 1000;
+const int LedDeviceLightpack::kFirstFrameSequenceFirmwareMinor = 7;
+const int LedDeviceLightpack::kFramesInFlightInterval = 2;
+const int LedDeviceLightpack::kFirstEffectsFirmwareMajor = 6;
+const int LedDeviceLightpack::kFirstEffectsFirmwareMinor = 7;
+const int LedDeviceLightpack::kFirstColorCorrectionFirmwareMajor = 6;
+const int LedDeviceLightpack::kFirstColorCorrectionFirmwareMinor = 7;
+const int LedDeviceLightpack::kColorCorrectionDelay = 1000;
+const int LedDeviceLightpack::kLedRemap[] = {4, 3, 0, 1, 2, 5, 6, 7, 8, 9};
 
 LedDeviceLightpack::LedDeviceLightpack(QObject *parent) :
-    AbstractLedDevice(parent)
+    AbstractLedDevice(parent),
+    m_isEffectsSupported(false),
+    m_isColorCorrectionSupported(false),
+    m_isColorCorrectionEnabled(false),
+    m_sentColorCorrectionBrightness(-1),
+    m_frameSequence(0),
+    m_isFrameSequenceSupported(false)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO;
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << "thread id: " << this->thread()->currentThreadId();
@@ -48,12 +67,34 @@ LedDeviceLightpack::LedDeviceLightpack(QObject *parent) :
     memset(m_writeBuffer, 0, sizeof(m_writeBuffer));
     memset(m_readBuffer, 0, sizeof(m_readBuffer));
 
+    m_writer = new LightpackReportWriter();
+    m_writerThread = new QThread();
+
+    connect(m_writer, SIGNAL(ioDeviceSuccess(bool)), this, SIGNAL(ioDeviceSuccess(bool)), Qt::QueuedConnection);
+    connect(m_writer, SIGNAL(reconnected()), this, SLOT(onDevicesReconnected()), Qt::QueuedConnection);
+
+    m_writer->moveToThread(m_writerThread);
+    m_writerThread->start();
+
     m_timerPingDevice = new QTimer(this);
 
     connect(m_timerPingDevice, SIGNAL(timeout()), this, SLOT(timerPingDeviceTimeout()));
     connect(this, SIGNAL(ioDeviceSuccess(bool)), this, SLOT(restartPingDevice(bool)));
     connect(this, SIGNAL(openDeviceSuccess(bool)), this, SLOT(restartPingDevice(bool)));
 
+    m_timerTelemetry = new QTimer(this);
+    connect(m_timerTelemetry, SIGNAL(timeout()), this, SLOT(timerTelemetryTimeout()));
+
+    // Input reports come every 5 ms, the frame shown is checked more often until devices catch up
+    m_timerFramesInFlight = new QTimer(this);
+    m_timerFramesInFlight->setTimerType(Qt::PreciseTimer);
+    connect(m_timerFramesInFlight, SIGNAL(timeout()), this, SLOT(updateFramesInFlight()));
+
+    // Tables go to the EEPROM of the device, so they are sent once the settings stop changing
+    m_timerColorCorrection = new QTimer(this);
+    m_timerColorCorrection->setSingleShot(true);
+    connect(m_timerColorCorrection, SIGNAL(timeout()), this, SLOT(timerColorCorrectionTimeout()));
+
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << "initialized";
 }
 
@@ -61,6 +102,11 @@ LedDeviceLightpack::~LedDeviceLightpack()
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << "hid_close(...);";
     closeDevices();
+
+    m_writerThread->quit();
+    m_writerThread->wait();
+    delete m_writer;
+    delete m_writerThread;
 }
 
 void LedDeviceLightpack::setColors(const QList<QRgb> & colors)
@@ -82,18 +128,35 @@ void LedDeviceLightpack::setColors(const QList<QRgb> & colors)
 
     // Save colors for showing changes of the brightness
     m_colorsSaved = colors;
-
-    applyColorModifications(colors, m_colorsBuffer);
+    m_isEffectSaved = false;
+
+    if (m_isColorCorrectionEnabled) {
+        // Devices apply gamma, white balance and brightness themselves
+        for (int i = 0; i < m_colorsBuffer.count(); i++) {
+            m_colorsBuffer[i].r = (qRed(colors[i]) << 4) | (qRed(colors[i]) >> 4);
+            m_colorsBuffer[i].g = (qGreen(colors[i]) << 4) | (qGreen(colors[i]) >> 4);
+            m_colorsBuffer[i].b = (qBlue(colors[i]) << 4) | (qBlue(colors[i]) >> 4);
+        }
+    } else {
+        applyColorModifications(colors, m_colorsBuffer);
+    }
 
     // First write_buffer[0] == 0x00 - ReportID, i have problems with using it
     // Second byte of usb buffer is command (write_buffer[1] == CMD_UPDATE_LEDS, see below)
     int buffIndex = WRITE_BUFFER_INDEX_DATA_START;
 
     bool ok = true;
-    const int kLedRemap[] = {4, 3, 0, 1, 2, 5, 6, 7, 8, 9};
-    const size_t kSizeOfLedColor = 6;
 
-    memset(m_writeBuffer, 0, sizeof(m_writeBuffer));
+    // Reports of all units are prepared in one buffer and queued at once, units are
+    // written concurrently and the frame is completed when the last one is done
+    const int unitsCount = (m_colorsBuffer.count() + kLedsPerDevice - 1) / kLedsPerDevice;
+    m_frameBuffer.fill(0, unitsCount * LightpackReportWriter::kReportSize);
+    m_changedUnits.clear();
+
+    // Goes after the colors, devices without the sequence ignore it
+    const quint16 sequence = m_frameSequence + 1;
+
+    unsigned char *report = reinterpret_cast<unsigned char *>(m_frameBuffer.data());
     for (int i = 0; i < m_colorsBuffer.count(); i++)
     {
         StructRgb color = m_colorsBuffer[i];
@@ -101,37 +164,55 @@ void LedDeviceLightpack::setColors(const QList<QRgb> & colors)
         buffIndex = WRITE_BUFFER_INDEX_DATA_START + kLedRemap[i % 10] * kSizeOfLedColor;
 
         // Send main 8 bits for compability with existing devices
-        m_writeBuffer[buffIndex++] = (color.r & 0x0FF0) >> 4;
-        m_writeBuffer[buffIndex++] = (color.g & 0x0FF0) >> 4;
-        m_writeBuffer[buffIndex++] = (color.b & 0x0FF0) >> 4;
+        report[buffIndex++] = (color.r & 0x0FF0) >> 4;
+        report[buffIndex++] = (color.g & 0x0FF0) >> 4;
+        report[buffIndex++] = (color.b & 0x0FF0) >> 4;
 
         // Send over 4 bits for devices revision >= 6
         // All existing devices ignore it
-        m_writeBuffer[buffIndex++] = (color.r & 0x000F);
-        m_writeBuffer[buffIndex++] = (color.g & 0x000F);
-        m_writeBuffer[buffIndex++] = (color.b & 0x000F);
+        report[buffIndex++] = (color.r & 0x000F);
+        report[buffIndex++] = (color.g & 0x000F);
+        report[buffIndex++] = (color.b & 0x000F);
 
         if ((i+1) % kLedsPerDevice == 0 || i == m_colorsBuffer.size() - 1) {
-            if (!writeBufferToDeviceWithCheck(CMD_UPDATE_LEDS, m_devices[(i+kLedsPerDevice)/kLedsPerDevice - 1])) {
-                ok = false;
-            }
-            memset(m_writeBuffer, 0, sizeof(m_writeBuffer));
-            buffIndex = WRITE_BUFFER_INDEX_DATA_START;
+            const int unit = i / kLedsPerDevice;
+
+            // Device keeps showing the last colors, so the report is sent only if some of its LEDs changed
+            if (isUnitReportChanged(unit, report))
+                m_changedUnits.append(unit);
+
+            qToLittleEndian<quint16>(sequence, report + 1 + INDEX_UPDATE_LEDS_SEQUENCE);
+            report += LightpackReportWriter::kReportSize;
+        }
+    }
+
+    const unsigned char *reports = reinterpret_cast<const unsigned char *>(m_frameBuffer.constData());
+
+    if (m_writer->devicesCount() == 0) {
+        m_writer->scheduleReconnect();
+        ok = false;
+    } else if (m_writer->enqueueUnits(CMD_UPDATE_LEDS, reports, m_changedUnits)) {
+        for (int i = 0; i < m_changedUnits.size(); i++)
+            saveUnitReport(m_changedUnits[i], reports + m_changedUnits[i] * LightpackReportWriter::kReportSize);
+
+        if (!m_changedUnits.isEmpty()) {
+            m_frameSequence = sequence;
+            updateFramesInFlight();
         }
+    } else {
+        ok = false;
     }
 
 //    locker.unlock();
 
 
-    // WARNING: LedDeviceManager sends data only when the arrival of this signal
+    // Reports are only queued here, write errors come with ioDeviceSuccess() from the writer thread
     emit commandCompleted(ok);
 }
 
 size_t LedDeviceLightpack::maxLedsCount()
 {
-    if (m_devices.size() == 0)
-        tryToReopenDevice();
-    return m_devices.size() * kLedsPerDevice;
+    return m_writer->devicesCount() * kLedsPerDevice;
 }
 void LedDeviceLightpack::switchOffLeds()
 {
@@ -146,21 +227,74 @@ void LedDeviceLightpack::switchOffLeds()
             m_colorsSaved[i] = 0;
     }
 
+    m_isEffectSaved = false;
     m_timerPingDevice->stop();
+    m_sentUnitReports.clear();
 
     memset(m_writeBuffer, 0, sizeof(m_writeBuffer));
 
     bool ok = true;
-    for(int i = 0; i < m_devices.size(); i++) {
-        if (!writeBufferToDeviceWithCheck(CMD_UPDATE_LEDS, m_devices[i]))
-            ok = false;
-    }
+    if (!writeBufferToDevice(CMD_UPDATE_LEDS))
+        ok = false;
 
 
     emit commandCompleted(ok);
     // Stop ping device if switchOffLeds() signal comes
 }
 
+void LedDeviceLightpack::setEffect(const LedEffect &effect)
+{
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << effect.keyframes.count() << effect.durationMs();
+
+    if (!m_isEffectsSupported) {
+        AbstractLedDevice::setEffect(effect);
+        return;
+    }
+
+    const int keyframesCount = qMin<int>(effect.keyframes.count(), EFFECT_KEYFRAMES_MAX);
+    if (effect.keyframes.count() > keyframesCount)
+        qWarning() << Q_FUNC_INFO << "device holds" << keyframesCount << "keyframes, the rest are dropped";
+
+    // Save effect for showing changes of the brightness
+    m_effectSaved = effect;
+    m_isEffectSaved = true;
+
+    memset(m_writeBuffer, 0, sizeof(m_writeBuffer));
+
+    int buffIndex = WRITE_BUFFER_INDEX_DATA_START;
+    m_writeBuffer[buffIndex++] = (effect.isLoop ? EFFECT_LOOP : 0) | (effect.isShuffle ? EFFECT_SHUFFLE : 0);
+    m_writeBuffer[buffIndex++] = keyframesCount;
+
+    QList<QRgb> keyframeColor;
+    QList<StructRgb> modifiedColor;
+    keyframeColor << 0;
+    modifiedColor << StructRgb();
+
+    for (int i = 0; i < keyframesCount; i++) {
+        const LedEffect::Keyframe &keyframe = effect.keyframes[i];
+        const int durationMs = qBound(0, keyframe.durationMs, 0xffff);
+
+        // All LEDs show the keyframe color, white balance of the first one is applied
+        keyframeColor[0] = keyframe.color;
+        applyColorModifications(keyframeColor, modifiedColor);
+
+        m_writeBuffer[buffIndex++] = modifiedColor[0].r >> 4;
+        m_writeBuffer[buffIndex++] = modifiedColor[0].g >> 4;
+        m_writeBuffer[buffIndex++] = modifiedColor[0].b >> 4;
+        m_writeBuffer[buffIndex++] = keyframe.easing;
+        m_writeBuffer[buffIndex++] = durationMs & 0xff;
+        m_writeBuffer[buffIndex++] = durationMs >> 8;
+    }
+
+    // Device colors are changed by the effect, the next colors are sent anyway
+    m_sentUnitReports.clear();
+
+    bool ok = true;
+    if (!writeBufferToDevice(CMD_SET_EFFECT))
+        ok = false;
+    emit commandCompleted(ok);
+}
+
 void LedDeviceLightpack::setRefreshDelay(int value)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
@@ -169,10 +303,8 @@ void LedDeviceLightpack::setRefreshDelay(int value)
     m_writeBuffer[WRITE_BUFFER_INDEX_DATA_START+1] = (value >> 8);
 
     bool ok = true;
-    for(int i = 0; i < m_devices.size(); i++) {
-        if (!writeBufferToDeviceWithCheck(CMD_SET_TIMER_OPTIONS, m_devices[i]))
-            ok = false;
-    }
+    if (!writeBufferToDevice(CMD_SET_TIMER_OPTIONS))
+        ok = false;
     emit commandCompleted(ok);
 }
 
@@ -183,10 +315,8 @@ void LedDeviceLightpack::setColorDepth(int value)
     m_writeBuffer[WRITE_BUFFER_INDEX_DATA_START] = (unsigned char)value;
 
     bool ok = true;
-    for(int i = 0; i < m_devices.size(); i++) {
-        if (!writeBufferToDeviceWithCheck(CMD_SET_PWM_LEVEL_MAX_VALUE, m_devices[i]))
-            ok = false;
-    }
+    if (!writeBufferToDevice(CMD_SET_PWM_LEVEL_MAX_VALUE))
+        ok = false;
     emit commandCompleted(ok);
 }
 
@@ -197,10 +327,8 @@ void LedDeviceLightpack::setSmoothSlowdown(int value)
     m_writeBuffer[WRITE_BUFFER_INDEX_DATA_START] = (unsigned char)value;
 
     bool ok = true;
-    for(int i = 0; i < m_devices.size(); i++) {
-        if (!writeBufferToDeviceWithCheck(CMD_SET_SMOOTH_SLOWDOWN, m_devices[i]))
-            ok = false;
-    }
+    if (!writeBufferToDevice(CMD_SET_SMOOTH_SLOWDOWN))
+        ok = false;
     emit commandCompleted(ok);
 }
 
@@ -215,7 +343,7 @@ void LedDeviceLightpack::requestFirmwareVersion()
 
     QString fwVersion;
 
-    bool ok = readDataFromDeviceWithCheck();
+    bool ok = readDataFromDevice();
 
     // TODO: write command CMD_GET_VERSION to device
     if (ok)
@@ -227,6 +355,37 @@ void LedDeviceLightpack::requestFirmwareVersion()
         fwVersion = tr("read device fail");
     }
 
+    // Version of the first unit is trusted for the whole chain
+    const bool isCompactCommands = ok && m_readBuffer[INDEX_FW_VER_MINOR] >= kFirstCompactCommandsFirmwareMinor;
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Compact color commands:" << isCompactCommands;
+    m_writer->setCompactCommands(isCompactCommands);
+
+    if (ok && m_readBuffer[INDEX_FW_VER_MINOR] >= kFirstTelemetryFirmwareMinor)
+        m_timerTelemetry->start(kTelemetryInterval);
+    else
+        m_timerTelemetry->stop();
+
+    m_isFrameSequenceSupported = ok && m_readBuffer[INDEX_FW_VER_MINOR] >= kFirstFrameSequenceFirmwareMinor;
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Frame sequence:" << m_isFrameSequenceSupported;
+    if (!m_isFrameSequenceSupported) {
+        m_timerFramesInFlight->stop();
+        emit framesInFlight(0);
+    }
+
+    m_isEffectsSupported = ok && m_readBuffer[INDEX_FW_VER_MAJOR] >= kFirstEffectsFirmwareMajor
+            && m_readBuffer[INDEX_FW_VER_MINOR] >= kFirstEffectsFirmwareMinor;
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Effects:" << m_isEffectsSupported;
+    emit effectsSupported(m_isEffectsSupported);
+
+    m_isColorCorrectionSupported = ok && m_readBuffer[INDEX_FW_VER_MAJOR] >= kFirstColorCorrectionFirmwareMajor
+            && m_readBuffer[INDEX_FW_VER_MINOR] >= kFirstColorCorrectionFirmwareMinor;
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Color correction:" << m_isColorCorrectionSupported;
+    if (m_isColorCorrectionSupported && !m_isColorCorrectionEnabled) {
+        // Devices may still apply tables of another session until they get ours
+        disableColorCorrection();
+        m_timerColorCorrection->start(kColorCorrectionDelay);
+    }
+
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Version:" << fwVersion;
 
     emit firmwareVersion(fwVersion);
@@ -250,20 +409,13 @@ void LedDeviceLightpack::open()
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO;
 
-    if (m_devices.size() > 0)
+    if (m_writer->devicesCount() > 0)
     {
         emit openDeviceSuccess(true);
         return;
     }
 
-    DEBUG_LOW_LEVEL << Q_FUNC_INFO << QString("hid_open(0x%1, 0x%2)")
-                       .arg(USB_VENDOR_ID, 4, 16, QChar('0'))
-                       .arg(USB_PRODUCT_ID, 4, 16, QChar('0'));
-
-    open(USB_VENDOR_ID, USB_PRODUCT_ID);
-    open(USB_OLD_VENDOR_ID, USB_OLD_PRODUCT_ID);
-
-    if (m_devices.size() == 0)
+    if (m_writer->openDevices() == 0)
     {
         DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Lightpack devices not found";
         emit openDeviceSuccess(false);
@@ -277,45 +429,6 @@ void LedDeviceLightpack::open()
     emit openDeviceSuccess(true);
 }
 
-void LedDeviceLightpack::open(unsigned short vid, unsigned short pid)
-{
-    struct hid_device_info *devs, *cur_dev;
-    const char *path_to_open = NULL;
-    hid_device * handle = NULL;
-    QMap<QString, hid_device*> map;
-    QList<hid_device*> list;
-
-    devs = hid_enumerate(vid, pid);
-    cur_dev = devs;
-    while (cur_dev) {
-        path_to_open = cur_dev->path;
-        if (path_to_open) {
-            /* Open the device */
-            handle = hid_open_path(path_to_open);
-
-            if(handle != NULL) {
-
-                // Immediately return from hid_read() if no data available
-                hid_set_nonblocking(handle, 1);
-                if(cur_dev->serial_number != NULL && wcslen(cur_dev->serial_number) > 0) {
-                    QString serialNum = QString::fromWCharArray(cur_dev->serial_number);
-                    DEBUG_LOW_LEVEL << "found Lightpack, serial number: " << serialNum;
-                    map.insert(serialNum, handle);
-                } else {
-                    DEBUG_LOW_LEVEL << "found Lightpack, without serial number";
-                    list.append(handle);
-                }
-            } else {
-                qCritical() << Q_FUNC_INFO << "couldn't open dev by path";
-            }
-        }
-        cur_dev = cur_dev->next;
-    }
-    hid_free_enumeration(devs);
-    m_devices.append(map.values());
-    m_devices.append(list);
-}
-
 void LedDeviceLightpack::close() {
     closeDevices();
 }
@@ -324,10 +437,9 @@ bool LedDeviceLightpack::readDataFromDevice()
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO;
 
-    int bytes_read = hid_read(m_devices[0], m_readBuffer, sizeof(m_readBuffer));
-
-    if(bytes_read < 0){
-        qWarning() << "Error reading data:" << bytes_read;
+    if (!m_writer->readReport(m_readBuffer, sizeof(m_readBuffer))) {
+        // Never block here on USB enumeration, reopen devices in the writer thread
+        m_writer->scheduleReconnect();
         emit ioDeviceSuccess(false);
         return false;
     }
@@ -335,122 +447,218 @@ bool LedDeviceLightpack::readDataFromDevice()
     return true;
 }
 
-bool LedDeviceLightpack::writeBufferToDevice(int command, hid_device *phid_device)
-{    
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << command;
-#if 0
-    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "thread id: " << this->thread()->currentThreadId();
-#endif
+bool LedDeviceLightpack::writeBufferToDevice(int command, int unit)
+{
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << command << unit;
+
+    if (m_writer->devicesCount() == 0) {
+        m_writer->scheduleReconnect();
+        return false;
+    }
+
+    return m_writer->enqueue(command, unit, m_writeBuffer);
+}
+
+void LedDeviceLightpack::resizeColorsBuffer(int buffSize)
+{
+    if (m_colorsBuffer.count() == buffSize || buffSize < 0)
+        return;
 
-    m_writeBuffer[WRITE_BUFFER_INDEX_REPORT_ID] = 0x00;
-    m_writeBuffer[WRITE_BUFFER_INDEX_COMMAND] = command;
+    m_colorsBuffer.clear();
 
-    int error = hid_write(phid_device, m_writeBuffer, sizeof(m_writeBuffer));
-    if (error < 0)
+    size_t checkedBufferSize = buffSize;
+    if (checkedBufferSize > maxLedsCount())
     {
-        // Trying to repeat sending data:
-        error = hid_write(phid_device, m_writeBuffer, sizeof(m_writeBuffer));
-        if(error < 0){
-            qWarning() << "Error writing data:" << error;
-            emit ioDeviceSuccess(false);
-            return false;
-        }
+        qCritical() << Q_FUNC_INFO << "buffSize > MaximumLedsCount" << checkedBufferSize << ">" << maxLedsCount();
+
+        checkedBufferSize = maxLedsCount();
     }
-    emit ioDeviceSuccess(true);
-    return true;
+
+    std::fill_n(std::back_inserter(m_colorsBuffer), checkedBufferSize, StructRgb());
 }
 
-bool LedDeviceLightpack::tryToReopenDevice()
+void LedDeviceLightpack::closeDevices()
 {
-    closeDevices();
-//    QThread::sleep(100);
-    open();
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
 
-    if (m_devices.size() == 0)
-    {
+    m_timerPingDevice->stop();
+    m_timerPingDevice->blockSignals(true);
+    m_timerTelemetry->stop();
+    m_timerFramesInFlight->stop();
+    m_isFrameSequenceSupported = false;
+    emit framesInFlight(0);
+    m_isEffectsSupported = false;
+    m_timerColorCorrection->stop();
+    m_isColorCorrectionSupported = false;
+    forgetColorCorrection();
+
+    m_writer->closeDevices();
+    m_sentUnitReports.clear();
+}
+
+bool LedDeviceLightpack::isUnitReportChanged(int unit, const unsigned char *report) const
+{
+    const int kUnitReportSize = kLedsPerDevice * kSizeOfLedColor;
+
+    if (unit >= m_sentUnitReports.size() || m_sentUnitReports[unit].size() != kUnitReportSize)
+        return true;
+
+    return memcmp(m_sentUnitReports[unit].constData(), report + WRITE_BUFFER_INDEX_DATA_START, kUnitReportSize) != 0;
+}
+
+void LedDeviceLightpack::saveUnitReport(int unit, const unsigned char *report)
+{
+    const int kUnitReportSize = kLedsPerDevice * kSizeOfLedColor;
+
+    if (unit >= m_sentUnitReports.size())
+        m_sentUnitReports.resize(unit + 1);
+
+    QByteArray &sentReport = m_sentUnitReports[unit];
+    sentReport.resize(kUnitReportSize);
+    memcpy(sentReport.data(), report + WRITE_BUFFER_INDEX_DATA_START, kUnitReportSize);
+}
+
+bool LedDeviceLightpack::writeColorCorrection(int item, const QByteArray &data, int unit)
+{
+    memset(m_writeBuffer, 0, sizeof(m_writeBuffer));
+    m_writeBuffer[WRITE_BUFFER_INDEX_DATA_START] = item;
+    memcpy(m_writeBuffer + WRITE_BUFFER_INDEX_DATA_START + 1, data.constData(), data.size());
+    return writeBufferToDevice(CMD_SET_COLOR_CORRECTION, unit);
+}
+
+bool LedDeviceLightpack::writeColorCorrectionBrightness()
+{
+    // Kept in RAM of the devices, so it is sent right away on every change
+    const int brightness = qBound(0, qRound(m_brightness * COLOR_CORRECTION_BRIGHTNESS_MAX / 100.0), (int)COLOR_CORRECTION_BRIGHTNESS_MAX);
+    if (brightness == m_sentColorCorrectionBrightness)
+        return true;
+
+    QByteArray data(2, 0);
+    data[0] = brightness & 0xff;
+    data[1] = brightness >> 8;
+    if (!writeColorCorrection(COLOR_CORRECTION_BRIGHTNESS, data)) {
+        m_sentColorCorrectionBrightness = -1;
         return false;
     }
 
-    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Reopen success";
+    m_sentColorCorrectionBrightness = brightness;
     return true;
 }
 
-bool LedDeviceLightpack::readDataFromDeviceWithCheck()
+QByteArray LedDeviceLightpack::gammaTable() const
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO;
-
-    if (m_devices.size() > 0)
-    {
-        if (!readDataFromDevice())
-        {
-            if (tryToReopenDevice())
-                return readDataFromDevice();
-            else
-                return false;
-        }
-        return true;
-    } else {
-        if (tryToReopenDevice())
-            return readDataFromDevice();
-        else
-            return false;
+    // Devices apply brightness after the table, so the table depends on gamma only
+    QByteArray table(COLOR_CORRECTION_GAMMA_POINTS * 2, 0);
+    for (int k = 0; k < COLOR_CORRECTION_GAMMA_POINTS; k++) {
+        const double x = qMin(k * 256, 4095) / 4095.0;
+        const int point = qBound(0, qRound(4095 * pow(x, m_gamma)), 4095);
+        table[k * 2] = point & 0xff;
+        table[k * 2 + 1] = point >> 8;
     }
+    return table;
 }
 
-bool LedDeviceLightpack::writeBufferToDeviceWithCheck(int command, hid_device *phid_device)
+QByteArray LedDeviceLightpack::whiteBalanceTable(int unit) const
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO;
+    // R G B of every LED at its device position, 255 is 1.0
+    QByteArray table(kLedsPerDevice * 3, (char)0xff);
+    for (int i = 0; i < kLedsPerDevice; i++) {
+        const int led = unit * kLedsPerDevice + i;
+        if (led >= m_wbAdjustments.count())
+            break;
+
+        const WBAdjustment &wb = m_wbAdjustments[led];
+        table[kLedRemap[i] * 3] = qBound(0, qRound(wb.red * 256) - 1, 255);
+        table[kLedRemap[i] * 3 + 1] = qBound(0, qRound(wb.green * 256) - 1, 255);
+        table[kLedRemap[i] * 3 + 2] = qBound(0, qRound(wb.blue * 256) - 1, 255);
+    }
+    return table;
+}
 
-    if (phid_device != NULL)
-    {
-        if (!writeBufferToDevice(command, phid_device))
-        {
-            if (!writeBufferToDevice(command, phid_device))
-            {
-                if (tryToReopenDevice())
-                    return writeBufferToDevice(command, phid_device);
-                else
-                    return false;
-            }
-        }
+bool LedDeviceLightpack::isColorCorrectionTablesChanged() const
+{
+    if (gammaTable() != m_sentGammaTable)
         return true;
-    } else {
-        if (tryToReopenDevice())
-            return writeBufferToDevice(command, phid_device);
-        else
-            return false;
-    }
+
+    const int unitsCount = m_writer->devicesCount();
+    for (int unit = 0; unit < unitsCount; unit++)
+        if (unit >= m_sentWhiteBalance.size() || whiteBalanceTable(unit) != m_sentWhiteBalance[unit])
+            return true;
+
+    return false;
 }
 
-void LedDeviceLightpack::resizeColorsBuffer(int buffSize)
+void LedDeviceLightpack::uploadColorCorrection()
 {
-    if (m_colorsBuffer.count() == buffSize || buffSize < 0)
-        return;
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << m_gamma << m_brightness;
 
-    m_colorsBuffer.clear();
+    bool ok = true;
 
-    size_t checkedBufferSize = buffSize;
-    if (checkedBufferSize > maxLedsCount())
-    {
-        qCritical() << Q_FUNC_INFO << "buffSize > MaximumLedsCount" << checkedBufferSize << ">" << maxLedsCount();
+    // Tables are written to EEPROM, only the changed ones are sent
+    const QByteArray gamma = gammaTable();
+    if (gamma != m_sentGammaTable) {
+        for (int item = COLOR_CORRECTION_GAMMA_RED; item <= COLOR_CORRECTION_GAMMA_BLUE; item++)
+            ok = writeColorCorrection(item, gamma) && ok;
+        m_sentGammaTable = ok ? gamma : QByteArray();
+    }
 
-        checkedBufferSize = maxLedsCount();
+    const int unitsCount = m_writer->devicesCount();
+    m_sentWhiteBalance.resize(unitsCount);
+    for (int unit = 0; unit < unitsCount; unit++) {
+        const QByteArray whiteBalance = whiteBalanceTable(unit);
+        if (whiteBalance == m_sentWhiteBalance[unit])
+            continue;
+
+        if (writeColorCorrection(COLOR_CORRECTION_WHITE_BALANCE, whiteBalance, unit)) {
+            m_sentWhiteBalance[unit] = whiteBalance;
+        } else {
+            m_sentWhiteBalance[unit].clear();
+            ok = false;
+        }
     }
 
-    std::fill_n(std::back_inserter(m_colorsBuffer), checkedBufferSize, StructRgb());
+    if (!ok || !writeColorCorrectionBrightness() || !writeColorCorrection(COLOR_CORRECTION_ON)) {
+        qWarning() << Q_FUNC_INFO << "color correction is not sent, colors are corrected on the host";
+        return;
+    }
+
+    m_isColorCorrectionEnabled = true;
+    m_sentUnitReports.clear();
+    resendColors();
 }
 
-void LedDeviceLightpack::closeDevices()
+void LedDeviceLightpack::disableColorCorrection()
 {
-    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    writeColorCorrection(COLOR_CORRECTION_OFF);
+    m_isColorCorrectionEnabled = false;
+    m_sentUnitReports.clear();
+}
 
-    m_timerPingDevice->stop();
-    m_timerPingDevice->blockSignals(true);
+void LedDeviceLightpack::forgetColorCorrection()
+{
+    m_isColorCorrectionEnabled = false;
+    m_sentGammaTable.clear();
+    m_sentWhiteBalance.clear();
+    m_sentColorCorrectionBrightness = -1;
+}
 
-    for(int i=0; i < m_devices.size(); i++) {
-        hid_close(m_devices[i]);
+void LedDeviceLightpack::colorModificationsChanged()
+{
+    if (!m_isColorCorrectionSupported)
+        return;
+
+    // Colors are corrected on the host until the devices get the new tables,
+    // minimum luminosity stays on the host for good
+    if (m_isColorCorrectionEnabled && (m_luminosityThreshold > 0 || isColorCorrectionTablesChanged()))
+        disableColorCorrection();
+
+    if (m_isColorCorrectionEnabled) {
+        if (writeColorCorrectionBrightness())
+            return;
+        disableColorCorrection();
     }
-    m_devices.clear();
+
+    m_timerColorCorrection->start(kColorCorrectionDelay);
 }
 
 void LedDeviceLightpack::restartPingDevice(bool isSuccess)
@@ -469,38 +677,65 @@ void LedDeviceLightpack::restartPingDevice(bool isSuccess)
 void LedDeviceLightpack::timerPingDeviceTimeout()
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO;
-    if (m_devices.size() == 0)
+    if (m_writer->devicesCount() == 0)
     {
-        DEBUG_MID_LEVEL << Q_FUNC_INFO << "open devices";
-        open();
+        DEBUG_MID_LEVEL << Q_FUNC_INFO << "reopen devices in the background";
+        m_writer->scheduleReconnect();
+        return;
+    }
 
-        if (m_devices.size() == 0)
-        {
-            DEBUG_MID_LEVEL << Q_FUNC_INFO << "open devices fail";
-            emit openDeviceSuccess(false);
-            return;
-        }
-        DEBUG_MID_LEVEL << Q_FUNC_INFO << "open devices ok";
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << "CMD_NOP";
 
-        emit openDeviceSuccess(true);
-        closeDevices(); // device should be opened by open() function
+    memset(m_writeBuffer, 0, sizeof(m_writeBuffer));
+    writeBufferToDevice(CMD_NOP, 0);
+}
+
+void LedDeviceLightpack::timerTelemetryTimeout()
+{
+    if (m_writer->devicesCount() == 0)
+        return;
+
+    // Latency and device counters go to the writer stats
+    if (!m_writer->pollTelemetry())
+        DEBUG_MID_LEVEL << Q_FUNC_INFO << "telemetry is not read";
+}
+
+void LedDeviceLightpack::updateFramesInFlight()
+{
+    if (!m_isFrameSequenceSupported)
         return;
-    }
 
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << "hid_write";
+    const int count = m_writer->framesInFlight(m_frameSequence);
+    emit framesInFlight(count);
 
-    m_writeBuffer[WRITE_BUFFER_INDEX_REPORT_ID] = 0x00;
-    m_writeBuffer[WRITE_BUFFER_INDEX_COMMAND] = CMD_NOP;
-    int bytes = hid_write(m_devices[0], m_writeBuffer, sizeof(m_writeBuffer));
+    if (count == 0)
+        m_timerFramesInFlight->stop();
+    else if (!m_timerFramesInFlight->isActive())
+        m_timerFramesInFlight->start(kFramesInFlightInterval);
+}
 
-    if (bytes < 0)
-    {
-        DEBUG_MID_LEVEL << Q_FUNC_INFO << "hid_write fail";
-        closeDevices();
-        emit ioDeviceSuccess(false);
+void LedDeviceLightpack::timerColorCorrectionTimeout()
+{
+    if (!m_isColorCorrectionSupported || m_writer->devicesCount() == 0)
+        return;
+
+    // Minimum luminosity needs the average color of the whole frame, it stays on the host
+    if (m_luminosityThreshold > 0) {
+        DEBUG_LOW_LEVEL << Q_FUNC_INFO << "luminosity threshold is applied on the host";
         return;
     }
 
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << "hid_write ok";
-    emit ioDeviceSuccess(true);
+    uploadColorCorrection();
+}
+
+void LedDeviceLightpack::onDevicesReconnected()
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+
+    // Reopened devices have lost their state, send everything again
+    m_sentUnitReports.clear();
+    forgetColorCorrection();
+    updateDeviceSettings();
+
+    emit openDeviceSuccess(true);
 }
@@ -31,8 +31,7 @@
 #include "TimeEvaluations.hpp"
 #include "PrismatikMath.hpp"
 
-#include "../../CommonHeaders/USB_ID.h"     /* For device VID, PID, vendor name and product name */
-#include "hidapi.h" /* USB HID API */
+#include "LightpackReportWriter.hpp"
 
 #include "../../CommonHeaders/COMMANDS.h"   /* CMD defines */
 
@@ -55,6 +54,7 @@ public slots:
     virtual void close();
     virtual void setColors(const QList<QRgb> & colors);
     virtual void switchOffLeds();
+    virtual void setEffect(const LedEffect & effect);
     virtual void setRefreshDelay(int value);
     virtual void setColorDepth(int value);
     virtual void setSmoothSlowdown(int value);
@@ -63,32 +63,78 @@ public slots:
     virtual void updateDeviceSettings();
     virtual size_t maxLedsCount();
     virtual size_t defaultLedsCount() { return maxLedsCount(); }
-    size_t lightpacksFound() { return m_devices.size(); }
+    size_t lightpacksFound() { return m_writer->devicesCount(); }
 
 private: 
     bool readDataFromDevice();
-    bool writeBufferToDevice(int command, hid_device *phid_device);
-    bool tryToReopenDevice();
-    bool readDataFromDeviceWithCheck();
-    bool writeBufferToDeviceWithCheck(int command, hid_device *phid_device);
+    bool writeBufferToDevice(int command, int unit = LightpackReportWriter::kAllUnits);
     void resizeColorsBuffer(int buffSize);
     void closeDevices();
+    bool isUnitReportChanged(int unit, const unsigned char *report) const;
+    void saveUnitReport(int unit, const unsigned char *report);
+    bool writeColorCorrection(int item, const QByteArray &data = QByteArray(), int unit = LightpackReportWriter::kAllUnits);
+    bool writeColorCorrectionBrightness();
+    QByteArray gammaTable() const;
+    QByteArray whiteBalanceTable(int unit) const;
+    bool isColorCorrectionTablesChanged() const;
+    void uploadColorCorrection();
+    void disableColorCorrection();
+    void forgetColorCorrection();
+
+protected:
+    virtual void colorModificationsChanged();
 
 private slots:
     void restartPingDevice(bool isSuccess);
     void timerPingDeviceTimeout();
+    void timerTelemetryTimeout();
+    void updateFramesInFlight();
+    void timerColorCorrectionTimeout();
+    void onDevicesReconnected();
 
 private:
-    void open(unsigned short vid, unsigned short pid);
-
-    QList<hid_device*> m_devices;
-//    hid_device *m_hidDevice;
+    LightpackReportWriter *m_writer;
+    QThread *m_writerThread;
 
     unsigned char m_readBuffer[65];    /* 0-ReportID, 1..65-data */
     unsigned char m_writeBuffer[65];   /* 0-ReportID, 1..65-data */
+    // CMD_UPDATE_LEDS reports of all units one after another
+    QByteArray m_frameBuffer;
+    QVector<int> m_changedUnits;
 
     QTimer *m_timerPingDevice;
+    QTimer *m_timerTelemetry;
+    QTimer *m_timerFramesInFlight;
+    QTimer *m_timerColorCorrection;
+
+    // Colors of the last successfully written CMD_UPDATE_LEDS report of each device
+    QVector<QByteArray> m_sentUnitReports;
+    // Firmware of the first unit plays CMD_SET_EFFECT
+    bool m_isEffectsSupported;
+    // Firmware of the first unit applies CMD_SET_COLOR_CORRECTION
+    bool m_isColorCorrectionSupported;
+    // Devices hold the tables of the current settings and apply them, colors are sent raw
+    bool m_isColorCorrectionEnabled;
+    // Tables and brightness the devices got in this session, tables are resent only if they change
+    QByteArray m_sentGammaTable;
+    QVector<QByteArray> m_sentWhiteBalance;
+    int m_sentColorCorrectionBrightness;
+    // Sequence of the last frame queued, devices report the one they show
+    quint16 m_frameSequence;
+    bool m_isFrameSequenceSupported;
 
     static const int kPingDeviceInterval;
     static const int kLedsPerDevice;
+    static const int kSizeOfLedColor;
+    static const int kFirstCompactCommandsFirmwareMinor;
+    static const int kFirstTelemetryFirmwareMinor;
+    static const int kTelemetryInterval;
+    static const int kFirstFrameSequenceFirmwareMinor;
+    static const int kFramesInFlightInterval;
+    static const int kFirstEffectsFirmwareMajor;
+    static const int kFirstEffectsFirmwareMinor;
+    static const int kFirstColorCorrectionFirmwareMajor;
+    static const int kFirstColorCorrectionFirmwareMinor;
+    static const int kColorCorrectionDelay;
+    static const int kLedRemap[];
 };
@@ -0,0 +1,250 @@
+/*
+ * LedDeviceMailbox.cpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LedDeviceMailbox.hpp"
+#include "AbstractLedDevice.hpp"
+#include "debug.h"
+
+LedDeviceMailbox::LedDeviceMailbox(QObject *parent)
+    : QObject(parent)
+    , m_ledDevice(NULL)
+    , m_pendingColors(NULL)
+    , m_pendingEffect(NULL)
+    , m_pendingSettings(NULL)
+    , m_pendingCommands(0)
+    , m_isWakeupPosted(0)
+    , m_maxFramesInFlight(0)
+    , m_framesInFlight(0)
+{
+}
+
+LedDeviceMailbox::~LedDeviceMailbox()
+{
+    delete m_pendingColors.fetchAndStoreAcquire(NULL);
+    delete m_pendingEffect.fetchAndStoreAcquire(NULL);
+    delete m_pendingSettings.fetchAndStoreAcquire(NULL);
+}
+
+void LedDeviceMailbox::setLedDevice(AbstractLedDevice *ledDevice)
+{
+    m_ledDevice.storeRelease(ledDevice);
+}
+
+void LedDeviceMailbox::setMaxFramesInFlight(int count)
+{
+    m_maxFramesInFlight.fetchAndStoreOrdered(count);
+}
+
+void LedDeviceMailbox::setFramesInFlight(int count)
+{
+    const bool isThrottledBefore = isThrottled();
+    m_framesInFlight = count;
+
+    // Colors held back go out now
+    if (isThrottledBefore && !isThrottled() && m_pendingColors.loadAcquire() != NULL)
+        wakeup();
+}
+
+void LedDeviceMailbox::postColors(const QList<QRgb> &colors)
+{
+    // Colors and switching off cancel each other, the latest one wins
+    m_pendingCommands.fetchAndAndOrdered(~bit(LedDeviceCommands::OffLeds));
+
+    // Not yet taken frame is stale now
+    delete m_pendingEffect.fetchAndStoreOrdered(NULL);
+    delete m_pendingColors.fetchAndStoreOrdered(new QList<QRgb>(colors));
+    wakeup();
+}
+
+void LedDeviceMailbox::postEffect(const LedEffect &effect)
+{
+    // Effect takes the place of colors
+    m_pendingCommands.fetchAndAndOrdered(~bit(LedDeviceCommands::OffLeds));
+
+    delete m_pendingColors.fetchAndStoreOrdered(NULL);
+    delete m_pendingEffect.fetchAndStoreOrdered(new LedEffect(effect));
+    wakeup();
+}
+
+void LedDeviceMailbox::postCommand(LedDeviceCommands::Cmd cmd)
+{
+    if (cmd == LedDeviceCommands::OffLeds) {
+        delete m_pendingColors.fetchAndStoreOrdered(NULL);
+        delete m_pendingEffect.fetchAndStoreOrdered(NULL);
+    }
+
+    m_pendingCommands.fetchAndOrOrdered(bit(cmd));
+    wakeup();
+}
+
+void LedDeviceMailbox::postRefreshDelay(int value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->refreshDelay = value;
+    putSettings(snapshot, LedDeviceCommands::SetRefreshDelay);
+}
+
+void LedDeviceMailbox::postColorDepth(int value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->colorDepth = value;
+    putSettings(snapshot, LedDeviceCommands::SetColorDepth);
+}
+
+void LedDeviceMailbox::postSmoothSlowdown(int value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->smoothSlowdown = value;
+    putSettings(snapshot, LedDeviceCommands::SetSmoothSlowdown);
+}
+
+void LedDeviceMailbox::postGamma(double value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->gamma = value;
+    putSettings(snapshot, LedDeviceCommands::SetGamma);
+}
+
+void LedDeviceMailbox::postBrightness(int value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->brightness = value;
+    putSettings(snapshot, LedDeviceCommands::SetBrightness);
+}
+
+void LedDeviceMailbox::postLuminosityThreshold(int value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->luminosityThreshold = value;
+    putSettings(snapshot, LedDeviceCommands::SetLuminosityThreshold);
+}
+
+void LedDeviceMailbox::postMinimumLuminosityEnabled(bool value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->isMinimumLuminosityEnabled = value;
+    putSettings(snapshot, LedDeviceCommands::SetMinimumLuminosityEnabled);
+}
+
+void LedDeviceMailbox::postColorSequence(const QString &value)
+{
+    SettingsSnapshot *snapshot = takeSettingsForUpdate();
+    snapshot->colorSequence = value;
+    putSettings(snapshot, LedDeviceCommands::SetColorSequence);
+}
+
+LedDeviceMailbox::SettingsSnapshot * LedDeviceMailbox::takeSettingsForUpdate()
+{
+    // The consumer only ever takes the snapshot away, so after this exchange
+    // the producer owns it exclusively and can merge new values into it
+    SettingsSnapshot *snapshot = m_pendingSettings.fetchAndStoreAcquire(NULL);
+    return snapshot ? snapshot : new SettingsSnapshot();
+}
+
+void LedDeviceMailbox::putSettings(SettingsSnapshot *snapshot, LedDeviceCommands::Cmd cmd)
+{
+    snapshot->changed |= bit(cmd);
+    SettingsSnapshot *previous = m_pendingSettings.fetchAndStoreRelease(snapshot);
+    Q_ASSERT(previous == NULL);
+    Q_UNUSED(previous);
+    wakeup();
+}
+
+void LedDeviceMailbox::wakeup()
+{
+    if (m_isWakeupPosted.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+}
+
+bool LedDeviceMailbox::isThrottled() const
+{
+    const int maxFramesInFlight = m_maxFramesInFlight.loadAcquire();
+    return maxFramesInFlight > 0 && m_framesInFlight >= maxFramesInFlight;
+}
+
+void LedDeviceMailbox::process()
+{
+    // Everything posted after this line will schedule one more wakeup
+    m_isWakeupPosted.fetchAndStoreOrdered(0);
+
+    // Held back colors stay pending until the device catches up, setFramesInFlight() wakes up then
+    QList<QRgb> *colors = isThrottled() ? NULL : m_pendingColors.fetchAndStoreAcquire(NULL);
+    LedEffect *effect = m_pendingEffect.fetchAndStoreAcquire(NULL);
+    // Commands are taken after colors and effect: OffLeds posted after them wins below,
+    // while colors posted after them clear OffLeds and wait for the next wakeup
+    const int commands = m_pendingCommands.fetchAndStoreAcquire(0);
+    SettingsSnapshot *settings = m_pendingSettings.fetchAndStoreAcquire(NULL);
+
+    AbstractLedDevice *ledDevice = m_ledDevice.loadAcquire();
+
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << "commands:" << commands
+                    << "settings:" << (settings ? settings->changed : 0)
+                    << "colors:" << (colors != NULL) << "effect:" << (effect != NULL);
+
+    if (ledDevice == NULL) {
+        qWarning() << Q_FUNC_INFO << "there is no device to process commands";
+    } else {
+        if (commands & bit(LedDeviceCommands::Open))
+            ledDevice->open();
+
+        if (settings) {
+            const int changed = settings->changed;
+            if (changed & bit(LedDeviceCommands::SetRefreshDelay))
+                ledDevice->setRefreshDelay(settings->refreshDelay);
+            if (changed & bit(LedDeviceCommands::SetColorDepth))
+                ledDevice->setColorDepth(settings->colorDepth);
+            if (changed & bit(LedDeviceCommands::SetSmoothSlowdown))
+                ledDevice->setSmoothSlowdown(settings->smoothSlowdown);
+            if (changed & bit(LedDeviceCommands::SetGamma))
+                ledDevice->setGamma(settings->gamma);
+            if (changed & bit(LedDeviceCommands::SetBrightness))
+                ledDevice->setBrightness(settings->brightness);
+            if (changed & bit(LedDeviceCommands::SetLuminosityThreshold))
+                ledDevice->setLuminosityThreshold(settings->luminosityThreshold);
+            if (changed & bit(LedDeviceCommands::SetMinimumLuminosityEnabled))
+                ledDevice->setMinimumLuminosityThresholdEnabled(settings->isMinimumLuminosityEnabled);
+            if (changed & bit(LedDeviceCommands::SetColorSequence))
+                ledDevice->setColorSequence(settings->colorSequence);
+        }
+
+        if (commands & (bit(LedDeviceCommands::UpdateDeviceSettings) | bit(LedDeviceCommands::UpdateWBAdjustments)))
+            ledDevice->updateDeviceSettings();
+
+        if (commands & bit(LedDeviceCommands::RequestFirmwareVersion))
+            ledDevice->requestFirmwareVersion();
+
+        if (commands & bit(LedDeviceCommands::OffLeds))
+            ledDevice->switchOffLeds();
+        else if (colors)
+            ledDevice->setColors(*colors);
+        else if (effect)
+            ledDevice->setEffect(*effect);
+    }
+
+    delete settings;
+    delete colors;
+    delete effect;
+}
@@ -0,0 +1,125 @@
+/*
+ * LedDeviceMailbox.hpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QString>
+#include <QRgb>
+#include "enums.hpp"
+
+class AbstractLedDevice;
+struct LedEffect;
+
+/*!
+  Latest-wins handoff of commands from \a LedDeviceManager to a LED device
+  living in its own thread.
+
+  The manager thread only overwrites pending state: new colors replace not yet
+  sent ones or an effect, settings are merged into one snapshot. At most one wakeup is
+  queued to the device thread at a time; when it runs, the device thread takes
+  everything pending in one go and applies it, so the device is never flooded
+  with stale frames and the manager never waits for the device.
+
+  Devices which report frames not shown yet are throttled: while they have
+  \a setMaxFramesInFlight() frames in flight, colors stay pending and newer
+  ones replace them.
+
+  Exchange is done with atomics only. There must be exactly one producer
+  (the thread of \a LedDeviceManager) and one consumer (the thread this
+  object lives in).
+*/
+class LedDeviceMailbox : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LedDeviceMailbox(QObject *parent = 0);
+    virtual ~LedDeviceMailbox();
+
+    void setLedDevice(AbstractLedDevice *ledDevice);
+    //! 0 doesn't hold colors back
+    void setMaxFramesInFlight(int count);
+
+    void postColors(const QList<QRgb> &colors);
+    //! Replaces pending colors, the latest of colors and effect is sent
+    void postEffect(const LedEffect &effect);
+    /*!
+      Commands without arguments: Open, OffLeds, RequestFirmwareVersion,
+      UpdateWBAdjustments and UpdateDeviceSettings.
+    */
+    void postCommand(LedDeviceCommands::Cmd cmd);
+    void postRefreshDelay(int value);
+    void postColorDepth(int value);
+    void postSmoothSlowdown(int value);
+    void postGamma(double value);
+    void postBrightness(int value);
+    void postLuminosityThreshold(int value);
+    void postMinimumLuminosityEnabled(bool value);
+    void postColorSequence(const QString &value);
+
+public slots:
+    //! Connected to \a AbstractLedDevice::framesInFlight(), called in the device thread
+    void setFramesInFlight(int count);
+
+private slots:
+    void process();
+
+private:
+    struct SettingsSnapshot {
+        SettingsSnapshot()
+            : changed(0), refreshDelay(0), colorDepth(0), smoothSlowdown(0), gamma(0)
+            , brightness(0), luminosityThreshold(0), isMinimumLuminosityEnabled(false)
+        {}
+        int changed; // bit mask of LedDeviceCommands::Cmd
+        int refreshDelay;
+        int colorDepth;
+        int smoothSlowdown;
+        double gamma;
+        int brightness;
+        int luminosityThreshold;
+        bool isMinimumLuminosityEnabled;
+        QString colorSequence;
+    };
+
+    static inline int bit(LedDeviceCommands::Cmd cmd) { return 1 << cmd; }
+
+    SettingsSnapshot * takeSettingsForUpdate();
+    void putSettings(SettingsSnapshot *snapshot, LedDeviceCommands::Cmd cmd);
+    void wakeup();
+    bool isThrottled() const;
+
+private:
+    QAtomicPointer<AbstractLedDevice> m_ledDevice;
+    QAtomicPointer< QList<QRgb> > m_pendingColors;
+    QAtomicPointer<LedEffect> m_pendingEffect;
+    QAtomicPointer<SettingsSnapshot> m_pendingSettings;
+    QAtomicInt m_pendingCommands;
+    QAtomicInt m_isWakeupPosted;
+    QAtomicInt m_maxFramesInFlight;
+    int m_framesInFlight; // consumer thread only
+};
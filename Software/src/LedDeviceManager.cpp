@@ -27,6 +27,7 @@
 #include <qglobal.h>
 
 #include "LedDeviceManager.hpp"
+#include "LedDeviceMailbox.hpp"
 #include "LedDeviceLightpack.hpp"
 
 #ifdef Q_OS_WIN
@@ -40,43 +41,42 @@
 
 using namespace SettingsScope;
 
+// One frame is shown while the next one is on the way
+const int LedDeviceManager::kMaxFramesInFlight = 2;
+
 LedDeviceManager::LedDeviceManager(QObject *parent)
     : QObject(parent)
 {
-    m_isLastCommandCompleted = true;
-
-    m_ledDeviceThread = new QThread();
-
     m_backlightStatus = Backlight::StatusOn;
 
     m_isColorsSaved = false;
+    m_isEffectSaved = false;
 
-    m_cmdTimeoutTimer = NULL;
+    m_ledDevice = NULL;
 
-    for (int i = 0; i < SupportedDevices::DeviceTypesCount; i++)
+    for (int i = 0; i < SupportedDevices::DeviceTypesCount; i++) {
         m_ledDevices.append(NULL);
+        m_ledDeviceThreads.append(NULL);
+        m_mailboxes.append(NULL);
+    }
 }
 
 LedDeviceManager::~LedDeviceManager()
 {
-    m_ledDeviceThread->deleteLater();
     for (int i = 0; i < m_ledDevices.size(); i++) {
+        if (m_mailboxes[i]) {
+            m_mailboxes[i]->setLedDevice(NULL);
+            m_mailboxes[i]->deleteLater();
+        }
+        if (m_ledDeviceThreads[i])
+            m_ledDeviceThreads[i]->deleteLater();
         if(m_ledDevices[i])
             m_ledDevices[i]->close();
     }
-
-    if (m_cmdTimeoutTimer)
-        delete m_cmdTimeoutTimer;
 }
 
 void LedDeviceManager::init()
 {
-    if (!m_cmdTimeoutTimer)
-        m_cmdTimeoutTimer = new QTimer();
-
-    m_cmdTimeoutTimer->setInterval(100);
-    connect(m_cmdTimeoutTimer, SIGNAL(timeout()), this, SLOT(ledDeviceCommandTimedOut()));
-
     initLedDevice();
 }
 
@@ -90,266 +90,229 @@ void LedDeviceManager::recreateLedDevice(const SupportedDevices::DeviceType devi
     initLedDevice();
 }
 
+void LedDeviceManager::updateActiveDevices()
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+
+    recreateLedDevice(Settings::getConnectedDevice());
+}
+
 void LedDeviceManager::switchOnLeds()
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO;
 
     m_backlightStatus = Backlight::StatusOn;
-    if (m_isColorsSaved)
-        emit ledDeviceSetColors(m_savedColors);
+    if (m_isEffectSaved) {
+        for (int i = 0; i < m_activeDevices.size(); i++)
+            m_activeDevices[i].mailbox->postEffect(m_savedEffect);
+    } else if (m_isColorsSaved) {
+        postColors(m_savedColors);
+    }
 }
 
 void LedDeviceManager::setColors(const QList<QRgb> & colors)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << "Is last command completed:" << m_isLastCommandCompleted
-                    << " m_backlightStatus = " << m_backlightStatus;
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << " m_backlightStatus = " << m_backlightStatus;
 
     if (m_backlightStatus == Backlight::StatusOn)
     {
         m_savedColors = colors;
         m_isColorsSaved = true;
-        if (m_isLastCommandCompleted)
-        {
-            m_cmdTimeoutTimer->start();
-            m_isLastCommandCompleted = false;
-            emit ledDeviceSetColors(colors);
-        } else {
-            cmdQueueAppend(LedDeviceCommands::SetColors);
-        }
+        m_isEffectSaved = false;
+        postColors(colors);
     }
 }
 
-void LedDeviceManager::switchOffLeds()
+void LedDeviceManager::setEffect(const LedEffect & effect)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << "Is last command completed:" << m_isLastCommandCompleted;
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << " m_backlightStatus = " << m_backlightStatus;
 
-    if (m_isLastCommandCompleted)
+    if (m_backlightStatus == Backlight::StatusOn)
     {
-        m_cmdTimeoutTimer->start();
-        m_isLastCommandCompleted = false;
-        processOffLeds();
-    } else {
-        cmdQueueAppend(LedDeviceCommands::OffLeds);
+        m_savedEffect = effect;
+        m_isEffectSaved = true;
+
+        // Devices without effects show the last keyframe
+        for (int i = 0; i < m_activeDevices.size(); i++)
+            m_activeDevices[i].mailbox->postEffect(effect);
     }
 }
 
-void LedDeviceManager::processOffLeds()
+void LedDeviceManager::postColors(const QList<QRgb> & colors)
 {
-    m_backlightStatus = Backlight::StatusOff;
+    // Connected device always gets the whole frame
+    if (m_activeDevices.isEmpty() == false)
+        m_activeDevices[0].mailbox->postColors(colors);
 
-    emit ledDeviceOffLeds();
+    for (int i = 1; i < m_activeDevices.size(); i++)
+    {
+        const ActiveDevice &device = m_activeDevices[i];
+        if (device.firstLed < colors.size())
+            device.mailbox->postColors(colors.mid(device.firstLed, device.ledsCount));
+    }
 }
 
-void LedDeviceManager::setRefreshDelay(int value)
+void LedDeviceManager::switchOffLeds()
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value
-                    << "Is last command completed:" << m_isLastCommandCompleted;
+    DEBUG_MID_LEVEL << Q_FUNC_INFO;
 
-    if (m_isLastCommandCompleted)
-    {
-        m_cmdTimeoutTimer->start();
-        m_isLastCommandCompleted = false;
-        emit ledDeviceSetRefreshDelay(value);
-    } else {
-        m_savedRefreshDelay = value;
-        cmdQueueAppend(LedDeviceCommands::SetRefreshDelay);
-    }
+    m_backlightStatus = Backlight::StatusOff;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postCommand(LedDeviceCommands::OffLeds);
 }
 
-void LedDeviceManager::setColorDepth(int value)
+void LedDeviceManager::setRefreshDelay(int value)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value << "Is last command completed:" << m_isLastCommandCompleted;
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postRefreshDelay(value);
+}
 
-    if (m_isLastCommandCompleted)
-    {
-        m_cmdTimeoutTimer->start();
-        m_isLastCommandCompleted = false;
-        emit ledDeviceSetColorDepth(value);
-    } else {
-        m_savedColorDepth = value;
-        cmdQueueAppend(LedDeviceCommands::SetColorDepth);
-    }
+void LedDeviceManager::setColorDepth(int value)
+{
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postColorDepth(value);
 }
 
 void LedDeviceManager::setSmoothSlowdown(int value)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceSetSmoothSlowdown(value);
-    } else {
-        m_savedSmoothSlowdown = value;
-        cmdQueueAppend(LedDeviceCommands::SetSmoothSlowdown);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postSmoothSlowdown(value);
 }
 
 void LedDeviceManager::setGamma(double value)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceSetGamma(value);
-    } else {
-        m_savedGamma = value;
-        cmdQueueAppend(LedDeviceCommands::SetGamma);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postGamma(value);
 }
 
 void LedDeviceManager::setBrightness(int value)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceSetBrightness(value);
-    } else {
-        m_savedBrightness = value;
-        cmdQueueAppend(LedDeviceCommands::SetBrightness);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postBrightness(value);
 }
 
 void LedDeviceManager::setLuminosityThreshold(int value)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceSetLuminosityThreshold(value);
-    } else {
-        m_savedLuminosityThreshold = value;
-        cmdQueueAppend(LedDeviceCommands::SetLuminosityThreshold);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postLuminosityThreshold(value);
 }
 
 void LedDeviceManager::setMinimumLuminosityEnabled(bool value)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceSetMinimumLuminosityEnabled(value);
-    } else {
-        m_savedIsMinimumLuminosityEnabled = value;
-        cmdQueueAppend(LedDeviceCommands::SetMinimumLuminosityEnabled);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postMinimumLuminosityEnabled(value);
 }
 
 void LedDeviceManager::setColorSequence(QString value)
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << value << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceSetColorSequence(value);
-    } else {
-        m_savedColorSequence = value;
-        cmdQueueAppend(LedDeviceCommands::SetColorSequence);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << value;
+    // Color sequence is the setting of the connected device, additional ones keep their own
+    if (m_activeDevices.isEmpty() == false)
+        m_activeDevices[0].mailbox->postColorSequence(value);
 }
 
 void LedDeviceManager::requestFirmwareVersion()
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceRequestFirmwareVersion();
-    } else {
-        cmdQueueAppend(LedDeviceCommands::RequestFirmwareVersion);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO;
+    if (m_activeDevices.isEmpty() == false)
+        m_activeDevices[0].mailbox->postCommand(LedDeviceCommands::RequestFirmwareVersion);
 }
 
 void LedDeviceManager::updateDeviceSettings()
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceUpdateDeviceSettings();
-    } else {
-        cmdQueueAppend(LedDeviceCommands::UpdateDeviceSettings);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postCommand(LedDeviceCommands::UpdateDeviceSettings);
 }
 
 void LedDeviceManager::updateWBAdjustments()
 {
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << "Is last command completed:" << m_isLastCommandCompleted;
-
-    if (m_isLastCommandCompleted)
-    {
-        m_isLastCommandCompleted = false;
-        m_cmdTimeoutTimer->start();
-        emit ledDeviceUpdateWBAdjustments();
-    } else {
-        cmdQueueAppend(LedDeviceCommands::UpdateWBAdjustments);
-    }
+    DEBUG_MID_LEVEL << Q_FUNC_INFO;
+    for (int i = 0; i < m_activeDevices.size(); i++)
+        m_activeDevices[i].mailbox->postCommand(LedDeviceCommands::UpdateWBAdjustments);
 }
 
 void LedDeviceManager::ledDeviceCommandCompleted(bool ok)
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO << ok;
 
-    m_cmdTimeoutTimer->stop();
+    emit ioDeviceSuccess(ok);
+}
 
-    if (ok)
-    {
-        if (m_cmdQueue.isEmpty() == false)
-            cmdQueueProcessNext();
-        else
-            m_isLastCommandCompleted = true;
-    }
-    else
-    {
-        m_cmdQueue.clear();
-        m_isLastCommandCompleted = true;
-    }
+void LedDeviceManager::ledDeviceEffectsSupported(bool isSupported)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << isSupported << "active devices:" << m_activeDevices.size();
 
-    emit ioDeviceSuccess(ok);
+    // Additional devices would miss the frames
+    emit effectsSupported(isSupported && m_activeDevices.size() == 1);
 }
 
 void LedDeviceManager::initLedDevice()
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO;
 
-    m_isLastCommandCompleted = true;
+    QList<SupportedDevices::DeviceType> deviceTypes;
+    deviceTypes.append(Settings::getConnectedDevice());
+    deviceTypes.append(Settings::getAdditionalDevices());
 
-    SupportedDevices::DeviceType connectedDevice = Settings::getConnectedDevice();
+    // Devices which are not used anymore shouldn't keep showing the last frame
+    for (int i = 0; i < m_activeDevices.size(); i++)
+    {
+        if (deviceTypes.contains(m_activeDevices[i].type) == false)
+            m_activeDevices[i].mailbox->postCommand(LedDeviceCommands::OffLeds);
+    }
+    m_activeDevices.clear();
 
-    if (m_ledDevices[connectedDevice] == NULL)
+    for (int i = 0; i < deviceTypes.size(); i++)
     {
-        m_ledDevice = m_ledDevices[connectedDevice] = createLedDevice(connectedDevice);
+        const SupportedDevices::DeviceType deviceType = deviceTypes[i];
+
+        if (m_ledDevices[deviceType] == NULL)
+        {
+            AbstractLedDevice *ledDevice = m_ledDevices[deviceType] = createLedDevice(deviceType);
+
+            m_ledDeviceThreads[deviceType] = new QThread();
+            m_mailboxes[deviceType] = new LedDeviceMailbox();
+            m_mailboxes[deviceType]->setLedDevice(ledDevice);
+            m_mailboxes[deviceType]->setMaxFramesInFlight(kMaxFramesInFlight);
+            // Both live in the device thread
+            connect(ledDevice, SIGNAL(framesInFlight(int)), m_mailboxes[deviceType], SLOT(setFramesInFlight(int)), Qt::DirectConnection);
+
+            ledDevice->moveToThread(m_ledDeviceThreads[deviceType]);
+            m_mailboxes[deviceType]->moveToThread(m_ledDeviceThreads[deviceType]);
+            m_ledDeviceThreads[deviceType]->start();
+        }
+
+        ActiveDevice device;
+        device.type = deviceType;
+        device.mailbox = m_mailboxes[deviceType];
+        device.firstLed = (i == 0) ? 0 : Settings::getFirstLed(deviceType);
+        device.ledsCount = Settings::getNumberOfLeds(deviceType);
+        m_activeDevices.append(device);
 
-        connectSignalSlotsLedDevice();
+        QMetaObject::invokeMethod(m_ledDevices[deviceType], "setFirstLed", Qt::QueuedConnection, Q_ARG(int, device.firstLed));
 
-        m_ledDevice->moveToThread(m_ledDeviceThread);
-        m_ledDeviceThread->start();
-    } else {
-        disconnectSignalSlotsLedDevice();
+        DEBUG_LOW_LEVEL << Q_FUNC_INFO << "device:" << deviceType << "first led:" << device.firstLed << "leds:" << device.ledsCount;
+    }
+
+    m_ledDevice = m_ledDevices[deviceTypes.first()];
+    connectSignalSlotsLedDevice();
 
-        m_ledDevice = m_ledDevices[connectedDevice];
+    // Until the device tells its firmware version
+    emit effectsSupported(false);
 
-        connectSignalSlotsLedDevice();
+    for (int i = 0; i < m_activeDevices.size(); i++)
+    {
+        m_activeDevices[i].mailbox->postCommand(LedDeviceCommands::UpdateDeviceSettings);
+        m_activeDevices[i].mailbox->postCommand(LedDeviceCommands::Open);
     }
-    emit ledDeviceUpdateDeviceSettings();
-    emit ledDeviceOpen();
 }
 
 AbstractLedDevice * LedDeviceManager::createLedDevice(SupportedDevices::DeviceType deviceType)
@@ -416,21 +379,7 @@ void LedDeviceManager::connectSignalSlotsLedDevice()
     connect(m_ledDevice, SIGNAL(ioDeviceSuccess(bool)),         this, SIGNAL(ioDeviceSuccess(bool)), Qt::QueuedConnection);
     connect(m_ledDevice, SIGNAL(openDeviceSuccess(bool)),       this, SIGNAL(openDeviceSuccess(bool)), Qt::QueuedConnection);    
     connect(m_ledDevice, SIGNAL(colorsUpdated(QList<QRgb>)),    this, SIGNAL(setColors_VirtualDeviceCallback(QList<QRgb>)), Qt::QueuedConnection);
-
-    connect(this, SIGNAL(ledDeviceOpen()),                      m_ledDevice, SLOT(open()), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetColors(QList<QRgb>)),      m_ledDevice, SLOT(setColors(QList<QRgb>)), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceOffLeds()),                   m_ledDevice, SLOT(switchOffLeds()), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetRefreshDelay(int)),        m_ledDevice, SLOT(setRefreshDelay(int)), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetColorDepth(int)),          m_ledDevice, SLOT(setColorDepth(int)), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetSmoothSlowdown(int)),      m_ledDevice, SLOT(setSmoothSlowdown(int)), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetGamma(double)),            m_ledDevice, SLOT(setGamma(double)), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetBrightness(int)),          m_ledDevice, SLOT(setBrightness(int)), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetColorSequence(QString)),   m_ledDevice, SLOT(setColorSequence(QString)), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceSetLuminosityThreshold(int))      ,m_ledDevice, SLOT(setLuminosityThreshold(int)));
-    connect(this, SIGNAL(ledDeviceSetMinimumLuminosityEnabled(bool)),m_ledDevice, SLOT(setMinimumLuminosityThresholdEnabled(bool)));
-    connect(this, SIGNAL(ledDeviceRequestFirmwareVersion()),    m_ledDevice, SLOT(requestFirmwareVersion()), Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceUpdateWBAdjustments()),       m_ledDevice, SLOT(updateDeviceSettings()),  Qt::QueuedConnection);
-    connect(this, SIGNAL(ledDeviceUpdateDeviceSettings()),      m_ledDevice, SLOT(updateDeviceSettings()), Qt::QueuedConnection);
+    connect(m_ledDevice, SIGNAL(effectsSupported(bool)),        this, SLOT(ledDeviceEffectsSupported(bool)), Qt::QueuedConnection);
 }
 
 void LedDeviceManager::disconnectSignalSlotsLedDevice()
@@ -447,123 +396,5 @@ void LedDeviceManager::disconnectSignalSlotsLedDevice()
     disconnect(m_ledDevice, SIGNAL(ioDeviceSuccess(bool)),      this, SIGNAL(ioDeviceSuccess(bool)));
     disconnect(m_ledDevice, SIGNAL(openDeviceSuccess(bool)),    this, SIGNAL(openDeviceSuccess(bool)));
     disconnect(m_ledDevice, SIGNAL(colorsUpdated(QList<QRgb>)), this, SIGNAL(setColors_VirtualDeviceCallback(QList<QRgb>)));
-
-    disconnect(this, SIGNAL(ledDeviceOpen()),                   m_ledDevice, SLOT(open()));
-    disconnect(this, SIGNAL(ledDeviceSetColors(QList<QRgb>)),   m_ledDevice, SLOT(setColors(QList<QRgb>)));
-    disconnect(this, SIGNAL(ledDeviceOffLeds()),                m_ledDevice, SLOT(switchOffLeds()));
-    disconnect(this, SIGNAL(ledDeviceSetRefreshDelay(int)),     m_ledDevice, SLOT(setRefreshDelay(int)));
-    disconnect(this, SIGNAL(ledDeviceSetColorDepth(int)),       m_ledDevice, SLOT(setColorDepth(int)));
-    disconnect(this, SIGNAL(ledDeviceSetSmoothSlowdown(int)),   m_ledDevice, SLOT(setSmoothSlowdown(int)));
-    disconnect(this, SIGNAL(ledDeviceSetGamma(double)),         m_ledDevice, SLOT(setGamma(double)));
-    disconnect(this, SIGNAL(ledDeviceSetBrightness(int)),       m_ledDevice, SLOT(setBrightness(int)));
-    disconnect(this, SIGNAL(ledDeviceSetColorSequence(QString)),m_ledDevice, SLOT(setColorSequence(QString)));
-    disconnect(this, SIGNAL(ledDeviceSetLuminosityThreshold(int))      ,m_ledDevice, SLOT(setLuminosityThreshold(int)));
-    disconnect(this, SIGNAL(ledDeviceSetMinimumLuminosityEnabled(bool)),m_ledDevice, SLOT(setMinimumLuminosityThresholdEnabled(bool)));
-    disconnect(this, SIGNAL(ledDeviceRequestFirmwareVersion()), m_ledDevice, SLOT(requestFirmwareVersion()));
-    disconnect(this, SIGNAL(ledDeviceUpdateWBAdjustments()),    m_ledDevice, SLOT(updateDeviceSettings()));
-    disconnect(this, SIGNAL(ledDeviceUpdateDeviceSettings()),   m_ledDevice, SLOT(updateDeviceSettings()));
-}
-
-void LedDeviceManager::cmdQueueAppend(LedDeviceCommands::Cmd cmd)
-{
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << cmd;
-
-    if (m_cmdQueue.contains(cmd) == false)
-    {
-        m_cmdQueue.append(cmd);
-    }
-}
-
-void LedDeviceManager::cmdQueueProcessNext()
-{
-    DEBUG_MID_LEVEL << Q_FUNC_INFO << m_cmdQueue;
-
-    if (m_cmdQueue.isEmpty() == false)
-    {
-        LedDeviceCommands::Cmd cmd = m_cmdQueue.takeFirst();
-
-        DEBUG_HIGH_LEVEL << Q_FUNC_INFO << "processing cmd = " << cmd;
-
-        switch(cmd)
-        {
-        case LedDeviceCommands::OffLeds:
-            m_cmdTimeoutTimer->start();
-            processOffLeds();
-            break;
-
-        case LedDeviceCommands::SetColors:
-            if (m_isColorsSaved) {
-                m_cmdTimeoutTimer->start();
-                emit ledDeviceSetColors(m_savedColors);
-            }
-            break;
-
-        case LedDeviceCommands::SetRefreshDelay:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetRefreshDelay(m_savedRefreshDelay);
-            break;
-
-        case LedDeviceCommands::SetColorDepth:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetColorDepth(m_savedColorDepth);
-            break;
-
-        case LedDeviceCommands::SetSmoothSlowdown:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetSmoothSlowdown(m_savedSmoothSlowdown);
-            break;
-
-        case LedDeviceCommands::SetGamma:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetGamma(m_savedGamma);
-            break;
-
-        case LedDeviceCommands::SetBrightness:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetBrightness(m_savedBrightness);
-            break;
-
-        case LedDeviceCommands::SetColorSequence:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetColorSequence(m_savedColorSequence);
-            break;
-
-        case LedDeviceCommands::SetLuminosityThreshold:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetLuminosityThreshold(m_savedLuminosityThreshold);
-            break;
-
-        case LedDeviceCommands::SetMinimumLuminosityEnabled:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceSetMinimumLuminosityEnabled(m_savedIsMinimumLuminosityEnabled);
-            break;
-
-        case LedDeviceCommands::RequestFirmwareVersion:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceRequestFirmwareVersion();
-            break;
-
-        case LedDeviceCommands::UpdateDeviceSettings:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceUpdateDeviceSettings();
-            break;
-
-        case LedDeviceCommands::UpdateWBAdjustments:
-            m_cmdTimeoutTimer->start();
-            emit ledDeviceUpdateWBAdjustments();
-            break;
-
-        default:
-            qCritical() << Q_FUNC_INFO << "fail process cmd =" << cmd;
-            break;
-        }
-    }
-}
-
-void LedDeviceManager::ledDeviceCommandTimedOut()
-{
-    ledDeviceCommandCompleted(false);
-    emit ioDeviceSuccess(false);
+    disconnect(m_ledDevice, SIGNAL(effectsSupported(bool)),     this, SLOT(ledDeviceEffectsSupported(bool)));
 }
-
-
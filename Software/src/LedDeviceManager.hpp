@@ -29,11 +29,19 @@
 #include "enums.hpp"
 #include "AbstractLedDevice.hpp"
 
-class QTimer;
+class LedDeviceMailbox;
 
 /*!
     This class creates \a ILedDevice implementations and manages them after.
     It is always better way to interact with ILedDevice through \code LedDeviceManager \endcode.
+
+    Besides the connected device, additional devices from the settings are driven
+    with the same frames. Every device lives in its own thread and gets the part of
+    the frame starting from its first LED, so a slow device doesn't delay the others.
+    Status signals are forwarded from the connected device only. Effects are
+    reported supported only if the connected device plays them and drives all LEDs.
+    Devices telling the frame they show get new colors only while less than
+    \a kMaxFramesInFlight frames are on the way, so they show recent ones.
  */
 class LedDeviceManager : public QObject
 {
@@ -48,30 +56,17 @@ signals:
     void ioDeviceSuccess(bool isSuccess);
     void firmwareVersion(const QString & fwVersion);
     void setColors_VirtualDeviceCallback(const QList<QRgb> & colors);
-
-    // This signals are directly connected to ILedDevice. Don't use outside.
-    void ledDeviceOpen();
-    void ledDeviceSetColors(const QList<QRgb> & colors);
-    void ledDeviceOffLeds();
-    void ledDeviceSetRefreshDelay(int value);
-    void ledDeviceSetColorDepth(int value);
-    void ledDeviceSetSmoothSlowdown(int value);
-    void ledDeviceSetGamma(double value);
-    void ledDeviceSetBrightness(int value);
-    void ledDeviceSetLuminosityThreshold(int value);
-    void ledDeviceSetMinimumLuminosityEnabled(bool);
-    void ledDeviceSetColorSequence(QString value);
-    void ledDeviceRequestFirmwareVersion();
-    void ledDeviceUpdateWBAdjustments();
-    void ledDeviceUpdateDeviceSettings();
+    void effectsSupported(bool isSupported);
 
 public slots:
     void init();
 
     void recreateLedDevice(const SupportedDevices::DeviceType deviceType);
+    void updateActiveDevices();
 
     // This slots are protected from the overflow of queries
     void setColors(const QList<QRgb> & colors);
+    void setEffect(const LedEffect & effect);
     void switchOffLeds();
     void switchOnLeds();
     void setRefreshDelay(int value);
@@ -88,36 +83,39 @@ public slots:
 
 private slots:
     void ledDeviceCommandCompleted(bool ok);
-    void ledDeviceCommandTimedOut();
+    void ledDeviceEffectsSupported(bool isSupported);
 
 private:    
     void initLedDevice();
     AbstractLedDevice * createLedDevice(SupportedDevices::DeviceType deviceType);
     void connectSignalSlotsLedDevice();
     void disconnectSignalSlotsLedDevice();
-    void cmdQueueAppend(LedDeviceCommands::Cmd);
-    void cmdQueueProcessNext();
-    void processOffLeds();
+    void postColors(const QList<QRgb> & colors);
 
 private:
-    bool m_isLastCommandCompleted;
+    struct ActiveDevice {
+        SupportedDevices::DeviceType type;
+        LedDeviceMailbox *mailbox;
+        int firstLed;
+        int ledsCount;
+    };
+
     bool m_isColorsSaved;
     Backlight::Status m_backlightStatus;
 
-    QList<LedDeviceCommands::Cmd> m_cmdQueue;
-
+    // Last colors or effect to restore them after switching on
     QList<QRgb> m_savedColors;
-    int m_savedRefreshDelay;
-    int m_savedColorDepth;
-    int m_savedSmoothSlowdown;
-    double m_savedGamma;
-    int m_savedBrightness;
-    int m_savedLuminosityThreshold;
-    bool m_savedIsMinimumLuminosityEnabled;
-    QString m_savedColorSequence;
+    bool m_isEffectSaved;
+    LedEffect m_savedEffect;
 
+    // Indexed by SupportedDevices::DeviceType, created on demand
     QList<AbstractLedDevice *> m_ledDevices;
+    QList<QThread *> m_ledDeviceThreads;
+    QList<LedDeviceMailbox *> m_mailboxes;
+
+    // The connected device goes first
+    QList<ActiveDevice> m_activeDevices;
     AbstractLedDevice *m_ledDevice;
-    QThread *m_ledDeviceThread;
-    QTimer *m_cmdTimeoutTimer;
+
+    static const int kMaxFramesInFlight;
 };
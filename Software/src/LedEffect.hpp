@@ -0,0 +1,75 @@
+/*
+ * LedEffect.hpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QList>
+#include <QColor>
+#include <QMetaType>
+
+/*!
+  Effect the device plays by itself, so the host sends nothing while the
+  LEDs change, see CMD_SET_EFFECT. All LEDs show the same color, every
+  keyframe is a transition from the previous color to the keyframe one.
+*/
+struct LedEffect
+{
+    //! Values of EFFECT_EASINGS in COMMANDS.h
+    enum Easing {
+        EasingLinear,
+        EasingIn,
+        EasingOut,
+        EasingInOut,
+        EasingStep
+    };
+
+    struct Keyframe {
+        Keyframe(QRgb color_ = 0, int durationMs_ = 0, Easing easing_ = EasingLinear)
+            : color(color_), durationMs(durationMs_), easing(easing_) {}
+
+        QRgb color;
+        int durationMs;
+        Easing easing;
+    };
+
+    LedEffect() : isLoop(false), isShuffle(false) {}
+
+    //! Time of one pass over the keyframes
+    int durationMs() const
+    {
+        int duration = 0;
+        for (int i = 0; i < keyframes.count(); i++)
+            duration += keyframes[i].durationMs;
+        return duration;
+    }
+
+    QList<Keyframe> keyframes;
+    bool isLoop;
+    bool isShuffle; //!< random next keyframe, loops as well
+};
+
+Q_DECLARE_METATYPE(LedEffect)
@@ -103,6 +103,7 @@ void LightpackApplication::initializeAll(const QString & appDirPath)
     qRegisterMetaType<Backlight::Status>("Backlight::Status");
     qRegisterMetaType<DeviceLocked::DeviceLockStatus>("DeviceLocked::DeviceLockStatus");
     qRegisterMetaType< QList<Plugin*> >("QList<Plugin*>");
+    qRegisterMetaType<LedEffect>("LedEffect");
 
 
     if (Settings::isBacklightEnabled())
@@ -500,10 +501,18 @@ void LightpackApplication::startApiServer()
 
     connect(m_ledDeviceManager, SIGNAL(setColors_VirtualDeviceCallback(QList<QRgb>)), m_pluginInterface,    SLOT(updateColors(QList<QRgb>)), Qt::QueuedConnection);
 
-    m_apiServer->firstStart();
+    // API frames go from the server (or its parse task) thread straight to the device thread
+    connect(m_apiServer, SIGNAL(updateLedsColors(const QList<QRgb> &)), m_ledDeviceManager, SLOT(setColors(QList<QRgb>)), Qt::QueuedConnection);
+    if (!m_noGui)
+    {
+        connect(m_apiServer, SIGNAL(updateLedsColors(const QList<QRgb> &)), m_settingsWindow, SLOT(updateVirtualLedsColors(QList<QRgb>)), Qt::QueuedConnection);
+    }
 
+    // Server socket and client sockets are created on the server thread
     m_apiServer->moveToThread(m_apiServerThread);
     m_apiServerThread->start();
+
+    QMetaObject::invokeMethod(m_apiServer, "firstStart", Qt::QueuedConnection);
 }
 
 void LightpackApplication::startLedDeviceManager()
@@ -552,6 +561,7 @@ void LightpackApplication::startLedDeviceManager()
     connect(settings(), SIGNAL(ledCoefBlueChanged(int,double))  ,m_ledDeviceManager, SLOT(updateWBAdjustments()), Qt::QueuedConnection);
     connect(settings(), SIGNAL(ledCoefRedChanged(int,double))   ,m_ledDeviceManager, SLOT(updateWBAdjustments()), Qt::QueuedConnection);
     connect(settings(), SIGNAL(ledCoefGreenChanged(int,double)) ,m_ledDeviceManager, SLOT(updateWBAdjustments()), Qt::QueuedConnection);
+    connect(settings(), SIGNAL(activeDevicesChanged()),             m_ledDeviceManager, SLOT(updateActiveDevices()), Qt::QueuedConnection);
 
 //    connect(settingsObj, SIGNAL(settingsProfileChanged()),       m_ledDeviceManager, SLOT(updateDeviceSettings()), Qt::QueuedConnection);
 
@@ -610,6 +620,8 @@ void LightpackApplication::initGrabManager()
     connect(settings(), SIGNAL(grabberTypeChanged(const Grab::GrabberType &)), m_grabManager, SLOT(onGrabberTypeChanged(const Grab::GrabberType &)), Qt::QueuedConnection);
     connect(settings(), SIGNAL(grabSlowdownChanged(int)), m_grabManager, SLOT(onGrabSlowdownChanged(int)), Qt::QueuedConnection);
     connect(settings(), SIGNAL(grabAvgColorsEnabledChanged(bool)), m_grabManager, SLOT(onGrabAvgColorsEnabledChanged(bool)), Qt::QueuedConnection);
+    connect(settings(), SIGNAL(grabChangeThresholdChanged(int)), m_grabManager, SLOT(onGrabChangeThresholdChanged(int)), Qt::QueuedConnection);
+    connect(settings(), SIGNAL(grabLetterboxDetectionEnabledChanged(bool)), m_grabManager, SLOT(onGrabLetterboxDetectionEnabledChanged(bool)), Qt::QueuedConnection);
 
     connect(settings(), SIGNAL(profileLoaded(const QString &)),        m_grabManager, SLOT(settingsProfileChanged(const QString &)), Qt::QueuedConnection);
     connect(settings(), SIGNAL(currentProfileInited(const QString &)), m_grabManager, SLOT(settingsProfileChanged(const QString &)), Qt::QueuedConnection);
@@ -631,6 +643,8 @@ void LightpackApplication::initGrabManager()
     connect(m_moodlampManager, SIGNAL(updateLedsColors(const QList<QRgb> &)),    m_ledDeviceManager, SLOT(setColors(QList<QRgb>)), Qt::QueuedConnection);
     connect(m_grabManager, SIGNAL(updateLedsColors(const QList<QRgb> &)), m_pluginInterface, SLOT(updateColors(const QList<QRgb> &)), Qt::QueuedConnection);
     connect(m_moodlampManager, SIGNAL(updateLedsColors(const QList<QRgb> &)), m_pluginInterface, SLOT(updateColors(const QList<QRgb> &)), Qt::QueuedConnection);
+    connect(m_moodlampManager, SIGNAL(updateLedsEffect(LedEffect)), m_ledDeviceManager, SLOT(setEffect(LedEffect)), Qt::QueuedConnection);
+    connect(m_ledDeviceManager, SIGNAL(effectsSupported(bool)), m_moodlampManager, SLOT(setDeviceEffectsSupported(bool)), Qt::QueuedConnection);
     connect(m_grabManager, SIGNAL(ambilightTimeOfUpdatingColors(double)), m_pluginInterface, SLOT(refreshAmbilightEvaluated(double)));
     connect(m_grabManager,SIGNAL(changeScreen(QRect)),m_pluginInterface,SLOT(refreshScreenRect(QRect)));
 
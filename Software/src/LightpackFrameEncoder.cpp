@@ -0,0 +1,139 @@
+/*
+ * LightpackFrameEncoder.cpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LightpackFrameEncoder.hpp"
+
+#include <string.h>
+
+#include "../../CommonHeaders/COMMANDS.h"   /* CMD defines */
+
+namespace {
+const int kIndexCommand = 1;
+const int kIndexDataStart = 2;
+const int kIndexSequence = 1 + INDEX_UPDATE_LEDS_SEQUENCE;
+}
+
+LightpackFrameEncoder::LightpackFrameEncoder()
+    : m_isColorsValid(false)
+    , m_isCompactCommands(false)
+{
+    memset(m_colors, 0, sizeof(m_colors));
+}
+
+void LightpackFrameEncoder::setCompactCommands(bool isSupported)
+{
+    if (m_isCompactCommands == isSupported)
+        return;
+
+    m_isCompactCommands = isSupported;
+    reset();
+}
+
+int LightpackFrameEncoder::encode(unsigned char *report)
+{
+    const unsigned char *data = report + kIndexDataStart;
+    quint16 colors[kLedsCount * 3];
+
+    // CMD_UPDATE_LEDS: 8 high bits of red, green, blue, then their 4 low bits
+    for (int i = 0; i < kLedsCount; i++, data += 6) {
+        colors[i * 3]     = (data[0] << 4) | (data[3] & 0x0f);
+        colors[i * 3 + 1] = (data[1] << 4) | (data[4] & 0x0f);
+        colors[i * 3 + 2] = (data[2] << 4) | (data[5] & 0x0f);
+    }
+
+    quint16 changedMask = 0;
+    int changedCount = 0;
+    bool isOneColor = true;
+
+    for (int i = 0; i < kLedsCount; i++) {
+        if (!m_isColorsValid || memcmp(&colors[i * 3], &m_colors[i * 3], 3 * sizeof(quint16)) != 0) {
+            changedMask |= 1 << i;
+            changedCount++;
+        }
+        if (memcmp(&colors[i * 3], &colors[0], 3 * sizeof(quint16)) != 0)
+            isOneColor = false;
+    }
+
+    if (changedCount == 0)
+        return 0;
+
+    memcpy(m_colors, colors, sizeof(m_colors));
+    m_isColorsValid = true;
+
+    if (!m_isCompactCommands)
+        return kReportSize;
+
+    // Compact colors overwrite the report, the frame sequence follows them
+    const unsigned char sequence[kSequenceSize] = { report[kIndexSequence], report[kIndexSequence + 1] };
+
+    unsigned char *out = report + kIndexDataStart;
+    const int changedSize = 2 + packedSize(3 * changedCount);
+
+    if (isOneColor) {
+        report[kIndexCommand] = CMD_FILL_LEDS;
+        out = pack12(out, colors, 3);
+    } else if (changedSize < packedSize(3 * kLedsCount)) {
+        report[kIndexCommand] = CMD_UPDATE_LEDS_CHANGED;
+        *out++ = changedMask & 0xff;
+        *out++ = changedMask >> 8;
+
+        quint16 changed[kLedsCount * 3];
+        int count = 0;
+        for (int i = 0; i < kLedsCount; i++) {
+            if (changedMask & (1 << i)) {
+                memcpy(&changed[count], &colors[i * 3], 3 * sizeof(quint16));
+                count += 3;
+            }
+        }
+        out = pack12(out, changed, count);
+    } else {
+        report[kIndexCommand] = CMD_UPDATE_LEDS_PACKED;
+        out = pack12(out, colors, 3 * kLedsCount);
+    }
+
+    memcpy(out, sequence, kSequenceSize);
+    out += kSequenceSize;
+
+    return out - report;
+}
+
+unsigned char * LightpackFrameEncoder::pack12(unsigned char *out, const quint16 *values, int count)
+{
+    for (int i = 0; i < count; i += 2) {
+        const quint16 first = values[i] & 0x0fff;
+        *out++ = first >> 4;
+
+        if (i + 1 == count) {
+            *out++ = (first & 0x0f) << 4;
+        } else {
+            const quint16 second = values[i + 1] & 0x0fff;
+            *out++ = ((first & 0x0f) << 4) | (second >> 8);
+            *out++ = second & 0xff;
+        }
+    }
+    return out;
+}
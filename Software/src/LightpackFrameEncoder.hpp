@@ -0,0 +1,78 @@
+/*
+ * LightpackFrameEncoder.hpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+/*!
+  Rewrites CMD_UPDATE_LEDS reports of one Lightpack unit into the shortest
+  command its firmware understands: CMD_FILL_LEDS when all LEDs have one
+  color, CMD_UPDATE_LEDS_CHANGED with the LEDs changed since the last
+  written report or CMD_UPDATE_LEDS_PACKED. Reports are written only as
+  long as their colors and the frame sequence number after them, 12-bit
+  values are packed into 1.5 bytes.
+
+  Encoder tracks the colors the unit shows, so it must see every colors
+  report in the order they are written, and be reset when that is unknown.
+*/
+class LightpackFrameEncoder
+{
+public:
+    static const int kLedsCount = 10; // of one unit
+    static const int kReportSize = 65; // 0-ReportID, 1-command, 2..65-data
+    static const int kSequenceSize = 2;
+
+    LightpackFrameEncoder();
+
+    /*!
+      Firmware x.7 and newer supports CMD_UPDATE_LEDS_PACKED and others,
+      the older one gets CMD_UPDATE_LEDS as is.
+    */
+    void setCompactCommands(bool isSupported);
+    bool isCompactCommands() const { return m_isCompactCommands; }
+
+    /*!
+      \param report CMD_UPDATE_LEDS report of kReportSize bytes, rewritten in place
+      \return bytes of the report to write, 0 if the unit shows these colors already
+    */
+    int encode(unsigned char *report);
+
+    /*!
+      Colors shown by the unit are unknown, e.g. after a failed write.
+      Next report is written in full.
+    */
+    void reset() { m_isColorsValid = false; }
+
+    static int packedSize(int valuesCount) { return (valuesCount * 3 + 1) / 2; }
+    static unsigned char * pack12(unsigned char *out, const quint16 *values, int count);
+
+private:
+    quint16 m_colors[kLedsCount * 3];
+    bool m_isColorsValid;
+    bool m_isCompactCommands;
+};
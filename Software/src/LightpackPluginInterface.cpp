@@ -11,7 +11,9 @@ using namespace SettingsScope;
 const int LightpackPluginInterface::SignalWaitTimeoutMs = 1000; // 1 second
 
 LightpackPluginInterface::LightpackPluginInterface(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_lockMutex(QMutex::Recursive),
+    m_lastLockHandle(0)
 {
     m_isRequestBacklightStatusDone = true;
     m_backlightStatusResult = Backlight::StatusUnknown;
@@ -33,11 +35,9 @@ LightpackPluginInterface::~LightpackPluginInterface()
 void LightpackPluginInterface::timeoutLock()
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO;
-    if (lockAlive)
-    {
-        lockAlive = false;
-    }
-    else
+    QMutexLocker locker(&m_lockMutex);
+    // Set-commands raise lockAlive without the mutex
+    if (lockAlive.fetchAndStoreOrdered(0) == 0)
     {
         if (!lockSessionKeys.isEmpty())
             if (lockSessionKeys[0].indexOf("API", 0) == -1)
@@ -48,9 +48,11 @@ void LightpackPluginInterface::timeoutLock()
 void LightpackPluginInterface::updatePlugin(QList<Plugin*> plugins)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    QMutexLocker locker(&m_lockMutex);
     if (!lockSessionKeys.isEmpty())
         UnLock(lockSessionKeys[0]);
     lockSessionKeys.clear();
+    updateLockHandle();
     //emit updateDeviceLockStatus(DeviceLocked::Unlocked, lockSessionKeys);
     _plugins = plugins;
 
@@ -92,13 +94,20 @@ Plugin* LightpackPluginInterface::findSessionKey(QString sessionKey)
 void LightpackPluginInterface::initColors(int numberOfLeds)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << numberOfLeds;
+    QMutexLocker locker(&m_lockMutex);
+
+    numberOfLeds = qBound(0, numberOfLeds, (int)MaximumNumberOfLeds::AbsoluteMaximum);
+
     m_curColors.clear();
-    m_setColors.clear();
     for (int i = 0; i < numberOfLeds; i++)
-    {
-        m_setColors << 0;
         m_curColors << 0;
-    }
+
+    // Not published, the holder sends a new frame anyway
+    m_frameWriteSeq.fetchAndAddOrdered(1);
+    for (int i = 0; i < MaximumNumberOfLeds::AbsoluteMaximum; i++)
+        m_frame[i].store(0);
+    m_numberOfLeds.storeRelease(numberOfLeds);
+    m_frameWriteSeq.fetchAndAddOrdered(1);
 }
 
 void LightpackPluginInterface::setNumberOfLeds(int numberOfLeds)
@@ -155,7 +164,11 @@ void LightpackPluginInterface::refreshScreenRect(QRect rect)
 void LightpackPluginInterface::updateColors(const QList<QRgb> & colors)
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO;
-    m_curColors = colors;
+    {
+        QMutexLocker locker(&m_lockMutex);
+        m_curColors = colors;
+    }
+    emit ColorsUpdated(colors);
 }
 
 QString LightpackPluginInterface::Version()
@@ -175,6 +188,7 @@ QString LightpackPluginInterface::GetSessionKey(QString module)
 
 int LightpackPluginInterface::CheckLock(QString sessionKey)
 {
+    QMutexLocker locker(&m_lockMutex);
     if (lockSessionKeys.isEmpty())
         return 0;
     if (lockSessionKeys[0]==sessionKey)
@@ -186,6 +200,7 @@ int LightpackPluginInterface::CheckLock(QString sessionKey)
 //TODO: lock unlock
 bool LightpackPluginInterface::Lock(QString sessionKey)
 {
+    QMutexLocker locker(&m_lockMutex);
     if (sessionKey == "") return false;
         if (lockSessionKeys.contains(sessionKey)) return true;
         if (sessionKey.indexOf("API", 0) != -1)
@@ -223,7 +238,8 @@ bool LightpackPluginInterface::Lock(QString sessionKey)
                       emit updateDeviceLockStatus(DeviceLocked::Plugin, lockSessionKeys);
 }
         DEBUG_LOW_LEVEL << Q_FUNC_INFO << "lock end";
-        lockAlive = true;
+        updateLockHandle();
+        lockAlive.storeRelease(1);
         emit ChangeLockStatus (true);
         return true;
 
@@ -231,10 +247,12 @@ bool LightpackPluginInterface::Lock(QString sessionKey)
 
 bool LightpackPluginInterface::UnLock(QString sessionKey)
 {
+    QMutexLocker locker(&m_lockMutex);
     if (lockSessionKeys.isEmpty()) return false;
         if (lockSessionKeys[0]==sessionKey)
         {
             lockSessionKeys.removeFirst();
+            updateLockHandle();
             if (lockSessionKeys.count()==0)
             {
                 emit updateDeviceLockStatus(DeviceLocked::Unlocked, lockSessionKeys);
@@ -253,6 +271,7 @@ bool LightpackPluginInterface::UnLock(QString sessionKey)
             if (lockSessionKeys.indexOf(sessionKey)!= -1)
             {
                lockSessionKeys.removeOne(sessionKey);
+               updateLockHandle();
                if (lockSessionKeys[0].indexOf("API", 0) != -1)
                    emit updateDeviceLockStatus(DeviceLocked::Api,lockSessionKeys);
                else
@@ -264,60 +283,176 @@ bool LightpackPluginInterface::UnLock(QString sessionKey)
 }
 
 
+bool LightpackPluginInterface::isLockOwner(const QString & sessionKey)
+{
+    QMutexLocker locker(&m_lockMutex);
+    return !lockSessionKeys.isEmpty() && lockSessionKeys[0] == sessionKey;
+}
+
+void LightpackPluginInterface::updateLockHandle()
+{
+    // Called with m_lockMutex held after every change of lockSessionKeys.
+    // The lock holder keeps its handle until another key gets the lock
+    QString owner = lockSessionKeys.isEmpty() ? QString() : lockSessionKeys[0];
+    if (owner == m_lockHandleOwner)
+        return;
+
+    m_lockHandleOwner = owner;
+
+    if (owner.isEmpty())
+    {
+        m_lockHandle.storeRelease(0);
+    } else {
+        if (++m_lastLockHandle <= 0)
+            m_lastLockHandle = 1;
+        m_lockHandle.storeRelease(m_lastLockHandle);
+    }
+}
+
+bool LightpackPluginInterface::isLockHandle(int handle)
+{
+    return handle != 0 && handle == m_lockHandle.loadAcquire();
+}
+
+int LightpackPluginInterface::LockHandle(QString sessionKey)
+{
+    QMutexLocker locker(&m_lockMutex);
+    if (!isLockOwner(sessionKey)) return 0;
+    return m_lockHandle.loadAcquire();
+}
+
 void LightpackPluginInterface::SetLockAlive(QString sessionKey)
 {
+    QMutexLocker locker(&m_lockMutex);
     if (lockSessionKeys.isEmpty()) return;
     if (lockSessionKeys[0]!=sessionKey) return;
-       lockAlive = true;
+       lockAlive.storeRelease(1);
 }
 
-// TODO: setcolor
-bool LightpackPluginInterface::SetColors(QString sessionKey, int r, int g, int b)
+void LightpackPluginInterface::beginFrameWrite()
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
-     lockAlive = true;
-    for (int i = 0; i < m_setColors.size(); i++)
+    // Odd sequence tells publishFrame() the frame is being changed
+    m_frameWriteSeq.fetchAndAddOrdered(1);
+}
+
+void LightpackPluginInterface::endFrameWrite()
+{
+    m_frameWriteSeq.fetchAndAddOrdered(1);
+    lockAlive.storeRelease(1);
+
+    publishFrame();
+}
+
+void LightpackPluginInterface::publishFrame()
+{
+    // Runs in the writer's thread. The device mailbox keeps only the latest
+    // frame until the device takes it, so frames are merged per device write
+    QMutexLocker locker(&m_publishMutex);
+
+    const int seq = m_frameWriteSeq.loadAcquire();
+    if (seq & 1)
+        return; // another writer is in the middle of a frame and publishes it when done
+
+    const int count = m_numberOfLeds.loadAcquire();
+
+    while (m_publishedFrame.count() > count)
+        m_publishedFrame.removeLast();
+    while (m_publishedFrame.count() < count)
+        m_publishedFrame << 0;
+
+    for (int i = 0; i < count; i++)
+        m_publishedFrame[i] = m_frame[i].load();
+
+    if (m_frameWriteSeq.fetchAndAddOrdered(0) != seq)
+        return; // changed while copying, the writer of the change publishes it
+
+    emit updateLedsColors(m_publishedFrame);
+
+    // Colors cache and ColorsUpdated belong to the interface thread,
+    // one update waits there at a time and takes the latest frame
+    if (m_isColorsUpdatePosted.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "publishColorsUpdate", Qt::QueuedConnection);
+}
+
+void LightpackPluginInterface::publishColorsUpdate()
+{
+    m_isColorsUpdatePosted.fetchAndStoreOrdered(0);
+
+    QList<QRgb> colors;
     {
-            m_setColors[i] = qRgb(r,g,b);
+        QMutexLocker locker(&m_publishMutex);
+        colors = m_publishedFrame;
     }
-    m_curColors = m_setColors;
-    emit updateLedsColors(m_setColors);
+    updateColors(colors);
+}
+
+bool LightpackPluginInterface::SetColorByHandle(int handle, int ind, int r, int g, int b)
+{
+    if (!isLockHandle(handle)) return false;
+    if (ind < 0 || ind >= m_numberOfLeds.loadAcquire()) return false;
+
+    beginFrameWrite();
+    m_frame[ind].store(qRgb(r,g,b));
+    endFrameWrite();
     return true;
 }
 
-bool LightpackPluginInterface::SetFrame(QString sessionKey, QList<QColor> colors)
+bool LightpackPluginInterface::SetFrameByHandle(int handle, QList<QColor> colors)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
-    lockAlive = true;
-    int availSize = colors.size() < m_setColors.size() ? colors.size() : m_setColors.size();
+    if (!isLockHandle(handle)) return false;
+    const int availSize = qMin(colors.size(), m_numberOfLeds.loadAcquire());
+
+    beginFrameWrite();
     for (int i = 0; i < availSize; i++)
-    {
-            m_setColors[i] = colors[i].rgb();
-    }
-    m_curColors = m_setColors;
-    emit updateLedsColors(m_setColors);
+        m_frame[i].store(colors[i].rgb());
+    endFrameWrite();
     return true;
 }
 
+bool LightpackPluginInterface::SetFrameByHandle(int handle, const QRgb *colors, int count)
+{
+    if (!isLockHandle(handle)) return false;
+    const int availSize = qMin(count, m_numberOfLeds.loadAcquire());
+
+    beginFrameWrite();
+    for (int i = 0; i < availSize; i++)
+        m_frame[i].store(colors[i]);
+    endFrameWrite();
+    return true;
+}
+
+// TODO: setcolor
+bool LightpackPluginInterface::SetColors(QString sessionKey, int r, int g, int b)
+{
+    QMutexLocker locker(&m_lockMutex);
+    if (!isLockOwner(sessionKey)) return false;
+    const int count = m_numberOfLeds.loadAcquire();
+
+    beginFrameWrite();
+    for (int i = 0; i < count; i++)
+        m_frame[i].store(qRgb(r,g,b));
+    endFrameWrite();
+    return true;
+}
+
+bool LightpackPluginInterface::SetFrame(QString sessionKey, QList<QColor> colors)
+{
+    QMutexLocker locker(&m_lockMutex);
+    if (!isLockOwner(sessionKey)) return false;
+    return SetFrameByHandle(m_lockHandle.loadAcquire(), colors);
+}
+
 bool LightpackPluginInterface::SetColor(QString sessionKey, int ind,int r, int g, int b)
 {
     DEBUG_MID_LEVEL << Q_FUNC_INFO << sessionKey;
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
-    lockAlive = true;
-    if (ind>m_setColors.size()-1) return false;
-    m_setColors[ind] = qRgb(r,g,b);
-    m_curColors = m_setColors;
-    emit updateLedsColors(m_setColors);
-    return true;
+    QMutexLocker locker(&m_lockMutex);
+    if (!isLockOwner(sessionKey)) return false;
+    return SetColorByHandle(m_lockHandle.loadAcquire(), ind, r, g, b);
 }
 
 bool LightpackPluginInterface::SetGamma(QString sessionKey, double gamma)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
      if (gamma >= Profile::Device::GammaMin && gamma <= Profile::Device::GammaMax)
      {
          emit updateGamma(gamma);
@@ -328,8 +463,7 @@ bool LightpackPluginInterface::SetGamma(QString sessionKey, double gamma)
 
 bool LightpackPluginInterface::SetBrightness(QString sessionKey, int brightness)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
      if (brightness >= Profile::Device::BrightnessMin && brightness <= Profile::Device::BrightnessMax)
      {
          emit updateBrightness(brightness);
@@ -340,8 +474,7 @@ bool LightpackPluginInterface::SetBrightness(QString sessionKey, int brightness)
 
 bool LightpackPluginInterface::SetSmooth(QString sessionKey, int smooth)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
      if (smooth >= Profile::Device::SmoothMin && smooth <= Profile::Device::SmoothMax)
      {
              emit updateSmooth(smooth);
@@ -352,8 +485,7 @@ bool LightpackPluginInterface::SetSmooth(QString sessionKey, int smooth)
 
 bool LightpackPluginInterface::SetProfile(QString sessionKey,QString profile)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
      QStringList profiles = Settings::findAllProfiles();
      if (profiles.contains(profile))
      {
@@ -365,8 +497,7 @@ bool LightpackPluginInterface::SetProfile(QString sessionKey,QString profile)
 
 bool LightpackPluginInterface::SetDevice(QString sessionKey,QString device)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
      QStringList devices = Settings::getSupportedDevices();
      if (devices.contains(device))
      {
@@ -380,8 +511,7 @@ bool LightpackPluginInterface::SetDevice(QString sessionKey,QString device)
 bool LightpackPluginInterface::SetStatus(QString sessionKey, int status)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << status;
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
      Backlight::Status statusSet = Backlight::StatusUnknown;
 
      if (status == 1)
@@ -399,8 +529,7 @@ bool LightpackPluginInterface::SetStatus(QString sessionKey, int status)
 
 bool LightpackPluginInterface::SetLeds(QString sessionKey, QList<QRect> leds)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
     int num =0;
      foreach(QRect rectLed, leds){
         Settings::setLedPosition(num, QPoint(rectLed.x(),rectLed.y()));
@@ -415,8 +544,7 @@ bool LightpackPluginInterface::SetLeds(QString sessionKey, QList<QRect> leds)
 
 bool LightpackPluginInterface::NewProfile(QString sessionKey, QString profile)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
 
      Settings::loadOrCreateProfile(profile);
      DEBUG_LOW_LEVEL << Q_FUNC_INFO << "OK:" << profile;
@@ -427,8 +555,7 @@ bool LightpackPluginInterface::NewProfile(QString sessionKey, QString profile)
 
 bool LightpackPluginInterface::DeleteProfile(QString sessionKey, QString profile)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
     QStringList profiles = Settings::findAllProfiles();
     if (profiles.contains(profile))
     {
@@ -444,8 +571,7 @@ bool LightpackPluginInterface::DeleteProfile(QString sessionKey, QString profile
 
 bool LightpackPluginInterface::SetBacklight(QString sessionKey, int backlight)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
     Lightpack::Mode status =  Lightpack::UnknownMode;
 
     if (backlight == 1)
@@ -465,8 +591,7 @@ bool LightpackPluginInterface::SetBacklight(QString sessionKey, int backlight)
 
 bool LightpackPluginInterface::SetCountLeds(QString sessionKey, int countLeds)
 {
-    if (lockSessionKeys.isEmpty()) return false;
-    if (lockSessionKeys[0]!=sessionKey) return false;
+    if (!isLockOwner(sessionKey)) return false;
 
     Settings::setNumberOfLeds(Settings::getConnectedDevice(), countLeds);
     emit updateCountLeds(countLeds);
@@ -523,6 +648,7 @@ int LightpackPluginInterface::GetStatus()
 
 bool LightpackPluginInterface::GetStatusAPI()
 {
+    QMutexLocker locker(&m_lockMutex);
     return (!lockSessionKeys.isEmpty());
 }
 
@@ -550,6 +676,7 @@ QList<QRect> LightpackPluginInterface::GetLeds()
 
 QList<QRgb> LightpackPluginInterface::GetColors()
 {
+   QMutexLocker locker(&m_lockMutex);
    return m_curColors;
 }
 
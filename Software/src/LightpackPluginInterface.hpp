@@ -3,6 +3,8 @@
 
 #include <QtGui>
 #include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
 #include "enums.hpp"
 
 class Plugin;
@@ -19,6 +21,7 @@ public:
      QString GetSessionKey(QString module);
      int CheckLock(QString sessionKey);
      bool Lock(QString sessionKey);
+     int LockHandle(QString sessionKey);
 
 // need LOCK
      bool UnLock(QString sessionKey);
@@ -26,6 +29,11 @@ public:
      bool SetColors(QString sessionKey, int r, int g, int b);
      bool SetFrame(QString sessionKey, QList<QColor> colors);
      bool SetColor(QString sessionKey, int ind,int r, int g, int b);
+     // Lock holder fast path: handle is taken from LockHandle() once after lock
+     // and stays valid until the lock goes to another session. Calls for one
+     // handle must come from one thread
+     bool SetColorByHandle(int handle, int ind, int r, int g, int b);
+     bool SetFrameByHandle(int handle, QList<QColor> colors);
      bool SetGamma(QString sessionKey, double gamma);
      bool SetBrightness(QString sessionKey, int brightness);
      bool SetCountLeds(QString sessionKey, int countLeds);
@@ -61,10 +69,14 @@ public:
      bool VerifySessionKey(QString sessionKey);
      void SetLockAlive(QString sessionKey);
 
+public:
+     bool SetFrameByHandle(int handle, const QRgb *colors, int count);
+
 signals:
      void ChangeProfile(QString profile);
      void ChangeStatus(int status);
      void ChangeLockStatus(bool lock);
+     void ColorsUpdated(const QList<QRgb> & colors);
 
 //end Plugin section
 
@@ -93,9 +105,35 @@ public slots:
 
 private slots:
       void timeoutLock();
+      void publishColorsUpdate();
 
 private:
-      bool lockAlive;
+      bool isLockOwner(const QString & sessionKey);
+      bool isLockHandle(int handle);
+      void updateLockHandle();
+      void beginFrameWrite();
+      void endFrameWrite();
+      void publishFrame();
+
+      // ApiServer calls lock checks, color getters and setters from its own thread
+      QMutex m_lockMutex;
+      QAtomicInt lockAlive;
+
+      // Handle of lockSessionKeys[0], 0 when nobody holds the lock
+      QAtomicInt m_lockHandle;
+      QString m_lockHandleOwner;
+      int m_lastLockHandle;
+
+      // Double-buffered frame of the lock holder. The holder writes LEDs in
+      // place into m_frame without locks, publishFrame() copies it into
+      // m_publishedFrame and sends it to the device right from the writer's
+      // thread. Only the colors cache is updated on the interface thread
+      QAtomicInt m_frame[MaximumNumberOfLeds::AbsoluteMaximum];
+      QAtomicInt m_numberOfLeds;
+      QAtomicInt m_frameWriteSeq; // odd while the holder writes m_frame
+      QMutex m_publishMutex; // keeps frames of different writers in order
+      QList<QRgb> m_publishedFrame;
+      QAtomicInt m_isColorsUpdatePosted;
 
       static const int SignalWaitTimeoutMs;
       QTime m_time;
@@ -107,7 +145,6 @@ private:
 
      QList<QString> lockSessionKeys;
      //QString lockSessionKey;
-     QList<QRgb> m_setColors;
      QList<QRgb> m_curColors;
      QTimer *m_timerLock;
 
@@ -0,0 +1,407 @@
+/*
+ * LightpackReportWriter.cpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LightpackReportWriter.hpp"
+
+#include <QMap>
+#include <QThread>
+#include <QTimer>
+#include "debug.h"
+
+#include "../../CommonHeaders/USB_ID.h"     /* For device VID, PID, vendor name and product name */
+#include "../../CommonHeaders/COMMANDS.h"   /* CMD defines */
+
+const int LightpackReportWriter::kReconnectInterval = 1000;
+const int LightpackReportWriter::kStatsLogInterval = 1000;
+
+LightpackReportWriter::LightpackReportWriter(QObject *parent)
+    : QObject(parent)
+    , m_devicesCount(0)
+    , m_isCompactCommands(0)
+    , m_isReconnectScheduled(0)
+    , m_isClosed(0)
+{
+}
+
+LightpackReportWriter::~LightpackReportWriter()
+{
+    closeDevices();
+}
+
+int LightpackReportWriter::openDevices()
+{
+    QMutexLocker locker(&m_devicesMutex);
+
+    m_isClosed.store(0);
+
+    if (m_units.size() > 0)
+        return m_units.size();
+
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << QString("hid_open(0x%1, 0x%2)")
+                       .arg(USB_VENDOR_ID, 4, 16, QChar('0'))
+                       .arg(USB_PRODUCT_ID, 4, 16, QChar('0'));
+
+    QList<hid_device*> handles;
+    openDevices(USB_VENDOR_ID, USB_PRODUCT_ID, &handles);
+    openDevices(USB_OLD_VENDOR_ID, USB_OLD_PRODUCT_ID, &handles);
+
+    for (int i = 0; i < handles.size(); i++) {
+        LightpackUnitWriter *unit = new LightpackUnitWriter(i, handles[i], this);
+        unit->setCompactCommands(m_isCompactCommands.load() != 0);
+
+        connect(unit, SIGNAL(writeFailed(int)), this, SLOT(onUnitWriteFailed(int)), Qt::QueuedConnection);
+
+#ifndef HID_API_ASYNC_WRITE
+        QThread *thread = new QThread();
+        unit->moveToThread(thread);
+        thread->start();
+        m_unitThreads.append(thread);
+#endif
+
+        m_units.append(unit);
+    }
+
+    m_devicesCount.store(m_units.size());
+    return m_units.size();
+}
+
+void LightpackReportWriter::setCompactCommands(bool isSupported)
+{
+    QMutexLocker locker(&m_devicesMutex);
+
+    m_isCompactCommands.store(isSupported ? 1 : 0);
+    for (int i = 0; i < m_units.size(); i++)
+        m_units[i]->setCompactCommands(isSupported);
+}
+
+void LightpackReportWriter::openDevices(unsigned short vid, unsigned short pid, QList<hid_device*> *handles)
+{
+    struct hid_device_info *devs, *cur_dev;
+    const char *path_to_open = NULL;
+    hid_device * handle = NULL;
+    QMap<QString, hid_device*> map;
+    QList<hid_device*> list;
+
+    devs = hid_enumerate(vid, pid);
+    cur_dev = devs;
+    while (cur_dev) {
+        path_to_open = cur_dev->path;
+        if (path_to_open) {
+            /* Open the device */
+            handle = hid_open_path(path_to_open);
+
+            if(handle != NULL) {
+
+                // Immediately return from hid_read() if no data available
+                hid_set_nonblocking(handle, 1);
+                if(cur_dev->serial_number != NULL && wcslen(cur_dev->serial_number) > 0) {
+                    QString serialNum = QString::fromWCharArray(cur_dev->serial_number);
+                    DEBUG_LOW_LEVEL << "found Lightpack, serial number: " << serialNum;
+                    map.insert(serialNum, handle);
+                } else {
+                    DEBUG_LOW_LEVEL << "found Lightpack, without serial number";
+                    list.append(handle);
+                }
+            } else {
+                qCritical() << Q_FUNC_INFO << "couldn't open dev by path";
+            }
+        }
+        cur_dev = cur_dev->next;
+    }
+    hid_free_enumeration(devs);
+    handles->append(map.values());
+    handles->append(list);
+}
+
+void LightpackReportWriter::closeDevices()
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+
+    // Explicitly closed devices shouldn't be reopened in the background
+    m_isClosed.store(1);
+
+    closeUnits();
+}
+
+void LightpackReportWriter::closeUnits()
+{
+    QMutexLocker locker(&m_devicesMutex);
+
+    QList<LightpackUnitWriter *> units = m_units;
+    QList<QThread *> threads = m_unitThreads;
+    m_units.clear();
+    m_unitThreads.clear();
+    m_devicesCount.store(0);
+
+    // Unit may be in the middle of a blocking write, don't make enqueue() wait for it
+    locker.unlock();
+
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i]->quit();
+        threads[i]->wait();
+        delete threads[i];
+    }
+    for (int i = 0; i < units.size(); i++)
+        delete units[i];
+}
+
+bool LightpackReportWriter::readReport(unsigned char *buffer, int size)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+
+    QMutexLocker locker(&m_devicesMutex);
+
+    if (m_units.size() == 0)
+        return false;
+
+    return m_units[0]->read(buffer, size);
+}
+
+void LightpackReportWriter::beginFrame()
+{
+    if (m_currentFrame.isNull())
+        m_currentFrame = LightpackFramePtr(new LightpackFrame());
+}
+
+bool LightpackReportWriter::enqueue(int command, int unit, const unsigned char *buffer)
+{
+    QMutexLocker locker(&m_devicesMutex);
+
+    if (m_units.size() == 0 || unit >= m_units.size()) {
+        QMutexLocker statsLocker(&m_statsMutex);
+        m_stats.droppedNoDevices++;
+        return false;
+    }
+
+    const bool isOwnFrame = m_currentFrame.isNull();
+    if (isOwnFrame)
+        beginFrame();
+
+    const int first = unit == kAllUnits ? 0 : unit;
+    const int last = unit == kAllUnits ? m_units.size() - 1 : unit;
+
+    for (int i = first; i <= last; i++) {
+        m_currentFrame->pending.ref();
+        m_units[i]->enqueue(command, buffer, m_currentFrame);
+    }
+
+    locker.unlock();
+
+    if (isOwnFrame)
+        endFrame();
+
+    return true;
+}
+
+bool LightpackReportWriter::enqueueUnits(int command, const unsigned char *reports, const QVector<int> &units)
+{
+    QMutexLocker locker(&m_devicesMutex);
+
+    if (m_units.size() == 0) {
+        QMutexLocker statsLocker(&m_statsMutex);
+        m_stats.droppedNoDevices++;
+        return false;
+    }
+
+    const bool isOwnFrame = m_currentFrame.isNull();
+    if (isOwnFrame)
+        beginFrame();
+
+    bool ok = true;
+    for (int i = 0; i < units.size(); i++) {
+        const int unit = units[i];
+        if (unit >= m_units.size()) {
+            ok = false;
+            continue;
+        }
+        m_currentFrame->pending.ref();
+        m_units[unit]->enqueue(command, reports + unit * kReportSize, m_currentFrame);
+    }
+
+    locker.unlock();
+
+    if (isOwnFrame)
+        endFrame();
+
+    return ok;
+}
+
+void LightpackReportWriter::endFrame()
+{
+    if (m_currentFrame.isNull())
+        return;
+
+    LightpackFramePtr frame = m_currentFrame;
+    m_currentFrame.clear();
+
+    // Release the reference taken in beginFrame(), frame completes when all units are done
+    completeReport(frame, true);
+}
+
+void LightpackReportWriter::completeReport(const LightpackFramePtr &frame, bool ok)
+{
+    if (frame.isNull())
+        return;
+
+    if (!ok)
+        frame->isFailed.store(1);
+
+    if (frame->pending.deref())
+        return;
+
+    const bool isSuccess = frame->isFailed.load() == 0;
+    const qint64 latencyUs = frame->timer.nsecsElapsed() / 1000;
+
+    bool isLogStats = false;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.frames++;
+        if (!isSuccess)
+            m_stats.failedFrames++;
+        m_stats.lastFrameLatencyUs = latencyUs;
+        if (latencyUs > m_stats.maxFrameLatencyUs)
+            m_stats.maxFrameLatencyUs = latencyUs;
+
+        isLogStats = (m_stats.frames % kStatsLogInterval == 0);
+    }
+
+    // Caller may hold queue locks, collect stats of the units later in the writer thread
+    if (isLogStats)
+        QMetaObject::invokeMethod(this, "logStats", Qt::QueuedConnection);
+
+    emit ioDeviceSuccess(isSuccess);
+}
+
+void LightpackReportWriter::scheduleReconnect()
+{
+    if (m_isClosed.load())
+        return;
+
+    if (m_isReconnectScheduled.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "reconnect", Qt::QueuedConnection);
+}
+
+bool LightpackReportWriter::pollTelemetry()
+{
+    QMutexLocker locker(&m_devicesMutex);
+
+    bool ok = m_units.size() > 0;
+    for (int i = 0; i < m_units.size(); i++)
+        ok &= m_units[i]->pollTelemetry();
+
+    return ok;
+}
+
+int LightpackReportWriter::framesInFlight(quint16 sequence)
+{
+    QMutexLocker locker(&m_devicesMutex);
+
+    int result = 0;
+    for (int i = 0; i < m_units.size(); i++)
+        result = qMax(result, m_units[i]->framesInFlight(sequence));
+
+    return result;
+}
+
+LightpackReportWriter::Stats LightpackReportWriter::stats() const
+{
+    Stats result;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        result = m_stats;
+    }
+
+    QMutexLocker locker(&m_devicesMutex);
+    for (int i = 0; i < m_units.size(); i++)
+        result.units.append(m_units[i]->stats());
+
+    return result;
+}
+
+void LightpackReportWriter::onUnitWriteFailed(int unit)
+{
+    {
+        // Units of the failed chain may be already closed and reopened
+        QMutexLocker locker(&m_devicesMutex);
+        if (m_units.contains(qobject_cast<LightpackUnitWriter *>(sender())) == false)
+            return;
+    }
+
+    qWarning() << Q_FUNC_INFO << "write to unit" << unit << "failed, reopening devices in the background";
+
+    logStats();
+
+    closeUnits();
+    scheduleReconnect();
+}
+
+void LightpackReportWriter::logStats()
+{
+    Stats current = stats();
+
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "frames:" << current.frames << "failed:" << current.failedFrames
+                    << "dropped without devices:" << current.droppedNoDevices
+                    << "last latency us:" << current.lastFrameLatencyUs << "max latency us:" << current.maxFrameLatencyUs;
+
+    for (int i = 0; i < current.units.size(); i++) {
+        const LightpackUnitWriter::Stats &unitStats = current.units[i];
+        DEBUG_LOW_LEVEL << Q_FUNC_INFO << "unit" << i << "written:" << unitStats.written
+                        << "merged:" << unitStats.merged << "skipped:" << unitStats.skipped
+                        << "dropped:" << unitStats.dropped
+                        << "failed:" << unitStats.failed << "max depth:" << unitStats.maxDepth
+                        << "last latency us:" << unitStats.lastLatencyUs
+                        << "avg latency us:" << (unitStats.written ? unitStats.totalLatencyUs / (qint64)unitStats.written : 0)
+                        << "max latency us:" << unitStats.maxLatencyUs;
+        if (unitStats.latchLatencies > 0)
+            DEBUG_LOW_LEVEL << Q_FUNC_INFO << "unit" << i << "latch latency us last:" << unitStats.lastLatchLatencyUs
+                            << "avg:" << unitStats.totalLatchLatencyUs / (qint64)unitStats.latchLatencies
+                            << "max:" << unitStats.maxLatchLatencyUs
+                            << "device merged:" << unitStats.deviceFramesMerged
+                            << "dropped:" << unitStats.deviceReportsDropped
+                            << "ISR overruns:" << unitStats.deviceIsrOverruns;
+    }
+}
+
+void LightpackReportWriter::reconnect()
+{
+    if (m_isClosed.load()) {
+        m_isReconnectScheduled.store(0);
+        return;
+    }
+
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << "open devices";
+
+    if (openDevices() == 0) {
+        DEBUG_MID_LEVEL << Q_FUNC_INFO << "open devices fail";
+        QTimer::singleShot(kReconnectInterval, this, SLOT(reconnect()));
+        return;
+    }
+
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << "Reopen success";
+    m_isReconnectScheduled.store(0);
+    emit reconnected();
+}
@@ -0,0 +1,141 @@
+/*
+ * LightpackReportWriter.hpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QList>
+#include <QVector>
+
+#include "LightpackUnitWriter.hpp"
+
+class QThread;
+
+/*!
+  Owns all Lightpack units of a chain and writes reports to them so that
+  \a LedDeviceLightpack never waits for USB. Every unit gets its own
+  \a LightpackUnitWriter, so the units are written concurrently: with
+  asynchronous HID writes the reports of a frame are submitted back to back
+  from the calling thread, otherwise every unit writes in a thread of its own.
+
+  Reports queued between beginFrame() and endFrame() form a frame;
+  ioDeviceSuccess() is emitted once all units have completed their reports
+  of the frame. A not yet written CMD_UPDATE_LEDS report of a unit is
+  replaced by the newer one; if a unit queue is full the oldest colors
+  report is dropped. Settings reports are never replaced.
+  When a write fails, all units are closed and reopened in the background
+  until it succeeds.
+*/
+class LightpackReportWriter : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        Stats() : frames(0), failedFrames(0), droppedNoDevices(0), lastFrameLatencyUs(0), maxFrameLatencyUs(0) {}
+        quint64 frames;
+        quint64 failedFrames;
+        quint64 droppedNoDevices;
+        // From beginFrame() till the last unit has written its report
+        qint64 lastFrameLatencyUs;
+        qint64 maxFrameLatencyUs;
+        QList<LightpackUnitWriter::Stats> units;
+    };
+
+    static const int kReportSize = LightpackUnitWriter::kReportSize;
+    static const int kAllUnits = -1;
+
+    explicit LightpackReportWriter(QObject *parent = 0);
+    virtual ~LightpackReportWriter();
+
+    // These methods are thread-safe
+    int openDevices();
+    void closeDevices();
+    int devicesCount() const { return m_devicesCount.load(); }
+    bool readReport(unsigned char *buffer, int size);
+    void scheduleReconnect();
+    Stats stats() const;
+    //! Applied to all units, also to the ones opened on reconnect
+    void setCompactCommands(bool isSupported);
+    //! Reads telemetry of all units into their stats, firmware x.7 and newer
+    bool pollTelemetry();
+    //! Frames up to \a sequence the slowest unit hasn't shown yet, firmware x.7 and newer
+    int framesInFlight(quint16 sequence);
+
+    // These methods must be called from one thread only
+    void beginFrame();
+    /*!
+      Puts report into the queue of the unit and returns immediately.
+      Report queued outside of beginFrame()/endFrame() forms a frame of its own.
+      \param command is placed to the command byte of the report
+      \param unit index of the device or kAllUnits
+      \param buffer report of kReportSize bytes
+    */
+    bool enqueue(int command, int unit, const unsigned char *buffer);
+    /*!
+      Queues reports of several units at once, taking the devices lock once.
+      \param reports reports of all units one after another, kReportSize bytes each
+      \param units indexes of the units to write, their reports only are read
+    */
+    bool enqueueUnits(int command, const unsigned char *reports, const QVector<int> &units);
+    void endFrame();
+
+    // Called by unit writers from their threads
+    void completeReport(const LightpackFramePtr &frame, bool ok);
+
+signals:
+    void ioDeviceSuccess(bool isSuccess);
+    void reconnected();
+
+private slots:
+    void reconnect();
+    void onUnitWriteFailed(int unit);
+    void logStats();
+
+private:
+    void openDevices(unsigned short vid, unsigned short pid, QList<hid_device*> *handles);
+    void closeUnits();
+
+private:
+    mutable QMutex m_devicesMutex;
+    QList<LightpackUnitWriter *> m_units;
+    QList<QThread *> m_unitThreads;
+    QAtomicInt m_devicesCount;
+    QAtomicInt m_isCompactCommands;
+
+    LightpackFramePtr m_currentFrame;
+
+    mutable QMutex m_statsMutex;
+    Stats m_stats;
+
+    QAtomicInt m_isReconnectScheduled;
+    QAtomicInt m_isClosed;
+
+    static const int kReconnectInterval;
+    static const int kStatsLogInterval;
+};
@@ -0,0 +1,510 @@
+/*
+ * LightpackUnitWriter.cpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtEndian>
+
+#include "LightpackUnitWriter.hpp"
+#include "LightpackReportWriter.hpp"
+#include "debug.h"
+
+#include "../../CommonHeaders/COMMANDS.h"   /* CMD defines */
+
+// Colors and effect reports supersede each other, only the latest one is written
+static inline bool isColorsCommand(int command)
+{
+    return command == CMD_UPDATE_LEDS || command == CMD_SET_EFFECT;
+}
+
+// Put by LedDeviceLightpack after the colors, report ID comes first
+static inline quint16 frameSequence(int command, const unsigned char *buffer)
+{
+    if (command != CMD_UPDATE_LEDS)
+        return 0;
+
+    return qFromLittleEndian<quint16>(buffer + 1 + INDEX_UPDATE_LEDS_SEQUENCE);
+}
+
+LightpackUnitWriter::LightpackUnitWriter(int unit, hid_device *handle, LightpackReportWriter *owner)
+    : QObject(NULL)
+    , m_unit(unit)
+    , m_owner(owner)
+    , m_queueHead(0)
+    , m_queueSize(0)
+    , m_handle(handle)
+    , m_writtenFrames(0)
+    , m_isColorsInFlight(false)
+    , m_lastLatchedFrame(0)
+    , m_writtenSequence(0)
+    , m_appliedSequence(0)
+    , m_writtenAtNs(0)
+    , m_isCompactCommands(0)
+    , m_isWakeupPosted(0)
+#ifdef HID_API_ASYNC_WRITE
+    , m_isWriting(0)
+    , m_writingSize(0)
+    , m_isWritingRetried(false)
+    , m_isStopping(0)
+    , m_pendingWrites(0)
+#endif
+{
+    m_clock.start();
+}
+
+LightpackUnitWriter::~LightpackUnitWriter()
+{
+#ifdef HID_API_ASYNC_WRITE
+    // Completion of the write in flight must not submit the next report
+    m_isStopping.store(1);
+#endif
+
+    clear();
+
+#ifdef HID_API_ASYNC_WRITE
+    // Async writes don't take m_handleMutex, wait for the completion callback
+    // to be done with this object. Writes time out, so it comes soon
+    QMutexLocker writeLocker(&m_writeMutex);
+    while (m_pendingWrites > 0)
+        m_writeCompleted.wait(&m_writeMutex);
+    writeLocker.unlock();
+#endif
+
+    // Waits for the blocking write or read in progress
+    QMutexLocker locker(&m_handleMutex);
+    hid_close(m_handle);
+}
+
+void LightpackUnitWriter::enqueue(int command, const unsigned char *buffer, const LightpackFramePtr &frame)
+{
+    QMutexLocker locker(&m_queueMutex);
+
+    m_stats.enqueued++;
+
+    if (isColorsCommand(command)) {
+        // Colors are latest-wins, overwrite the report which is still waiting
+        for (int i = 0; i < m_queueSize; i++) {
+            Report &report = m_queue[(m_queueHead + i) % kMaxQueueSize];
+            if (isColorsCommand(report.command)) {
+                memcpy(report.data, buffer, kReportSize);
+                report.command = command;
+                report.sequence = frameSequence(command, buffer);
+                report.data[0] = 0x00;
+                report.data[1] = command;
+                report.enqueuedAtNs = m_clock.nsecsElapsed();
+                m_owner->completeReport(report.frame, true);
+                report.frame = frame;
+                m_stats.merged++;
+                return;
+            }
+        }
+    }
+
+    if (m_queueSize == kMaxQueueSize) {
+        int oldestColors = -1;
+        for (int i = 0; i < m_queueSize && oldestColors < 0; i++) {
+            if (isColorsCommand(m_queue[(m_queueHead + i) % kMaxQueueSize].command))
+                oldestColors = i;
+        }
+
+        if (oldestColors < 0) {
+            m_stats.dropped++;
+            qWarning() << Q_FUNC_INFO << "unit" << m_unit << "queue is full of settings reports, command" << command << "dropped";
+            m_owner->completeReport(frame, false);
+            return;
+        }
+        dropReport(oldestColors);
+    }
+
+    Report &report = m_queue[(m_queueHead + m_queueSize) % kMaxQueueSize];
+    report.command = command;
+    report.sequence = frameSequence(command, buffer);
+    report.enqueuedAtNs = m_clock.nsecsElapsed();
+    report.frame = frame;
+    memcpy(report.data, buffer, kReportSize);
+    report.data[0] = 0x00; // ReportID
+    report.data[1] = command;
+
+    m_queueSize++;
+    if (m_queueSize > m_stats.maxDepth)
+        m_stats.maxDepth = m_queueSize;
+
+    locker.unlock();
+
+#ifdef HID_API_ASYNC_WRITE
+    // Submitted from the calling thread, so the reports of all units of a frame go out back to back
+    if (m_isWriting.testAndSetOrdered(0, 1))
+        submitNext();
+#else
+    if (m_isWakeupPosted.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "processQueue", Qt::QueuedConnection);
+#endif
+}
+
+bool LightpackUnitWriter::read(unsigned char *buffer, int size)
+{
+    QMutexLocker locker(&m_handleMutex);
+
+    int bytes_read = hid_read(m_handle, buffer, size);
+    if (bytes_read < 0) {
+        qWarning() << "Error reading data:" << bytes_read;
+        return false;
+    }
+    return true;
+}
+
+void LightpackUnitWriter::clear()
+{
+    QMutexLocker locker(&m_queueMutex);
+
+    while (m_queueSize > 0)
+        dropReport(0);
+    m_queueHead = 0;
+}
+
+LightpackUnitWriter::Stats LightpackUnitWriter::stats() const
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_stats;
+}
+
+void LightpackUnitWriter::setCompactCommands(bool isSupported)
+{
+    m_isCompactCommands.store(isSupported ? 1 : 0);
+}
+
+bool LightpackUnitWriter::pollTelemetry()
+{
+    unsigned char buffer[1 + TELEMETRY_REPORT_SIZE];
+    memset(buffer, 0, sizeof(buffer));
+
+    QMutexLocker handleLocker(&m_handleMutex);
+
+    m_queueMutex.lock();
+    const bool isInFlightBefore = m_isColorsInFlight;
+    const quint64 writtenBefore = m_writtenFrames;
+    m_queueMutex.unlock();
+
+    const qint64 requestedAtNs = m_clock.nsecsElapsed();
+    int bytes_read = hid_get_feature_report(m_handle, buffer, sizeof(buffer));
+    if (bytes_read < (int)sizeof(buffer)) {
+        qWarning() << Q_FUNC_INFO << "Error reading telemetry:" << bytes_read << "unit:" << m_unit;
+        return false;
+    }
+
+    QMutexLocker queueLocker(&m_queueMutex);
+
+    // Data follows the report ID
+    const unsigned char *data = buffer + 1;
+    const quint16 received = qFromLittleEndian<quint16>(data + INDEX_TELEMETRY_FRAMES_RECEIVED);
+    const quint16 applied = qFromLittleEndian<quint16>(data + INDEX_TELEMETRY_FRAME_APPLIED);
+    const quint16 appliedAgeMs = qFromLittleEndian<quint16>(data + INDEX_TELEMETRY_SOF)
+                                 - qFromLittleEndian<quint16>(data + INDEX_TELEMETRY_FRAME_APPLIED_SOF);
+
+    // Device has received the last written frame, the applied one is this much older
+    const quint16 appliedBehind = received - applied;
+
+    // Asynchronous writes don't wait for the handle, skip the poll if one was in flight
+    const bool isWrittenFramesKnown = !isInFlightBefore && !m_isColorsInFlight && writtenBefore == m_writtenFrames;
+
+    qint64 latchLatencyUs = -1;
+    if (isWrittenFramesKnown && applied != m_lastLatchedFrame && appliedBehind < kWrittenFramesHistory
+            && appliedBehind < m_writtenFrames) {
+        const qint64 enqueuedAtNs = m_writtenFrameEnqueuedAtNs[(m_writtenFrames - 1 - appliedBehind) % kWrittenFramesHistory];
+        const qint64 latchedAtNs = requestedAtNs - (qint64)appliedAgeMs * 1000000;
+
+        latchLatencyUs = qMax<qint64>(0, (latchedAtNs - enqueuedAtNs) / 1000);
+    }
+    m_lastLatchedFrame = applied;
+
+    const quint16 isrOverruns = qFromLittleEndian<quint16>(data + INDEX_TELEMETRY_ISR_OVERRUNS);
+    if (isrOverruns != m_stats.deviceIsrOverruns)
+        qWarning() << Q_FUNC_INFO << "unit" << m_unit << "timer ISR overruns:" << isrOverruns;
+
+    m_stats.deviceIsrOverruns = isrOverruns;
+    m_stats.deviceFramesMerged = qFromLittleEndian<quint16>(data + INDEX_TELEMETRY_FRAMES_MERGED);
+    m_stats.deviceReportsDropped = qFromLittleEndian<quint16>(data + INDEX_TELEMETRY_REPORTS_DROPPED);
+
+    if (latchLatencyUs >= 0) {
+        m_stats.latchLatencies++;
+        m_stats.lastLatchLatencyUs = latchLatencyUs;
+        m_stats.totalLatchLatencyUs += latchLatencyUs;
+        if (latchLatencyUs > m_stats.maxLatchLatencyUs)
+            m_stats.maxLatchLatencyUs = latchLatencyUs;
+    }
+
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << "unit" << m_unit << "frames received:" << received
+                    << "applied:" << applied << appliedAgeMs << "ms ago, latch latency us:" << latchLatencyUs;
+    return true;
+}
+
+int LightpackUnitWriter::framesInFlight(quint16 sequence)
+{
+    // Firmware sends the input report on every poll of the endpoint, the last one is up to date.
+    // Handle is busy with a blocking write or telemetry, the sequence read before will do
+    if (m_handleMutex.tryLock()) {
+        unsigned char buffer[kReportSize];
+        int appliedSequence = -1;
+
+        for (int i = 0; i < kMaxInputReportsRead; i++) {
+            const int bytes_read = hid_read(m_handle, buffer, sizeof(buffer));
+            if (bytes_read <= 0)
+                break;
+            if (bytes_read >= INDEX_APPLIED_SEQUENCE + 2)
+                appliedSequence = qFromLittleEndian<quint16>(buffer + INDEX_APPLIED_SEQUENCE);
+        }
+        m_handleMutex.unlock();
+
+        if (appliedSequence >= 0) {
+            QMutexLocker queueLocker(&m_queueMutex);
+            m_appliedSequence = appliedSequence;
+        }
+    }
+
+    QMutexLocker queueLocker(&m_queueMutex);
+
+    bool isColorsQueued = m_isColorsInFlight;
+    for (int i = 0; i < m_queueSize && !isColorsQueued; i++)
+        isColorsQueued = m_queue[(m_queueHead + i) % kMaxQueueSize].command == CMD_UPDATE_LEDS;
+
+    if (!isColorsQueued) {
+        if (m_appliedSequence == m_writtenSequence)
+            return 0;
+
+        // Lost report shouldn't hold the frames back forever
+        if (m_clock.nsecsElapsed() - m_writtenAtNs > (qint64)kAppliedSequenceTimeoutMs * 1000000) {
+            DEBUG_MID_LEVEL << Q_FUNC_INFO << "unit" << m_unit << "doesn't show frame" << m_writtenSequence
+                            << "applied:" << m_appliedSequence;
+            m_appliedSequence = m_writtenSequence;
+            return 0;
+        }
+    }
+
+    return (quint16)(sequence - m_appliedSequence);
+}
+
+void LightpackUnitWriter::processQueue()
+{
+    m_isWakeupPosted.fetchAndStoreOrdered(0);
+
+    Report report;
+
+    while (takeReport(&report)) {
+        DEBUG_MID_LEVEL << Q_FUNC_INFO << m_unit << report.command;
+
+        const int size = encodeReport(&report);
+        if (size == 0) {
+            skipReport(&report);
+            continue;
+        }
+
+        QMutexLocker handleLocker(&m_handleMutex);
+        int error = hid_write(m_handle, report.data, size);
+        if (error < 0) {
+            // Trying to repeat sending data:
+            error = hid_write(m_handle, report.data, size);
+        }
+        if (error >= 0 && report.command == CMD_UPDATE_LEDS) {
+            QMutexLocker queueLocker(&m_queueMutex);
+            frameWritten(report);
+        }
+        handleLocker.unlock();
+
+        if (!finishReport(&report, error))
+            return;
+    }
+}
+
+#ifdef HID_API_ASYNC_WRITE
+void LightpackUnitWriter::submitNext()
+{
+    // Called with m_isWriting set, from enqueue() or from the completion of the previous write
+    while (takeReport(&m_writing)) {
+        DEBUG_MID_LEVEL << Q_FUNC_INFO << m_unit << m_writing.command;
+
+        m_writingSize = encodeReport(&m_writing);
+        if (m_writingSize == 0) {
+            skipReport(&m_writing);
+            continue;
+        }
+
+        m_isWritingRetried = false;
+
+        // Before the submit, the callback may come right away
+        beginWrite();
+        if (hid_write_async(m_handle, m_writing.data, m_writingSize, writeCompleted, this) < 0) {
+            // m_isWriting stays set, the unit is reopened
+            finishReport(&m_writing, -1);
+            endWrite();
+        }
+        return;
+    }
+}
+
+void LightpackUnitWriter::writeCompleted(void *userData, int result)
+{
+    LightpackUnitWriter *unit = static_cast<LightpackUnitWriter *>(userData);
+    const bool isStopping = unit->m_isStopping.load() != 0;
+
+    if (result < 0 && !unit->m_isWritingRetried && !isStopping) {
+        // Trying to repeat sending data:
+        unit->m_isWritingRetried = true;
+        if (hid_write_async(unit->m_handle, unit->m_writing.data, unit->m_writingSize, writeCompleted, unit) == 0)
+            return;
+    }
+
+    if (result >= 0 && unit->m_writing.command == CMD_UPDATE_LEDS) {
+        QMutexLocker queueLocker(&unit->m_queueMutex);
+        unit->frameWritten(unit->m_writing);
+    }
+
+    if (unit->finishReport(&unit->m_writing, result) && !isStopping)
+        unit->submitNext();
+
+    // The last use of the unit, it may be destroyed right after
+    unit->endWrite();
+}
+
+void LightpackUnitWriter::beginWrite()
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_pendingWrites++;
+}
+
+void LightpackUnitWriter::endWrite()
+{
+    QMutexLocker locker(&m_writeMutex);
+    if (--m_pendingWrites == 0)
+        m_writeCompleted.wakeAll();
+}
+#endif
+
+// Returns the size of the report to write, 0 if the unit shows these colors already
+int LightpackUnitWriter::encodeReport(Report *report)
+{
+    if (report->command == CMD_UPDATE_LEDS) {
+        // Encoded here rather than in enqueue(): merged reports must be
+        // compared with the colors really written to the unit
+        m_encoder.setCompactCommands(m_isCompactCommands.load() != 0);
+        return m_encoder.encode(report->data);
+    }
+
+    if (report->command == CMD_OFF_ALL || report->command == CMD_SET_EFFECT
+            || report->command == CMD_SET_COLOR_CORRECTION) {
+        // The unit shows other colors than the encoder has sent
+        m_encoder.reset();
+    }
+    return kReportSize;
+}
+
+void LightpackUnitWriter::skipReport(Report *report)
+{
+    QMutexLocker queueLocker(&m_queueMutex);
+    m_isColorsInFlight = false;
+    m_stats.skipped++;
+    queueLocker.unlock();
+
+    m_owner->completeReport(report->frame, true);
+    report->frame.clear();
+}
+
+// Returns false if the write failed, the owner reopens the units then
+bool LightpackUnitWriter::finishReport(Report *report, int error)
+{
+    const qint64 latencyUs = (m_clock.nsecsElapsed() - report->enqueuedAtNs) / 1000;
+
+    QMutexLocker queueLocker(&m_queueMutex);
+    m_isColorsInFlight = false;
+    if (error < 0) {
+        qWarning() << "Error writing data:" << error << "unit:" << m_unit;
+        m_stats.failed++;
+    } else {
+        m_stats.written++;
+        m_stats.lastLatencyUs = latencyUs;
+        m_stats.totalLatencyUs += latencyUs;
+        if (latencyUs > m_stats.maxLatencyUs)
+            m_stats.maxLatencyUs = latencyUs;
+    }
+    queueLocker.unlock();
+
+    m_owner->completeReport(report->frame, error >= 0);
+    report->frame.clear();
+
+    if (error < 0) {
+        m_encoder.reset();
+        emit writeFailed(m_unit);
+        return false;
+    }
+    return true;
+}
+
+bool LightpackUnitWriter::takeReport(Report *report)
+{
+    QMutexLocker locker(&m_queueMutex);
+
+    if (m_queueSize == 0) {
+#ifdef HID_API_ASYNC_WRITE
+        // Under the lock, so enqueue() either sees the flag cleared or its report is taken
+        m_isWriting.store(0);
+#endif
+        return false;
+    }
+
+    Report &head = m_queue[m_queueHead];
+    report->command = head.command;
+    report->sequence = head.sequence;
+    report->enqueuedAtNs = head.enqueuedAtNs;
+    report->frame = head.frame;
+    memcpy(report->data, head.data, kReportSize);
+    head.frame.clear();
+
+    // Taken report is neither in the queue nor written, it still counts
+    m_isColorsInFlight = report->command == CMD_UPDATE_LEDS;
+
+    m_queueHead = (m_queueHead + 1) % kMaxQueueSize;
+    m_queueSize--;
+    return true;
+}
+
+void LightpackUnitWriter::frameWritten(const Report &report)
+{
+    m_writtenFrameEnqueuedAtNs[m_writtenFrames % kWrittenFramesHistory] = report.enqueuedAtNs;
+    m_writtenFrames++;
+
+    m_writtenSequence = report.sequence;
+    m_writtenAtNs = m_clock.nsecsElapsed();
+}
+
+void LightpackUnitWriter::dropReport(int index)
+{
+    m_owner->completeReport(m_queue[(m_queueHead + index) % kMaxQueueSize].frame, true);
+    m_stats.dropped++;
+
+    // Shift the newer reports to close the gap, the queue is short
+    for (int i = index; i < m_queueSize - 1; i++)
+        m_queue[(m_queueHead + i) % kMaxQueueSize] = m_queue[(m_queueHead + i + 1) % kMaxQueueSize];
+    m_queue[(m_queueHead + m_queueSize - 1) % kMaxQueueSize].frame.clear();
+    m_queueSize--;
+}
@@ -0,0 +1,204 @@
+/*
+ * LightpackUnitWriter.hpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSharedPointer>
+
+#include "hidapi.h" /* USB HID API */
+#include "LightpackFrameEncoder.hpp"
+
+class LightpackReportWriter;
+
+/*!
+  Reports queued together, e.g. all units of one setColors() call.
+  The frame is completed when every unit has written (or dropped) its report.
+*/
+struct LightpackFrame
+{
+    LightpackFrame() : pending(1), isFailed(0) { timer.start(); }
+
+    QAtomicInt pending; // reports not completed yet + 1 while the frame is being filled
+    QAtomicInt isFailed;
+    QElapsedTimer timer;
+};
+
+typedef QSharedPointer<LightpackFrame> LightpackFramePtr;
+
+/*!
+  Writes reports of one Lightpack unit, so units of a chain are written
+  concurrently. Owns the HID handle of the unit.
+  With HID_API_ASYNC_WRITE the report is submitted right from enqueue()
+  if the unit is idle, the next one from the completion of the write;
+  one write of the unit is in flight at most, so colors are still merged
+  while the device is busy. Otherwise the unit writes in its own thread.
+  Every report given to enqueue() is completed exactly once in the owner
+  \a LightpackReportWriter: when written, replaced by a newer one, dropped
+  or cleared.
+*/
+class LightpackUnitWriter : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        Stats() : enqueued(0), written(0), merged(0), skipped(0), dropped(0), failed(0), maxDepth(0)
+                , lastLatencyUs(0), maxLatencyUs(0), totalLatencyUs(0)
+                , deviceFramesMerged(0), deviceReportsDropped(0), deviceIsrOverruns(0)
+                , latchLatencies(0), lastLatchLatencyUs(0), maxLatchLatencyUs(0), totalLatchLatencyUs(0) {}
+        quint64 enqueued;
+        quint64 written;
+        quint64 merged;  // colors reports replaced by a newer one before writing
+        quint64 skipped; // colors reports not written because the unit shows them already
+        quint64 dropped; // reports not written because the queue was full or cleared
+        quint64 failed;  // writes failed after a retry
+        int maxDepth;
+        // From enqueue() till hid_write() returned
+        qint64 lastLatencyUs;
+        qint64 maxLatencyUs;
+        qint64 totalLatencyUs;
+        // Telemetry of the device, counters wrap around
+        quint16 deviceFramesMerged;
+        quint16 deviceReportsDropped;
+        quint16 deviceIsrOverruns;
+        // From enqueue() till the device put the colors on the LEDs, 1 ms precision
+        quint64 latchLatencies;
+        qint64 lastLatchLatencyUs;
+        qint64 maxLatchLatencyUs;
+        qint64 totalLatchLatencyUs;
+    };
+
+    static const int kReportSize = 65; // 0-ReportID, 1..65-data
+    static const int kMaxQueueSize = 8;
+
+    LightpackUnitWriter(int unit, hid_device *handle, LightpackReportWriter *owner);
+    virtual ~LightpackUnitWriter();
+
+    // These methods are thread-safe
+    void enqueue(int command, const unsigned char *buffer, const LightpackFramePtr &frame);
+    bool read(unsigned char *buffer, int size);
+    void clear();
+    Stats stats() const;
+    //! Firmware of the unit supports CMD_UPDATE_LEDS_PACKED and others
+    void setCompactCommands(bool isSupported);
+    /*!
+      Reads the telemetry feature report (firmware x.7 and newer) and
+      updates the device counters and the latch latency of the stats.
+    */
+    bool pollTelemetry();
+    /*!
+      Frames up to \a sequence the unit hasn't shown yet, 0 if it shows the
+      last colors written to it. Frame sequence comes with the input reports
+      of firmware x.7 and newer.
+    */
+    int framesInFlight(quint16 sequence);
+
+signals:
+    void writeFailed(int unit);
+
+private slots:
+    void processQueue();
+
+private:
+    struct Report {
+        int command;
+        quint16 sequence; // of CMD_UPDATE_LEDS
+        qint64 enqueuedAtNs;
+        LightpackFramePtr frame;
+        unsigned char data[kReportSize];
+    };
+
+    bool takeReport(Report *report);
+    void dropReport(int index);
+    void frameWritten(const Report &report);
+    int encodeReport(Report *report);
+    void skipReport(Report *report);
+    bool finishReport(Report *report, int error);
+#ifdef HID_API_ASYNC_WRITE
+    void submitNext();
+    static void writeCompleted(void *userData, int result);
+    void beginWrite();
+    void endWrite();
+#endif
+
+private:
+    const int m_unit;
+    LightpackReportWriter *m_owner;
+
+    mutable QMutex m_queueMutex;
+    Report m_queue[kMaxQueueSize];
+    int m_queueHead;
+    int m_queueSize;
+    Stats m_stats;
+    QElapsedTimer m_clock;
+
+    QMutex m_handleMutex;
+    hid_device *m_handle;
+
+    // Colors reports written last, guarded by m_queueMutex: every frame
+    // the device has received is here, telemetry counts frames the same way
+    static const int kWrittenFramesHistory = 16;
+    qint64 m_writtenFrameEnqueuedAtNs[kWrittenFramesHistory];
+    quint64 m_writtenFrames;
+    // The device may or may not have received it, telemetry can't be matched
+    bool m_isColorsInFlight;
+    quint16 m_lastLatchedFrame;
+
+    // Frame sequence of the colors written last and the one shown by the
+    // unit, guarded by m_queueMutex
+    quint16 m_writtenSequence;
+    quint16 m_appliedSequence;
+    qint64 m_writtenAtNs;
+    static const int kAppliedSequenceTimeoutMs = 100;
+    // Input reports buffered by hidapi and the OS, read at once
+    static const int kMaxInputReportsRead = 32;
+
+    // Used by processQueue() only
+    LightpackFrameEncoder m_encoder;
+    QAtomicInt m_isCompactCommands;
+
+    QAtomicInt m_isWakeupPosted;
+
+#ifdef HID_API_ASYNC_WRITE
+    // Set while a report is being submitted or written
+    QAtomicInt m_isWriting;
+    Report m_writing;
+    int m_writingSize;
+    bool m_isWritingRetried;
+
+    // Submitted writes whose completion callback isn't done with this object yet,
+    // callbacks run in hidapi threads. Guarded by m_writeMutex
+    QAtomicInt m_isStopping;
+    int m_pendingWrites;
+    QMutex m_writeMutex;
+    QWaitCondition m_writeCompleted;
+#endif
+};
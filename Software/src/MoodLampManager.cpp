@@ -31,6 +31,9 @@
 
 using namespace SettingsScope;
 
+const int MoodLampManager::kLiquidEffectKeyframes = 8;
+const int MoodLampManager::kMaxKeyframeDurationMs = 0xffff;
+
 int MoodLampManager::m_checkColors[MoodLampManager::ColorsMoodLampCount];
 const QColor MoodLampManager::m_colorsMoodLamp[MoodLampManager::ColorsMoodLampCount] =
 {
@@ -51,6 +54,8 @@ MoodLampManager::MoodLampManager(QObject *parent) : QObject(parent)
     m_currentColor = Settings::getMoodLampColor();
 
     m_isSendDataOnlyIfColorsChanged = Settings::isSendDataOnlyIfColorsChanges();
+    m_isDeviceEffectsSupported = false;
+    m_isEffectPlaying = false;
 
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(updateColors()));
 }
@@ -82,6 +87,7 @@ void MoodLampManager::setCurrentColor(QColor color)
     {
         fillColors(color.rgb());
         emit updateLedsColors(m_colors);
+        m_isEffectPlaying = false;
     }
 }
 
@@ -90,7 +96,7 @@ void MoodLampManager::setLiquidMode(bool state)
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << state;
     m_isLiquidMode = state;
     if (m_isLiquidMode && m_isMoodLampEnabled)
-        m_timer.start();
+        updateColors();
     else {
         m_timer.stop();
         if (m_isMoodLampEnabled)
@@ -103,6 +109,23 @@ void MoodLampManager::setLiquidModeSpeed(int value)
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
     m_liquidModeSpeed = value;
     m_delay = generateDelay(m_liquidModeSpeed);
+
+    // Keyframes on the device have the old speed
+    if (m_isEffectPlaying && m_isMoodLampEnabled)
+        playLiquidEffect();
+}
+
+void MoodLampManager::setDeviceEffectsSupported(bool isSupported)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << isSupported;
+
+    if (m_isDeviceEffectsSupported == isSupported)
+        return;
+
+    m_isDeviceEffectsSupported = isSupported;
+
+    if (m_isMoodLampEnabled && m_isLiquidMode)
+        updateColors();
 }
 
 void MoodLampManager::setSendDataOnlyIfColorsChanged(bool state)
@@ -147,6 +170,12 @@ void MoodLampManager::updateColors()
 
     QRgb rgb;
 
+    if (m_isLiquidMode && m_isMoodLampEnabled && isEffectPlayable())
+    {
+        playLiquidEffect();
+        return;
+    }
+
     if (m_isLiquidMode)
     {
         static int red   = 0;
@@ -180,10 +209,11 @@ void MoodLampManager::updateColors()
         rgb = m_currentColor.rgb();
     }
 
-    if (m_rgbSaved != rgb || m_isSendDataOnlyIfColorsChanged == false)
+    if (m_rgbSaved != rgb || m_isSendDataOnlyIfColorsChanged == false || m_isEffectPlaying)
     {
         fillColors(rgb);
         emit updateLedsColors(m_colors);
+        m_isEffectPlaying = false;
     }
 
     if (m_isMoodLampEnabled && m_isLiquidMode)
@@ -194,6 +224,53 @@ void MoodLampManager::updateColors()
     m_rgbSaved = rgb;
 }
 
+bool MoodLampManager::isEffectPlayable() const
+{
+    if (m_isDeviceEffectsSupported == false)
+        return false;
+
+    // Effect fills all LEDs, disabled ones have to stay black
+    for (int i = 0; i < m_colors.size(); i++)
+    {
+        if (Settings::isLedEnabled(i) == false)
+            return false;
+    }
+    return true;
+}
+
+/*!
+  Uploads the next colors of the liquid mode as keyframes. Transitions take
+  as long as the channel stepping of updateColors() would, the device plays
+  them and the timer comes back after the last one.
+*/
+void MoodLampManager::playLiquidEffect()
+{
+    LedEffect effect;
+    QColor color = QColor(m_rgbSaved);
+
+    for (int i = 0; i < kLiquidEffectKeyframes; i++)
+    {
+        const QColor colorNew = generateColor();
+        const int steps = qMax(qAbs(colorNew.red() - color.red()),
+                               qMax(qAbs(colorNew.green() - color.green()), qAbs(colorNew.blue() - color.blue())));
+        const int durationMs = qMin(steps * generateDelay(m_liquidModeSpeed), kMaxKeyframeDurationMs);
+
+        effect.keyframes << LedEffect::Keyframe(colorNew.rgb(), durationMs);
+        color = colorNew;
+    }
+
+    // Device starts over if the timer is late
+    effect.isLoop = true;
+
+    DEBUG_MID_LEVEL << Q_FUNC_INFO << effect.durationMs();
+
+    emit updateLedsEffect(effect);
+
+    m_isEffectPlaying = true;
+    m_rgbSaved = color.rgb();
+    m_timer.start(qMax(effect.durationMs(), 1));
+}
+
 int MoodLampManager::generateDelay(int speed)
 {
     return 1000 / (speed + PrismatikMath::rand(25) + 1);
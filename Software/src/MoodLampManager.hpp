@@ -28,6 +28,7 @@
 #include <QObject>
 #include <QColor>
 #include <QTimer>
+#include "LedEffect.hpp"
 
 class MoodLampManager : public QObject
 {
@@ -37,6 +38,7 @@ public:
 
 signals:
     void updateLedsColors(const QList<QRgb> & colors);
+    void updateLedsEffect(const LedEffect & effect);
 
 public:
     void start(bool isMoodLampEnabled);
@@ -52,6 +54,7 @@ public slots:
     void settingsProfileChanged(const QString &profileName);
     void setNumberOfLeds(int value);
     void setCurrentColor(QColor color);
+    void setDeviceEffectsSupported(bool isSupported);
 
 private slots:
     void updateColors();
@@ -61,6 +64,8 @@ private:
     QColor generateColor();
     void initColors(int numberOfLeds);
     void fillColors(QRgb rgb);
+    bool isEffectPlayable() const;
+    void playLiquidEffect();
 
 private:
     QList<QRgb> m_colors;
@@ -72,9 +77,15 @@ private:
     bool   m_isLiquidMode;
     int    m_liquidModeSpeed;
     bool   m_isSendDataOnlyIfColorsChanged;
+    bool   m_isDeviceEffectsSupported;
+    bool   m_isEffectPlaying;
 
     QRgb m_rgbSaved;
 
+    // Liquid mode is played by the device, the timer uploads the next keyframes
+    static const int kLiquidEffectKeyframes;
+    static const int kMaxKeyframeDurationMs;
+
     static const int ColorsMoodLampCount = 15;
     static int m_checkColors[ColorsMoodLampCount];
     static const QColor m_colorsMoodLamp[ColorsMoodLampCount];
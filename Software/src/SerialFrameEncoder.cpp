@@ -0,0 +1,128 @@
+/*
+ * SerialFrameEncoder.cpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SerialFrameEncoder.hpp"
+
+SerialFrameEncoder::SerialFrameEncoder()
+    : m_ledsCount(0)
+    , m_maxChannelValue(255)
+{
+    m_order[0] = 0;
+    m_order[1] = 1;
+    m_order[2] = 2;
+}
+
+void SerialFrameEncoder::setHeader(const QByteArray &header)
+{
+    if (header.size() == m_header.size()) {
+        // Usually only the LEDs count in the header changes, keep the buffer
+        m_header = header;
+        memcpy(m_frame.data(), m_header.constData(), m_header.size());
+        return;
+    }
+
+    m_header = header;
+    const int ledsCount = m_ledsCount;
+    m_ledsCount = -1;
+    resize(ledsCount);
+}
+
+bool SerialFrameEncoder::setColorSequence(const QString &colorSequence)
+{
+    bool ok = colorSequence.size() == 3;
+    int order[3] = {0, 1, 2};
+    int usedChannels = 0;
+
+    for (int i = 0; ok && i < 3; i++) {
+        switch (colorSequence[i].toUpper().toLatin1()) {
+        case 'R': order[i] = 0; break;
+        case 'G': order[i] = 1; break;
+        case 'B': order[i] = 2; break;
+        default: ok = false; break;
+        }
+        usedChannels |= 1 << order[i];
+    }
+
+    if (!ok || usedChannels != 0x7) {
+        order[0] = 0;
+        order[1] = 1;
+        order[2] = 2;
+        ok = false;
+    }
+
+    m_order[0] = order[0];
+    m_order[1] = order[1];
+    m_order[2] = order[2];
+
+    return ok;
+}
+
+const QByteArray & SerialFrameEncoder::encode(const QList<StructRgb> &colors)
+{
+    resize(colors.count());
+
+    unsigned char *out = payload();
+    const int order0 = m_order[0];
+    const int order1 = m_order[1];
+    const int order2 = m_order[2];
+    const unsigned maxValue = m_maxChannelValue;
+
+    for (int i = 0; i < m_ledsCount; i++) {
+        const StructRgb &color = colors[i];
+        unsigned channels[3] = { color.r >> 4, color.g >> 4, color.b >> 4 };
+
+        out[0] = qMin(channels[order0], maxValue);
+        out[1] = qMin(channels[order1], maxValue);
+        out[2] = qMin(channels[order2], maxValue);
+        out += 3;
+    }
+
+    return m_frame;
+}
+
+const QByteArray & SerialFrameEncoder::encodeBlack(int ledsCount)
+{
+    resize(ledsCount);
+    memset(payload(), 0, m_ledsCount * 3);
+
+    return m_frame;
+}
+
+void SerialFrameEncoder::resize(int ledsCount)
+{
+    if (ledsCount == m_ledsCount)
+        return;
+
+    m_ledsCount = qMax(ledsCount, 0);
+    m_frame.resize(m_header.size() + m_ledsCount * 3);
+    memcpy(m_frame.data(), m_header.constData(), m_header.size());
+}
+
+unsigned char * SerialFrameEncoder::payload()
+{
+    return reinterpret_cast<unsigned char *>(m_frame.data()) + m_header.size();
+}
@@ -0,0 +1,80 @@
+/*
+ * SerialFrameEncoder.hpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "colorspace_types.h"
+
+/*!
+  Builds frames of serial LED devices (Adalight, Ardulight): the header
+  followed by 8-bit channels of every LED in the configured color order.
+
+  The color order is parsed once into a permutation table and the frame
+  buffer is reused, so encoding a frame of the same size doesn't allocate.
+*/
+class SerialFrameEncoder
+{
+public:
+    SerialFrameEncoder();
+
+    /*!
+      Sets the bytes preceding colors in every frame.
+    */
+    void setHeader(const QByteArray &header);
+    /*!
+      \param colorSequence one of "RGB", "RBG", "GRB", "GBR", "BRG", "BGR"
+      \return false if the sequence isn't recognized, RGB is used then
+    */
+    bool setColorSequence(const QString &colorSequence);
+    /*!
+      Channels are clamped to this value, e.g. to keep the sync byte out of the colors.
+    */
+    void setMaxChannelValue(unsigned char value) { m_maxChannelValue = value; }
+
+    /*!
+      \param colors 12-bit colors
+      \return the frame, valid until the next call of any non-const method
+    */
+    const QByteArray & encode(const QList<StructRgb> &colors);
+    const QByteArray & encodeBlack(int ledsCount);
+
+    int ledsCount() const { return m_ledsCount; }
+
+private:
+    void resize(int ledsCount);
+    unsigned char * payload();
+
+private:
+    QByteArray m_frame;
+    QByteArray m_header;
+    int m_ledsCount;
+    int m_order[3]; // index of the channel (0 - red, 1 - green, 2 - blue) sent at each position
+    unsigned m_maxChannelValue;
+};
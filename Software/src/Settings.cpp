@@ -72,6 +72,7 @@ static const QString IsKeepLightsOnAfterLock = "IsKeepLightsOnAfterLock";
 static const QString IsPingDeviceEverySecond = "IsPingDeviceEverySecond";
 static const QString IsUpdateFirmwareMessageShown = "IsUpdateFirmwareMessageShown";
 static const QString ConnectedDevice = "ConnectedDevice";
+static const QString AdditionalDevices = "AdditionalDevices";
 static const QString SupportedDevices = "SupportedDevices";
 static const QString LastReadUpdateId = "LastReadUpdateId";
 
@@ -88,10 +89,14 @@ static const QString IsEnabled = "API/IsEnabled";
 static const QString ListenOnlyOnLoInterface = "API/ListenOnlyOnLoInterface";
 static const QString Port = "API/Port";
 static const QString AuthKey = "API/AuthKey";
+static const QString UdpIsEnabled = "API/UdpIsEnabled";
+static const QString UdpPort = "API/UdpPort";
+static const QString UdpMulticastGroup = "API/UdpMulticastGroup";
 }
 namespace Adalight
 {
 static const QString NumberOfLeds = "Adalight/NumberOfLeds";
+static const QString FirstLed = "Adalight/FirstLed";
 static const QString ColorSequence = "Adalight/ColorSequence";
 static const QString Port = "Adalight/SerialPort";
 static const QString BaudRate = "Adalight/BaudRate";
@@ -99,6 +104,7 @@ static const QString BaudRate = "Adalight/BaudRate";
 namespace Ardulight
 {
 static const QString NumberOfLeds = "Ardulight/NumberOfLeds";
+static const QString FirstLed = "Ardulight/FirstLed";
 static const QString ColorSequence = "Ardulight/ColorSequence";
 static const QString Port = "Ardulight/SerialPort";
 static const QString BaudRate = "Ardulight/BaudRate";
@@ -106,14 +112,17 @@ static const QString BaudRate = "Ardulight/BaudRate";
 namespace AlienFx
 {
 static const QString NumberOfLeds = "AlienFx/NumberOfLeds";
+static const QString FirstLed = "AlienFx/FirstLed";
 }
 namespace Lightpack
 {
 static const QString NumberOfLeds = "Lightpack/NumberOfLeds";
+static const QString FirstLed = "Lightpack/FirstLed";
 }
 namespace Virtual
 {
 static const QString NumberOfLeds = "Virtual/NumberOfLeds";
+static const QString FirstLed = "Virtual/FirstLed";
 }
 } /*Key*/
 
@@ -145,7 +154,9 @@ namespace Grab
 {
 static const QString Grabber = "Grab/Grabber";
 static const QString IsAvgColorsEnabled = "Grab/IsAvgColorsEnabled";
+static const QString IsLetterboxDetectionEnabled = "Grab/IsLetterboxDetectionEnabled";
 static const QString IsSendDataOnlyIfColorsChanges = "Grab/IsSendDataOnlyIfColorsChanges";
+static const QString ChangeThreshold = "Grab/ChangeThreshold";
 static const QString Slowdown = "Grab/Slowdown";
 static const QString LuminosityThreshold = "Grab/LuminosityThreshold";
 static const QString IsMinimumLuminosityEnabled = "Grab/IsMinimumLuminosityEnabled";
@@ -178,6 +189,7 @@ static const QString Position = "Position";
 static const QString CoefRed = "CoefRed";
 static const QString CoefGreen = "CoefGreen";
 static const QString CoefBlue = "CoefBlue";
+static const QString ReductionMode = "ReductionMode";
 }
 } /*Key*/
 
@@ -215,6 +227,7 @@ QString Settings::m_applicationDirPath = "";
 
 QMap<SupportedDevices::DeviceType, QString> Settings::m_devicesTypeToNameMap;
 QMap<SupportedDevices::DeviceType, QString> Settings::m_devicesTypeToKeyNumberOfLedsMap;
+QMap<SupportedDevices::DeviceType, QString> Settings::m_devicesTypeToKeyFirstLedMap;
 
 Settings::Settings() : QObject(NULL) {
     qRegisterMetaType<Grab::GrabberType>("Grab::GrabberType");
@@ -254,10 +267,14 @@ bool Settings::Initialize( const QString & applicationDirPath, bool isDebugLevel
     setNewOptionMain(Main::Key::IsPingDeviceEverySecond,Main::IsPingDeviceEverySecond);
     setNewOptionMain(Main::Key::IsUpdateFirmwareMessageShown, Main::IsUpdateFirmwareMessageShown);
     setNewOptionMain(Main::Key::ConnectedDevice,        Main::ConnectedDeviceDefault);
+    setNewOptionMain(Main::Key::AdditionalDevices,      Main::AdditionalDevicesDefault);
     setNewOptionMain(Main::Key::SupportedDevices,       Main::SupportedDevices, true /* always rewrite this information to main config */);
     setNewOptionMain(Main::Key::Api::IsEnabled,         Main::Api::IsEnabledDefault);
     setNewOptionMain(Main::Key::Api::ListenOnlyOnLoInterface, Main::Api::ListenOnlyOnLoInterfaceDefault);
     setNewOptionMain(Main::Key::Api::Port,              Main::Api::PortDefault);
+    setNewOptionMain(Main::Key::Api::UdpIsEnabled,      Main::Api::UdpIsEnabledDefault);
+    setNewOptionMain(Main::Key::Api::UdpPort,           Main::Api::UdpPortDefault);
+    setNewOptionMain(Main::Key::Api::UdpMulticastGroup, Main::Api::UdpMulticastGroupDefault);
     // Generation AuthKey as new UUID
     setNewOptionMain(Main::Key::Api::AuthKey,           Main::Api::AuthKey);
 
@@ -275,6 +292,12 @@ bool Settings::Initialize( const QString & applicationDirPath, bool isDebugLevel
     setNewOptionMain(Main::Key::AlienFx::NumberOfLeds,      Main::AlienFx::NumberOfLedsDefault);
     setNewOptionMain(Main::Key::Lightpack::NumberOfLeds,    Main::Lightpack::NumberOfLedsDefault);
     setNewOptionMain(Main::Key::Virtual::NumberOfLeds,      Main::Virtual::NumberOfLedsDefault);
+
+    setNewOptionMain(Main::Key::Adalight::FirstLed,         Main::FirstLedDefault);
+    setNewOptionMain(Main::Key::Ardulight::FirstLed,        Main::FirstLedDefault);
+    setNewOptionMain(Main::Key::AlienFx::FirstLed,          Main::FirstLedDefault);
+    setNewOptionMain(Main::Key::Lightpack::FirstLed,        Main::FirstLedDefault);
+    setNewOptionMain(Main::Key::Virtual::FirstLed,          Main::FirstLedDefault);
     setNewOptionMain(Main::Key::LastReadUpdateId,           Main::LastReadUpdateId);
 
     if (isDebugLevelObtainedFromCmdArgs == false)
@@ -581,6 +604,42 @@ void Settings::setApiPort(int apiPort)
     m_this->apiServerSettingsChanged();
 }
 
+bool Settings::isApiUdpEnabled()
+{
+    return valueMain(Main::Key::Api::UdpIsEnabled).toBool();
+}
+
+void Settings::setIsApiUdpEnabled(bool isEnabled)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    setValueMain(Main::Key::Api::UdpIsEnabled, isEnabled);
+    m_this->apiServerSettingsChanged();
+}
+
+int Settings::getApiUdpPort()
+{
+    return valueMain(Main::Key::Api::UdpPort).toInt();
+}
+
+void Settings::setApiUdpPort(int udpPort)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    setValueMain(Main::Key::Api::UdpPort, udpPort);
+    m_this->apiServerSettingsChanged();
+}
+
+QString Settings::getApiUdpMulticastGroup()
+{
+    return valueMain(Main::Key::Api::UdpMulticastGroup).toString();
+}
+
+void Settings::setApiUdpMulticastGroup(const QString & group)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    setValueMain(Main::Key::Api::UdpMulticastGroup, group);
+    m_this->apiServerSettingsChanged();
+}
+
 QString Settings::getApiAuthKey()
 {
     QString apikey = valueMain(Main::Key::Api::AuthKey).toString();
@@ -706,6 +765,45 @@ void Settings::setConnectedDeviceName(const QString & deviceName)
     m_this->connectedDeviceChanged(m_devicesTypeToNameMap.key(deviceName));
 }
 
+QList<SupportedDevices::DeviceType> Settings::getAdditionalDevices()
+{
+    QList<SupportedDevices::DeviceType> devices;
+    const SupportedDevices::DeviceType connectedDevice = getConnectedDevice();
+    const QStringList names = valueMain(Main::Key::AdditionalDevices).toString().split(',', QString::SkipEmptyParts);
+
+    for (int i = 0; i < names.size(); i++)
+    {
+        const QString deviceName = names[i].trimmed();
+
+        if (m_devicesTypeToNameMap.values().contains(deviceName) == false)
+        {
+            qWarning() << Q_FUNC_INFO << Main::Key::AdditionalDevices << "contains unsupported device" << deviceName << ", skip it";
+            continue;
+        }
+
+        const SupportedDevices::DeviceType device = m_devicesTypeToNameMap.key(deviceName);
+        if (device != connectedDevice && devices.contains(device) == false)
+            devices.append(device);
+    }
+
+    return devices;
+}
+
+void Settings::setAdditionalDevices(const QList<SupportedDevices::DeviceType> & devices)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    QStringList names;
+
+    for (int i = 0; i < devices.size(); i++)
+    {
+        if (m_devicesTypeToNameMap.contains(devices[i]))
+            names.append(m_devicesTypeToNameMap.value(devices[i]));
+    }
+
+    setValueMain(Main::Key::AdditionalDevices, names.join(","));
+    m_this->activeDevicesChanged();
+}
+
 QStringList Settings::getSupportedDevices()
 {
     return Main::SupportedDevices.split(',');
@@ -867,6 +965,35 @@ int Settings::getNumberOfLeds(SupportedDevices::DeviceType device)
     return valueMain(key).toInt();
 }
 
+void Settings::setFirstLed(SupportedDevices::DeviceType device, int firstLed)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << device << firstLed;
+
+    QString key = m_devicesTypeToKeyFirstLedMap.value(device);
+
+    if (key == "")
+    {
+        qCritical() << Q_FUNC_INFO << "Device type not recognized, device ==" << device << "firstLed ==" << firstLed;
+        return;
+    }
+
+    setValueMain(key, qBound(0, firstLed, MaximumNumberOfLeds::AbsoluteMaximum - 1));
+    m_this->activeDevicesChanged();
+}
+
+int Settings::getFirstLed(SupportedDevices::DeviceType device)
+{
+    QString key = m_devicesTypeToKeyFirstLedMap.value(device);
+
+    if (key == "")
+    {
+        qCritical() << Q_FUNC_INFO << "Device type not recognized, device ==" << device;
+        return Main::FirstLedDefault;
+    }
+
+    return qBound(0, valueMain(key).toInt(), MaximumNumberOfLeds::AbsoluteMaximum - 1);
+}
+
 void Settings::setColorSequence(SupportedDevices::DeviceType device, QString colorSequence)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << device << colorSequence;
@@ -916,6 +1043,20 @@ void Settings::setGrabSlowdown(int value)
     m_this->grabSlowdownChanged(value);
 }
 
+int Settings::getGrabChangeThreshold()
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    return getValidGrabChangeThreshold(value(Profile::Key::Grab::ChangeThreshold).toInt());
+}
+
+void Settings::setGrabChangeThreshold(int value)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    value = getValidGrabChangeThreshold(value);
+    setValue(Profile::Key::Grab::ChangeThreshold, value);
+    m_this->grabChangeThresholdChanged(value);
+}
+
 bool Settings::isBacklightEnabled()
 {
     return value(Profile::Key::IsBacklightEnabled).toBool();
@@ -940,6 +1081,18 @@ void Settings::setGrabAvgColorsEnabled(bool isEnabled)
     m_this->grabAvgColorsEnabledChanged(isEnabled);
 }
 
+bool Settings::isGrabLetterboxDetectionEnabled()
+{
+    return value(Profile::Key::Grab::IsLetterboxDetectionEnabled).toBool();
+}
+
+void Settings::setGrabLetterboxDetectionEnabled(bool isEnabled)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    setValue(Profile::Key::Grab::IsLetterboxDetectionEnabled, isEnabled);
+    m_this->grabLetterboxDetectionEnabledChanged(isEnabled);
+}
+
 bool Settings::isSendDataOnlyIfColorsChanges()
 {
     return value(Profile::Key::Grab::IsSendDataOnlyIfColorsChanges).toBool();
@@ -1309,6 +1462,21 @@ void Settings::setLedEnabled(int ledIndex, bool isEnabled)
     m_this->ledEnabledChanged(ledIndex, isEnabled);
 }
 
+Grab::Calculations::ReductionMode Settings::getLedReductionMode(int ledIndex)
+{
+    bool ok = false;
+    int reductionMode = value(Profile::Key::Led::Prefix + QString::number(ledIndex + 1) + "/" + Profile::Key::Led::ReductionMode).toInt(&ok);
+    if (!ok || reductionMode < 0 || reductionMode >= Grab::Calculations::ReductionModesCount)
+        reductionMode = Profile::Led::ReductionModeDefault;
+    return static_cast<Grab::Calculations::ReductionMode>(reductionMode);
+}
+
+void Settings::setLedReductionMode(int ledIndex, Grab::Calculations::ReductionMode reductionMode)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO;
+    setValue(Profile::Key::Led::Prefix + QString::number(ledIndex + 1) + "/" + Profile::Key::Led::ReductionMode, (int)reductionMode);
+}
+
 int Settings::getValidDeviceRefreshDelay(int value)
 {
     if (value < Profile::Device::RefreshDelayMin)
@@ -1363,6 +1531,15 @@ int Settings::getValidGrabSlowdown(int value)
     return value;
 }
 
+int Settings::getValidGrabChangeThreshold(int value)
+{
+    if (value < Profile::Grab::ChangeThresholdMin)
+        value = Profile::Grab::ChangeThresholdMin;
+    else if (value > Profile::Grab::ChangeThresholdMax)
+        value = Profile::Grab::ChangeThresholdMax;
+    return value;
+}
+
 int Settings::getValidMoodLampSpeed(int value)
 {
     if (value < Profile::MoodLamp::SpeedMin)
@@ -1448,7 +1625,9 @@ void Settings::initCurrentProfile(bool isResetDefault)
     // [Grab]
     setNewOption(Profile::Key::Grab::Grabber,       Profile::Grab::GrabberDefaultString, isResetDefault);
     setNewOption(Profile::Key::Grab::IsAvgColorsEnabled, Profile::Grab::IsAvgColorsEnabledDefault, isResetDefault);
+    setNewOption(Profile::Key::Grab::IsLetterboxDetectionEnabled, Profile::Grab::IsLetterboxDetectionEnabledDefault, isResetDefault);
     setNewOption(Profile::Key::Grab::IsSendDataOnlyIfColorsChanges, Profile::Grab::IsSendDataOnlyIfColorsChangesDefault, isResetDefault);
+    setNewOption(Profile::Key::Grab::ChangeThreshold, Profile::Grab::ChangeThresholdDefault, isResetDefault);
     setNewOption(Profile::Key::Grab::Slowdown,      Profile::Grab::SlowdownDefault, isResetDefault);
     setNewOption(Profile::Key::Grab::LuminosityThreshold, Profile::Grab::MinimumLevelOfSensitivityDefault, isResetDefault);
     setNewOption(Profile::Key::Grab::IsMinimumLuminosityEnabled, Profile::Grab::IsMinimumLuminosityEnabledDefault, isResetDefault);
@@ -1484,6 +1663,8 @@ void Settings::initCurrentProfile(bool isResetDefault)
                      Profile::Led::CoefDefault, isResetDefault);
         setNewOption(Profile::Key::Led::Prefix + QString::number(i + 1) + "/" + Profile::Key::Led::CoefBlue,
                      Profile::Led::CoefDefault, isResetDefault);
+        setNewOption(Profile::Key::Led::Prefix + QString::number(i + 1) + "/" + Profile::Key::Led::ReductionMode,
+                     Profile::Led::ReductionModeDefault, isResetDefault);
     }
 
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << "led";
@@ -1595,9 +1776,15 @@ void Settings::initDevicesMap()
     m_devicesTypeToKeyNumberOfLedsMap[SupportedDevices::DeviceTypeLightpack] = Main::Key::Lightpack::NumberOfLeds;
     m_devicesTypeToKeyNumberOfLedsMap[SupportedDevices::DeviceTypeVirtual]   = Main::Key::Virtual::NumberOfLeds;
 
+    m_devicesTypeToKeyFirstLedMap[SupportedDevices::DeviceTypeAdalight]  = Main::Key::Adalight::FirstLed;
+    m_devicesTypeToKeyFirstLedMap[SupportedDevices::DeviceTypeArdulight] = Main::Key::Ardulight::FirstLed;
+    m_devicesTypeToKeyFirstLedMap[SupportedDevices::DeviceTypeLightpack] = Main::Key::Lightpack::FirstLed;
+    m_devicesTypeToKeyFirstLedMap[SupportedDevices::DeviceTypeVirtual]   = Main::Key::Virtual::FirstLed;
+
 #ifdef ALIEN_FX_SUPPORTED
     m_devicesTypeToNameMap[SupportedDevices::DeviceTypeAlienFx]   = Main::Value::ConnectedDevice::AlienFxDevice;
     m_devicesTypeToKeyNumberOfLedsMap[SupportedDevices::DeviceTypeAlienFx]   = Main::Key::AlienFx::NumberOfLeds;
+    m_devicesTypeToKeyFirstLedMap[SupportedDevices::DeviceTypeAlienFx]       = Main::Key::AlienFx::FirstLed;
 #endif
 }
 
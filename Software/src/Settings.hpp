@@ -100,6 +100,12 @@ public:
     static void setListenOnlyOnLoInterface(bool localOnly);
     static int getApiPort();
     static void setApiPort(int apiPort);
+    static bool isApiUdpEnabled();
+    static void setIsApiUdpEnabled(bool isEnabled);
+    static int getApiUdpPort();
+    static void setApiUdpPort(int udpPort);
+    static QString getApiUdpMulticastGroup();
+    static void setApiUdpMulticastGroup(const QString & group);
     static QString getApiAuthKey();
     static void setApiKey(const QString & apiKey);
     static bool isApiAuthEnabled();
@@ -118,6 +124,9 @@ public:
     static void setConnectedDevice(SupportedDevices::DeviceType device);
     static QString getConnectedDeviceName();
     static void setConnectedDeviceName(const QString & deviceName);
+    // Devices driven together with the connected one
+    static QList<SupportedDevices::DeviceType> getAdditionalDevices();
+    static void setAdditionalDevices(const QList<SupportedDevices::DeviceType> & devices);
     static QStringList getSupportedDevices();
     static QKeySequence getHotkey(const QString &actionName);
     static void setHotkey(const QString &actionName, const QKeySequence &keySequence);
@@ -134,6 +143,9 @@ public:
     // [Adalight | Ardulight | Lightpack | ... | Virtual]
     static void setNumberOfLeds(SupportedDevices::DeviceType device, int numberOfLeds);
     static int getNumberOfLeds(SupportedDevices::DeviceType device);
+    // Index of the grabbed LED shown by the first LED of the additional device
+    static void setFirstLed(SupportedDevices::DeviceType device, int firstLed);
+    static int getFirstLed(SupportedDevices::DeviceType device);
 
     static void setColorSequence(SupportedDevices::DeviceType device, QString colorSequence);
     static QString getColorSequence(SupportedDevices::DeviceType device);
@@ -141,10 +153,14 @@ public:
     // Profile
     static int getGrabSlowdown();
     static void setGrabSlowdown(int value);
+    static int getGrabChangeThreshold();
+    static void setGrabChangeThreshold(int value);
     static bool isBacklightEnabled();
     static void setIsBacklightEnabled(bool isEnabled);
     static bool isGrabAvgColorsEnabled();
     static void setGrabAvgColorsEnabled(bool isEnabled);
+    static bool isGrabLetterboxDetectionEnabled();
+    static void setGrabLetterboxDetectionEnabled(bool isEnabled);
     static bool isSendDataOnlyIfColorsChanges();
     static void setSendDataOnlyIfColorsChanges(bool isEnabled);
     static int getLuminosityThreshold();
@@ -196,6 +212,8 @@ public:
     static void setLedPosition(int ledIndex, QPoint position);
     static bool isLedEnabled(int ledIndex);
     static void setLedEnabled(int ledIndex, bool isEnabled);
+    static Grab::Calculations::ReductionMode getLedReductionMode(int ledIndex);
+    static void setLedReductionMode(int ledIndex, Grab::Calculations::ReductionMode reductionMode);
 
     static uint getLastReadUpdateId();
     static void setLastReadUpdateId(const uint updateId);
@@ -207,6 +225,7 @@ private:
     static int getValidDeviceColorDepth(int value);
     static double getValidDeviceGamma(double value);
     static int getValidGrabSlowdown(int value);
+    static int getValidGrabChangeThreshold(int value);
     static int getValidMoodLampSpeed(int value);
     static int getValidLuminosityThreshold(int value);
     static void setValidLedCoef(int ledIndex, const QString & keyCoef, double coef);
@@ -246,6 +265,7 @@ signals:
     void debugLevelChanged(int);
     void updateFirmwareMessageShownChanged(bool isShown);
     void connectedDeviceChanged(const SupportedDevices::DeviceType device);
+    void activeDevicesChanged();
     void hotkeyChanged(const QString &actionName, const QKeySequence & newKeySequence, const QKeySequence &oldKeySequence);
     void adalightSerialPortNameChanged(const QString & port);
     void adalightSerialPortBaudRateChanged(const QString & baud);
@@ -258,6 +278,8 @@ signals:
     void grabSlowdownChanged(int value);
     void backlightEnabledChanged(bool isEnabled);
     void grabAvgColorsEnabledChanged(bool isEnabled);
+    void grabChangeThresholdChanged(int value);
+    void grabLetterboxDetectionEnabledChanged(bool isEnabled);
     void sendDataOnlyIfColorsChangesChanged(bool isEnabled);
     void luminosityThresholdChanged(int value);
     void minimumLuminosityEnabledChanged(bool value);
@@ -288,5 +310,6 @@ private:
     static Settings *m_this;
     static QMap<SupportedDevices::DeviceType, QString> m_devicesTypeToNameMap;
     static QMap<SupportedDevices::DeviceType, QString> m_devicesTypeToKeyNumberOfLedsMap;
+    static QMap<SupportedDevices::DeviceType, QString> m_devicesTypeToKeyFirstLedMap;
 };
 } /*SettingsScope*/
@@ -30,6 +30,7 @@
 #include "debug.h"
 #include "../common/defs.h"
 #include "enums.hpp"
+#include "calculations.hpp"
 
 #ifdef ALIEN_FX_SUPPORTED
 #   define SUPPORTED_DEVICES            "Lightpack,AlienFx,Adalight,Ardulight,Virtual"
@@ -78,6 +79,8 @@ static const bool IsKeepLightsOnAfterLock = true;
 static const bool IsPingDeviceEverySecond = true;
 static const bool IsUpdateFirmwareMessageShown = false;
 static const QString ConnectedDeviceDefault = "Lightpack";
+static const QString AdditionalDevicesDefault = ""; /* comma separated values! */
+static const int FirstLedDefault = 0;
 static const QString SupportedDevices = SUPPORTED_DEVICES; /* comma separated values! */
 static const uint LastReadUpdateId = LASTREAD_UPDATE_ID_DEFAULT;
 
@@ -93,6 +96,9 @@ namespace Api
 static const bool IsEnabledDefault = true;
 static const bool ListenOnlyOnLoInterfaceDefault = true;
 static const int PortDefault = 3636;
+static const bool UdpIsEnabledDefault = false;
+static const int UdpPortDefault = 3637;
+static const QString UdpMulticastGroupDefault = "";
 static const QString AuthKey = "";
 // See ApiKey generation in Settings initialization
 }
@@ -137,7 +143,11 @@ namespace Grab
 static const ::Grab::GrabberType GrabberDefault = GRABMODE_DEFAULT;
 static const QString GrabberDefaultString = GRABMODE_DEFAULT_STR;
 static const bool IsAvgColorsEnabledDefault = false;
+static const bool IsLetterboxDetectionEnabledDefault = false;
 static const bool IsSendDataOnlyIfColorsChangesDefault = true;
+static const int ChangeThresholdMin = 0;
+static const int ChangeThresholdDefault = 0;
+static const int ChangeThresholdMax = 32;
 static const bool IsMinimumLuminosityEnabledDefault = true;
 static const int SlowdownMin = 1;
 static const int SlowdownDefault = 50;
@@ -186,6 +196,7 @@ static const double CoefMin = 0.0;
 static const double CoefDefault = 1.0;
 static const double CoefMax = 1.0;
 static const QSize SizeDefault = QSize(150, 150);
+static const int ReductionModeDefault = ::Grab::Calculations::ReductionModeMean;
 }
 } /*Profile*/
 
@@ -176,10 +176,12 @@ void SettingsWindow::connectSignalsSlots()
 
     connect(ui->listWidget, SIGNAL(currentRowChanged(int)), this, SLOT(changePage(int)));
     connect(ui->spinBox_GrabSlowdown, SIGNAL(valueChanged(int)), this, SLOT(onGrabSlowdown_valueChanged(int)));
+    connect(ui->spinBox_GrabChangeThreshold, SIGNAL(valueChanged(int)), this, SLOT(onGrabChangeThreshold_valueChanged(int)));
     connect(ui->spinBox_LuminosityThreshold, SIGNAL(valueChanged(int)), this, SLOT(onLuminosityThreshold_valueChanged(int)));
     connect(ui->radioButton_MinimumLuminosity, SIGNAL(toggled(bool)), this, SLOT(onMinimumLumosity_toggled(bool)));
     connect(ui->radioButton_LuminosityDeadZone, SIGNAL(toggled(bool)), this, SLOT(onMinimumLumosity_toggled(bool)));
     connect(ui->checkBox_GrabIsAvgColors, SIGNAL(toggled(bool)), this, SLOT(onGrabIsAvgColors_toggled(bool)));
+    connect(ui->checkBox_GrabIsLetterboxDetection, SIGNAL(toggled(bool)), this, SLOT(onGrabIsLetterboxDetection_toggled(bool)));
 
     connect(ui->radioButton_GrabWidgetsDontShow, SIGNAL(toggled(bool)), this, SLOT( onDontShowLedWidgets_Toggled(bool)));
     connect(ui->radioButton_Colored, SIGNAL(toggled(bool)), this, SLOT(onSetColoredLedWidgets(bool)));
@@ -1063,6 +1065,13 @@ void SettingsWindow::onGrabSlowdown_valueChanged(int value)
     Settings::setGrabSlowdown(value);
 }
 
+void SettingsWindow::onGrabChangeThreshold_valueChanged(int value)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
+
+    Settings::setGrabChangeThreshold(value);
+}
+
 void SettingsWindow::onLuminosityThreshold_valueChanged(int value)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
@@ -1084,6 +1093,13 @@ void SettingsWindow::onGrabIsAvgColors_toggled(bool state)
     Settings::setGrabAvgColorsEnabled(state);
 }
 
+void SettingsWindow::onGrabIsLetterboxDetection_toggled(bool state)
+{
+    DEBUG_LOW_LEVEL << Q_FUNC_INFO << state;
+
+    Settings::setGrabLetterboxDetectionEnabled(state);
+}
+
 void SettingsWindow::onDeviceRefreshDelay_valueChanged(int value)
 {
     DEBUG_LOW_LEVEL << Q_FUNC_INFO << value;
@@ -1589,7 +1605,9 @@ void SettingsWindow::updateUiFromSettings()
     ui->checkBox_PingDeviceEverySecond->setChecked                   (Settings::isPingDeviceEverySecond());
 
     ui->checkBox_GrabIsAvgColors->setChecked                         (Settings::isGrabAvgColorsEnabled());
+    ui->checkBox_GrabIsLetterboxDetection->setChecked                (Settings::isGrabLetterboxDetectionEnabled());
     ui->spinBox_GrabSlowdown->setValue                               (Settings::getGrabSlowdown());
+    ui->spinBox_GrabChangeThreshold->setValue                        (Settings::getGrabChangeThreshold());
     ui->spinBox_LuminosityThreshold->setValue                        (Settings::getLuminosityThreshold());
 
     // Check the selected moodlamp mode (setChecked(false) not working to select another)
@@ -142,9 +142,11 @@ private slots:
 
     void onGrabberChanged();
     void onGrabSlowdown_valueChanged(int value);
+    void onGrabChangeThreshold_valueChanged(int value);
     void onLuminosityThreshold_valueChanged(int value);
     void onMinimumLumosity_toggled(bool value);
     void onGrabIsAvgColors_toggled(bool state);
+    void onGrabIsLetterboxDetection_toggled(bool state);
 
     void onDeviceRefreshDelay_valueChanged(int value);
     void onDeviceSmooth_valueChanged(int value);
@@ -144,6 +144,7 @@ namespace LedDeviceCommands
 enum Cmd {
     OffLeds,
     SetColors,
+    SetEffect,
     SetRefreshDelay,
     SetColorDepth,
     SetSmoothSlowdown,
@@ -154,6 +155,7 @@ enum Cmd {
     SetColorSequence,
     RequestFirmwareVersion,
     UpdateWBAdjustments,
-    UpdateDeviceSettings
+    UpdateDeviceSettings,
+    Open
 };
 }
@@ -200,6 +200,41 @@ extern "C" {
 		*/
 		int  HID_API_EXPORT HID_API_CALL hid_write(hid_device *device, const unsigned char *data, size_t length);
 
+#ifdef HID_API_ASYNC_WRITE
+		/** @brief Completion callback of hid_write_async().
+
+			@param user_data The pointer given to hid_write_async().
+			@param result The actual number of bytes written or -1 on error.
+		*/
+		typedef void (*hid_write_callback)(void *user_data, int result);
+
+		/** @brief Write an Output report to a HID device without waiting
+			for the transfer.
+
+			Lightpack extension, only the libusb version implements it.
+			The report goes the same way as with hid_write(). @p data is
+			copied, the buffer may be reused as soon as the call returns.
+			Reports submitted to one device are written in order.
+
+			@p callback is called once the transfer is done, from the
+			thread handling the libusb events of the device. hid_close()
+			waits for the callbacks of the pending writes.
+
+			@ingroup API
+			@param device A device handle returned from hid_open().
+			@param data The data to send, including the report number as
+				the first byte.
+			@param length The length in bytes of the data to send.
+			@param callback Called with the result of the write.
+			@param user_data Passed to @p callback.
+
+			@returns
+				This function returns 0 if the write was submitted and
+				-1 on error, @p callback isn't called then.
+		*/
+		int  HID_API_EXPORT HID_API_CALL hid_write_async(hid_device *device, const unsigned char *data, size_t length, hid_write_callback callback, void *user_data);
+#endif
+
 		/** @brief Read an Input report from a HID device with timeout.
 
 			Input reports are returned
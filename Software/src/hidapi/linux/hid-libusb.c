@@ -99,6 +99,9 @@ struct hid_device_ {
 	int shutdown_thread;
 	struct libusb_transfer *transfer;
 
+	/* Writes of hid_write_async() not completed yet, protected by mutex */
+	int pending_writes;
+
 	/* List of received input reports. */
 	struct input_report *input_reports;
 };
@@ -122,6 +125,7 @@ static hid_device *new_hid_device(void)
 	dev->blocking = 1;
 	dev->shutdown_thread = 0;
 	dev->transfer = NULL;
+	dev->pending_writes = 0;
 	dev->input_reports = NULL;
 	
 	pthread_mutex_init(&dev->mutex, NULL);
@@ -713,6 +717,17 @@ static void *read_thread(void *param)
 		/* The transfer was cancelled, so wait for its completion. */
 		libusb_handle_events(NULL);
 	}
+
+	/* Writes time out, so their callbacks come soon. They may run in
+	   the read thread of another device, don't block for long. */
+	pthread_mutex_lock(&dev->mutex);
+	while (dev->pending_writes > 0) {
+		struct timeval tv = { 0, 100000 };
+		pthread_mutex_unlock(&dev->mutex);
+		libusb_handle_events_timeout(NULL, &tv);
+		pthread_mutex_lock(&dev->mutex);
+	}
+	pthread_mutex_unlock(&dev->mutex);
 	
 	/* Now that the read thread is stopping, Wake any threads which are
 	   waiting on data (in hid_read_timeout()). Do this under a mutex to
@@ -921,6 +936,108 @@ int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t
 	}
 }
 
+#ifdef HID_API_ASYNC_WRITE
+struct write_request {
+	hid_device *dev;
+	hid_write_callback callback;
+	void *user_data;
+	int skipped_report_id;
+};
+
+static void write_callback(struct libusb_transfer *transfer)
+{
+	struct write_request *req = transfer->user_data;
+	hid_device *dev = req->dev;
+	int res = -1;
+
+	if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+		/* Doesn't include the setup packet of a control transfer */
+		res = transfer->actual_length;
+		if (req->skipped_report_id)
+			res++;
+	}
+	else {
+		LOG("Write transfer code: %d\n", transfer->status);
+	}
+
+	req->callback(req->user_data, res);
+	free(req);
+
+	/* The transfer and its buffer are freed by libusb on return */
+	pthread_mutex_lock(&dev->mutex);
+	dev->pending_writes--;
+	pthread_mutex_unlock(&dev->mutex);
+}
+
+int HID_API_EXPORT hid_write_async(hid_device *dev, const unsigned char *data, size_t length, hid_write_callback callback, void *user_data)
+{
+	struct libusb_transfer *transfer;
+	struct write_request *req;
+	unsigned char *buf;
+	int report_number = data[0];
+	int skipped_report_id = 0;
+
+	if (report_number == 0x0) {
+		data++;
+		length--;
+		skipped_report_id = 1;
+	}
+
+	transfer = libusb_alloc_transfer(0);
+	req = malloc(sizeof(*req));
+	buf = malloc(LIBUSB_CONTROL_SETUP_SIZE + length);
+	if (!transfer || !req || !buf) {
+		libusb_free_transfer(transfer);
+		free(req);
+		free(buf);
+		return -1;
+	}
+
+	req->dev = dev;
+	req->callback = callback;
+	req->user_data = user_data;
+	req->skipped_report_id = skipped_report_id;
+
+	if (dev->output_endpoint <= 0) {
+		/* No interrput out endpoint. Use the Control Endpoint */
+		libusb_fill_control_setup(buf,
+			LIBUSB_REQUEST_TYPE_CLASS|LIBUSB_RECIPIENT_INTERFACE|LIBUSB_ENDPOINT_OUT,
+			0x09/*HID Set_Report*/,
+			(2/*HID output*/ << 8) | report_number,
+			dev->interface,
+			length);
+		memcpy(buf + LIBUSB_CONTROL_SETUP_SIZE, data, length);
+		libusb_fill_control_transfer(transfer, dev->device_handle, buf,
+			write_callback, req, 1000/*timeout millis*/);
+	}
+	else {
+		/* Use the interrupt out endpoint */
+		memcpy(buf, data, length);
+		libusb_fill_interrupt_transfer(transfer, dev->device_handle,
+			dev->output_endpoint, buf, length,
+			write_callback, req, 1000/*timeout millis*/);
+	}
+	transfer->flags = LIBUSB_TRANSFER_FREE_BUFFER | LIBUSB_TRANSFER_FREE_TRANSFER;
+
+	/* Counted before the submit, the callback may come right away */
+	pthread_mutex_lock(&dev->mutex);
+	dev->pending_writes++;
+	pthread_mutex_unlock(&dev->mutex);
+
+	if (libusb_submit_transfer(transfer) < 0) {
+		pthread_mutex_lock(&dev->mutex);
+		dev->pending_writes--;
+		pthread_mutex_unlock(&dev->mutex);
+
+		free(req);
+		libusb_free_transfer(transfer); /* Frees buf too */
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
 /* Helper function, to simplify hid_read().
    This should be called with dev->mutex locked. */
 static int return_data(hid_device *dev, unsigned char *data, size_t length)
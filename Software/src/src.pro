@@ -134,6 +134,8 @@ win32 {
 unix:!macx{
     # Linux version using libusb and hidapi codes
     SOURCES += hidapi/linux/hid-libusb.c
+    # hid_write_async() of the libusb version, see LightpackUnitWriter
+    DEFINES += HID_API_ASYNC_WRITE
     # For QSerialDevice
     LIBS += -ludev -lrt -lXext -lX11 -lOpenCL
 }
@@ -178,14 +180,20 @@ SOURCES += \
       GrabWidget.cpp  GrabConfigWidget.cpp \
     SpeedTest.cpp \
     LedDeviceLightpack.cpp \
+    LightpackReportWriter.cpp \
+    LightpackUnitWriter.cpp \
+    LightpackFrameEncoder.cpp \
     LedDeviceAdalight.cpp \
     LedDeviceArdulight.cpp \
+    SerialFrameEncoder.cpp \
     LedDeviceVirtual.cpp \
     ColorButton.cpp \
     ApiServer.cpp \
     ApiServerSetColorTask.cpp \
+    ApiUdpServer.cpp \
     MoodLampManager.cpp \
     LedDeviceManager.cpp \
+    LedDeviceMailbox.cpp \
     SelectWidget.cpp \
     GrabManager.cpp \
     AbstractLedDevice.cpp \
@@ -225,20 +233,27 @@ HEADERS += \
     alienfx/LFXDecl.h \
     alienfx/LFX2.h \
     LedDeviceLightpack.hpp \
+    LightpackReportWriter.hpp \
+    LightpackUnitWriter.hpp \
+    LightpackFrameEncoder.hpp \
     LedDeviceAdalight.hpp \
     LedDeviceArdulight.hpp \
+    SerialFrameEncoder.hpp \
     LedDeviceVirtual.hpp \
     ColorButton.hpp \
     ../common/defs.h \
     enums.hpp         ApiServer.hpp     ApiServerSetColorTask.hpp \
+    ApiUdpServer.hpp \
     hidapi/hidapi.h \
     ../../CommonHeaders/COMMANDS.h \
     ../../CommonHeaders/USB_ID.h \
     MoodLampManager.hpp \
     LedDeviceManager.hpp \
+    LedDeviceMailbox.hpp \
     SelectWidget.hpp \
     ../common/D3D10GrabberDefs.hpp \
     AbstractLedDevice.hpp \
+    LedEffect.hpp \
     PluginsManager.hpp \
     Plugin.hpp \
     LightpackPluginInterface.hpp \
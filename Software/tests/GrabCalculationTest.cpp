@@ -8,3 +8,74 @@ void GrabCalculationTest::testCase1()
     QVERIFY2(Grab::Calculations::calculateAvgColor(&result, buf, BufferFormatArgb, 16, QRect(0,0,4,1)) == 0xfa, "Failure. calculateAvgColor returned wrong errorcode");
     QCOMPARE(result, qRgb(0xfa,0xfa,0xfa));
 }
+
+void GrabCalculationTest::testLetterboxDetection()
+{
+    const int width = 320, height = 180, bar = 20;
+    QByteArray frame(width * height * 4, 0);
+    for (int y = bar; y < height - bar; ++y)
+        for (int x = 0; x < width; ++x)
+            frame[(y * width + x) * 4 + 1] = (char)0x80;
+
+    const unsigned char *buf = reinterpret_cast<const unsigned char *>(frame.constData());
+    QMargins bars;
+    QVERIFY(Grab::LetterboxDetector::measure(&bars, buf, BufferFormatArgb, width * 4, QSize(width, height)));
+    QCOMPARE(bars, QMargins(0, bar, 0, bar));
+
+    // new bars are accepted only after they stay for a while
+    Grab::LetterboxDetector detector;
+    for (int i = 1; i < Grab::LetterboxDetector::kFramesToConfirm; ++i)
+        QVERIFY(detector.update(buf, BufferFormatArgb, width * 4, QSize(width, height)).isNull());
+    QCOMPARE(detector.update(buf, BufferFormatArgb, width * 4, QSize(width, height)), QMargins(0, bar, 0, bar));
+
+    // black frame says nothing about bars
+    QByteArray black(width * height * 4, 0);
+    QVERIFY(!Grab::LetterboxDetector::measure(&bars, reinterpret_cast<const unsigned char *>(black.constData()), BufferFormatArgb, width * 4, QSize(width, height)));
+
+    QCOMPARE(Grab::LetterboxDetector::remap(QRect(10, 0, 40, 15), QSize(width, height), detector.bars()), QRect(10, bar, 40, 15));
+    QCOMPARE(Grab::LetterboxDetector::remap(QRect(10, 170, 40, 10), QSize(width, height), detector.bars()), QRect(10, height - bar - 10, 40, 10));
+    QCOMPARE(Grab::LetterboxDetector::remap(QRect(0, 50, 40, 40), QSize(width, height), detector.bars()), QRect(0, 50, 40, 40));
+}
+
+void GrabCalculationTest::testReductionModes()
+{
+    using namespace Grab::Calculations;
+
+    const int width = 16, height = 8;
+    QByteArray frame(width * height * 4, 0);
+
+    // uniform area gives the same color in any mode
+    for (int i = 0; i < width * height; ++i) {
+        frame[i * 4 + 0] = (char)0x30; // b
+        frame[i * 4 + 1] = (char)0x60; // g
+        frame[i * 4 + 2] = (char)0x90; // r
+    }
+    const unsigned char *buf = reinterpret_cast<const unsigned char *>(frame.constData());
+    for (int mode = 0; mode < ReductionModesCount; ++mode) {
+        QRgb result;
+        calculateColor(&result, buf, BufferFormatArgb, width * 4, QRect(0, 0, width, height), static_cast<ReductionMode>(mode));
+        QCOMPARE(result, qRgb(0x90, 0x60, 0x30));
+    }
+
+    // a quarter of white pixels: the mean is greyish, the dominant color stays pure
+    for (int i = 0; i < width * height; i += 4) {
+        frame[i * 4 + 0] = frame[i * 4 + 1] = frame[i * 4 + 2] = (char)0xff;
+    }
+    QRgb mean, dominant, bright;
+    calculateColor(&mean, buf, BufferFormatArgb, width * 4, QRect(0, 0, width, height), ReductionModeMean);
+    calculateColor(&dominant, buf, BufferFormatArgb, width * 4, QRect(0, 0, width, height), ReductionModeDominant);
+    calculateColor(&bright, buf, BufferFormatArgb, width * 4, QRect(0, 0, width, height), ReductionModeLuminanceWeighted);
+    QCOMPARE(mean, qRgb((0x90 * 3 + 0xff) / 4, (0x60 * 3 + 0xff) / 4, (0x30 * 3 + 0xff) / 4));
+    QCOMPARE(dominant, qRgb(0x90, 0x60, 0x30));
+    QVERIFY(qBlue(bright) > qBlue(mean));
+
+    // the center of a zone outweighs its borders
+    QByteArray framed(width * height * 4, 0);
+    for (int y = 2; y < height - 2; ++y)
+        for (int x = 4; x < width - 4; ++x)
+            framed[(y * width + x) * 4 + 2] = (char)0xff;
+    QRgb center;
+    calculateColor(&mean, reinterpret_cast<const unsigned char *>(framed.constData()), BufferFormatArgb, width * 4, QRect(0, 0, width, height), ReductionModeMean);
+    calculateColor(&center, reinterpret_cast<const unsigned char *>(framed.constData()), BufferFormatArgb, width * 4, QRect(0, 0, width, height), ReductionModeCenterWeighted);
+    QVERIFY(qRed(center) > qRed(mean));
+}
@@ -30,6 +30,7 @@
 #include <QRect>
 #include "enums.hpp"
 #include "calculations.hpp"
+#include "LetterboxDetector.hpp"
 
 class GrabCalculationTest : public QObject
 {
@@ -40,5 +41,7 @@ public:
     
 private Q_SLOTS:
     void testCase1();
+    void testLetterboxDetection();
+    void testReductionModes();
 };
 
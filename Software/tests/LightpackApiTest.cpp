@@ -26,15 +26,20 @@
 #include <QString>
 #include <QtWidgets/QApplication>
 #include <QTest>
+#include <QtEndian>
+#include <QRegExp>
+#include <QUdpSocket>
 
 #include "debug.h"
 #include "ApiServer.hpp"
+#include "ApiUdpServer.hpp"
 #include "LightpackPluginInterface.hpp"
 #include "Settings.hpp"
 #include "enums.hpp"
 #include "SettingsWindowMockup.hpp"
 
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include "LightpackApiTest.hpp"
 
@@ -65,6 +70,12 @@ void LightpackApiTest::initTestCase()
     m_apiServer->moveToThread(m_apiServerThread);
     m_apiServerThread->start();
 
+    // Stands for the GUI thread, which runs profile and status commands
+    // while the test thread is blocked on its sockets
+    m_interfaceApiThread = new QThread();
+    m_interfaceApi->moveToThread(m_interfaceApiThread);
+    m_interfaceApiThread->start();
+
     m_little = new SettingsWindowMockup(this);
 
     connect(m_little, SIGNAL(enableApiServer(bool)), m_apiServer, SLOT(enableApiServer(bool)), Qt::DirectConnection);
@@ -75,6 +86,7 @@ void LightpackApiTest::initTestCase()
     connect(m_little, SIGNAL(resultBacklightStatus(Backlight::Status)), m_interfaceApi, SLOT(resultBacklightStatus(Backlight::Status)));
 
     connect(m_interfaceApi, SIGNAL(updateLedsColors(QList<QRgb>)), m_little, SLOT(setLedColors(QList<QRgb>)), Qt::QueuedConnection);
+    connect(m_apiServer, SIGNAL(updateLedsColors(QList<QRgb>)), m_little, SLOT(setLedColors(QList<QRgb>)), Qt::QueuedConnection);
     connect(m_interfaceApi, SIGNAL(updateGamma(double)), m_little, SLOT(setGamma(double)), Qt::QueuedConnection);
     connect(m_interfaceApi, SIGNAL(updateBrightness(int)), m_little, SLOT(setBrightness(int)), Qt::QueuedConnection);
     connect(m_interfaceApi, SIGNAL(updateSmooth(int)), m_little, SLOT(setSmooth(int)), Qt::QueuedConnection);
@@ -439,6 +451,395 @@ void LightpackApiTest::testCase_SetColorInvalid_data()
     QTest::newRow("17") << "1-1,1,1;;";
 }
 
+void LightpackApiTest::testCase_SetColorParser()
+{
+    QFETCH(QByteArray, cmd);
+    QFETCH(int, errorOffset);
+
+    QRgb colors[MaximumNumberOfLeds::AbsoluteMaximum];
+    memset(colors, 0, sizeof(colors));
+
+    const char *begin = cmd.constData();
+    QCOMPARE(ApiServerSetColorTask::parseSetColor(begin, begin + cmd.length(), colors, MaximumNumberOfLeds::AbsoluteMaximum), errorOffset);
+
+    if (errorOffset == ApiServerSetColorTask::ParseOk)
+    {
+        QFETCH(int, led);
+        QFETCH(int, r);
+        QFETCH(int, g);
+        QFETCH(int, b);
+        QCOMPARE(colors[led - 1], qRgb(r, g, b));
+    }
+}
+
+void LightpackApiTest::testCase_SetColorParser_data()
+{
+    QTest::addColumn<QByteArray>("cmd");
+    QTest::addColumn<int>("errorOffset");
+    QTest::addColumn<int>("led");
+    QTest::addColumn<int>("r");
+    QTest::addColumn<int>("g");
+    QTest::addColumn<int>("b");
+
+    const int ok = ApiServerSetColorTask::ParseOk;
+
+    QTest::newRow("one digit led") << QByteArray("1-1,2,3") << ok << 1 << 1 << 2 << 3;
+    QTest::newRow("two digit led") << QByteArray("99-4,5,6;") << ok << 99 << 4 << 5 << 6;
+    QTest::newRow("three digit led") << QByteArray("100-7,8,9;") << ok << 100 << 7 << 8 << 9;
+    QTest::newRow("last led") << QByteArray("1-0,0,0;255-255,0,255;") << ok << 255 << 255 << 0 << 255;
+    QTest::newRow("leading zeros in color") << QByteArray("3-007,0,00;") << ok << 3 << 7 << 0 << 0;
+    QTest::newRow("same led twice") << QByteArray("5-1,1,1;5-2,2,2") << ok << 5 << 2 << 2 << 2;
+
+    QTest::newRow("empty") << QByteArray("") << 0 << 0 << 0 << 0 << 0;
+    QTest::newRow("led zero") << QByteArray("0-1,1,1;") << 0 << 0 << 0 << 0 << 0;
+    QTest::newRow("led leading zero") << QByteArray("01-1,1,1;") << 0 << 0 << 0 << 0 << 0;
+    QTest::newRow("led out of range") << QByteArray("256-1,1,1;") << 2 << 0 << 0 << 0 << 0;
+    QTest::newRow("no dash") << QByteArray("1,1,1,1;") << 1 << 0 << 0 << 0 << 0;
+    QTest::newRow("double dash") << QByteArray("1--1,1,1;") << 2 << 0 << 0 << 0 << 0;
+    QTest::newRow("empty color") << QByteArray("1-1,,1;") << 4 << 0 << 0 << 0 << 0;
+    QTest::newRow("color out of range") << QByteArray("1-1,1,256;") << 8 << 0 << 0 << 0 << 0;
+    QTest::newRow("long color") << QByteArray("1-1,1111,1;") << 7 << 0 << 0 << 0 << 0;
+    QTest::newRow("two colors") << QByteArray("1-1,1;") << 5 << 0 << 0 << 0 << 0;
+    QTest::newRow("four colors") << QByteArray("1-1,1,1,1;") << 7 << 0 << 0 << 0 << 0;
+    QTest::newRow("truncated") << QByteArray("1-1,1,1;2-") << 10 << 0 << 0 << 0 << 0;
+    QTest::newRow("double semicolon") << QByteArray("1-1,1,1;;") << 8 << 0 << 0 << 0 << 0;
+    QTest::newRow("garbage") << QByteArray("1-1,1,1;2-2,2,2x") << 15 << 0 << 0 << 0 << 0;
+}
+
+// Reference check of the setcolor grammar, slow but obviously correct
+static bool isValidSetColor(const QByteArray & cmd, int numberOfLeds)
+{
+    QList<QByteArray> items = cmd.split(';');
+    if (items.count() > 1 && items.last().isEmpty())
+        items.removeLast();
+
+    QRegExp rx("([1-9][0-9]*)-([0-9]+),([0-9]+),([0-9]+)");
+    foreach (const QByteArray & item, items)
+    {
+        if (rx.exactMatch(QString(item)) == false)
+            return false;
+
+        bool ok = false;
+        int led = rx.cap(1).toInt(&ok);
+        if (!ok || led > numberOfLeds)
+            return false;
+
+        for (int i = 2; i <= 4; i++)
+        {
+            int value = rx.cap(i).toInt(&ok);
+            if (!ok || value > 255)
+                return false;
+        }
+    }
+    return true;
+}
+
+void LightpackApiTest::testCase_SetColorParserFuzz()
+{
+    const int numberOfLeds = MaximumNumberOfLeds::AbsoluteMaximum;
+    const char alphabet[] = "0123456789-,;x";
+
+    QRgb colors[MaximumNumberOfLeds::AbsoluteMaximum];
+    QRgb expected[MaximumNumberOfLeds::AbsoluteMaximum];
+
+    qsrand(36);
+
+    for (int iteration = 0; iteration < 20000; iteration++)
+    {
+        memset(colors, 0, sizeof(colors));
+        memset(expected, 0, sizeof(expected));
+
+        // Valid command first
+        QByteArray cmd;
+        int count = 1 + qrand() % 20;
+        for (int i = 0; i < count; i++)
+        {
+            int led = 1 + qrand() % numberOfLeds;
+            int r = qrand() % 256, g = qrand() % 256, b = qrand() % 256;
+            expected[led - 1] = qRgb(r, g, b);
+            cmd += QString("%1-%2,%3,%4;").arg(led).arg(r).arg(g).arg(b).toLatin1();
+        }
+        if (qrand() % 2)
+            cmd.chop(1); // last semicolon is optional
+
+        // Then break it with a few random edits
+        int edits = qrand() % 4;
+        for (int i = 0; i < edits; i++)
+        {
+            int pos = qrand() % (cmd.length() + 1);
+            char c = alphabet[qrand() % (sizeof(alphabet) - 1)];
+            switch (qrand() % 3)
+            {
+            case 0: cmd.insert(pos, c); break;
+            case 1: if (pos < cmd.length()) cmd.remove(pos, 1); break;
+            default: if (pos < cmd.length()) cmd[pos] = c; break;
+            }
+        }
+
+        const char *begin = cmd.constData();
+        int errorOffset = ApiServerSetColorTask::parseSetColor(begin, begin + cmd.length(), colors, numberOfLeds);
+
+        QVERIFY2(isValidSetColor(cmd, numberOfLeds) == (errorOffset == ApiServerSetColorTask::ParseOk),
+                 qPrintable(QString("cmd = %1, errorOffset = %2").arg(QString::fromLatin1(cmd)).arg(errorOffset)));
+
+        if (errorOffset == ApiServerSetColorTask::ParseOk)
+        {
+            if (edits == 0)
+                QVERIFY(memcmp(colors, expected, sizeof(colors)) == 0);
+        } else {
+            QVERIFY(errorOffset >= 0 && errorOffset <= cmd.length());
+
+            // Complete items before the error offset are valid
+            QByteArray prefix = cmd.left(errorOffset);
+            if (prefix.endsWith(';'))
+                QVERIFY(isValidSetColor(prefix, numberOfLeds));
+        }
+    }
+}
+
+void LightpackApiTest::benchmark_SetColorParser()
+{
+    QByteArray cmd;
+    for (int led = 1; led <= MaximumNumberOfLeds::AbsoluteMaximum; led++)
+        cmd += QString("%1-%2,%3,%4;").arg(led).arg(led).arg(255 - led).arg(128).toLatin1();
+
+    QRgb colors[MaximumNumberOfLeds::AbsoluteMaximum];
+    const char *begin = cmd.constData();
+    const char *end = begin + cmd.length();
+
+    QBENCHMARK {
+        ApiServerSetColorTask::parseSetColor(begin, end, colors, MaximumNumberOfLeds::AbsoluteMaximum);
+    }
+
+    QCOMPARE(colors[254], qRgb(255, 0, 128));
+}
+
+void LightpackApiTest::testCase_SetColorPipelined()
+{
+    QTcpSocket sockOther;
+    sockOther.connectToHost("127.0.0.1", 3636);
+    QVERIFY(checkVersion(&sockOther));
+
+    // All commands in one write, answers must come back in the same order
+    QByteArray commands;
+    commands += QByteArray(ApiServer::CmdLock) + "\n";
+    commands += QByteArray(ApiServer::CmdSetColor) + "1-1,2,3;\n";
+    commands += QByteArray(ApiServer::CmdSetColor) + "1-1,2,\n";
+    commands += QByteArray(ApiServer::CmdSetColor) + "2-4,5,6;\n";
+    commands += QByteArray(ApiServer::CmdGetStatusAPI) + "\n";
+    commands += QByteArray(ApiServer::CmdUnlock) + "\n";
+    m_socket->write(commands);
+
+    // Other clients are served while the setcolor commands are parsed
+    QVERIFY(writeCommandWithCheck(&sockOther, ApiServer::CmdGetProfile, ApiServer::CmdResultProfile + Settings::getCurrentProfileName().toUtf8() + "\r\n"));
+
+    QVERIFY(readBufferedResult(m_socket) == ApiServer::CmdResultLock_Success);
+    QVERIFY(readBufferedResult(m_socket) == ApiServer::CmdSetResult_Ok);
+    QVERIFY(readBufferedResult(m_socket) == ApiServer::CmdSetResult_Error);
+    QVERIFY(readBufferedResult(m_socket) == ApiServer::CmdSetResult_Ok);
+    QVERIFY(readBufferedResult(m_socket) == ApiServer::CmdResultStatusAPI_Busy);
+    QVERIFY(readBufferedResult(m_socket) == ApiServer::CmdResultUnlock_Success);
+}
+
+void LightpackApiTest::testCase_SetColorBinary()
+{
+    QVERIFY(writeCommandWithCheck(m_socket, ApiServer::CmdBinaryMode, ApiServer::CmdResultBinaryMode_Ok));
+
+    QByteArray payload;
+    payload.append(char(23)).append(char(2)).append(char(65));
+    payload.append(char(255)).append(char(0)).append(char(128));
+
+    // Frames are rejected without lock, but the stream stays in sync
+    writeBinaryFrame(m_socket, ApiBinaryFrame::SetColors, 1, payload);
+    QVERIFY(readBinaryAck(m_socket, ApiBinaryFrame::SetColors, 1, ApiBinaryFrame::StatusNotLocked));
+
+    // Back to text commands for lock
+    writeBinaryFrame(m_socket, ApiBinaryFrame::Exit, 2, QByteArray());
+    QVERIFY(readBinaryAck(m_socket, ApiBinaryFrame::Exit, 2, ApiBinaryFrame::StatusOk));
+    QVERIFY(lock(m_socket));
+    QVERIFY(writeCommandWithCheck(m_socket, ApiServer::CmdBinaryMode, ApiServer::CmdResultBinaryMode_Ok));
+
+    // Several frames are sent before reading any ack
+    writeBinaryFrame(m_socket, ApiBinaryFrame::SetColors, 3, payload);
+    writeBinaryFrame(m_socket, ApiBinaryFrame::SetColors, 0xfffe, payload);
+    QVERIFY(readBinaryAck(m_socket, ApiBinaryFrame::SetColors, 3, ApiBinaryFrame::StatusOk));
+    QVERIFY(readBinaryAck(m_socket, ApiBinaryFrame::SetColors, 0xfffe, ApiBinaryFrame::StatusOk));
+
+    processEventsFromLittle();
+
+    QVERIFY(m_little->m_colors[0] == qRgb(23, 2, 65));
+    QVERIFY(m_little->m_colors[1] == qRgb(255, 0, 128));
+
+    writeBinaryFrame(m_socket, ApiBinaryFrame::Exit, 4, QByteArray());
+    QVERIFY(readBinaryAck(m_socket, ApiBinaryFrame::Exit, 4, ApiBinaryFrame::StatusOk));
+
+    QVERIFY(unlock(m_socket));
+}
+
+void LightpackApiTest::testCase_SetColorBinaryInvalid()
+{
+    QVERIFY(lock(m_socket));
+    QVERIFY(writeCommandWithCheck(m_socket, ApiServer::CmdBinaryMode, ApiServer::CmdResultBinaryMode_Ok));
+
+    // Payload is not a whole number of leds
+    writeBinaryFrame(m_socket, ApiBinaryFrame::SetColors, 1, QByteArray(4, 1));
+    QVERIFY(readBinaryAck(m_socket, ApiBinaryFrame::SetColors, 1, ApiBinaryFrame::StatusError));
+
+    // More leds than the device has
+    int countLeds = m_interfaceApi->GetCountLeds();
+    writeBinaryFrame(m_socket, ApiBinaryFrame::SetColors, 2, QByteArray((countLeds + 1) * 3, 1));
+    QVERIFY(readBinaryAck(m_socket, ApiBinaryFrame::SetColors, 2, ApiBinaryFrame::StatusError));
+
+    // Broken header closes the connection
+    m_socket->write(QByteArray(ApiBinaryFrame::HeaderSize, 0));
+    QVERIFY(readBinaryAck(m_socket, 0, 0, ApiBinaryFrame::StatusError));
+    QVERIFY(m_socket->state() == QAbstractSocket::UnconnectedState || m_socket->waitForDisconnected(1000));
+
+    // The lock is released together with the connection
+    m_socket->abort();
+    m_socket->connectToHost("127.0.0.1", 3636);
+    QVERIFY(m_socket->waitForConnected(5000));
+    QVERIFY(checkVersion(m_socket));
+    QVERIFY(writeCommandWithCheck(m_socket, ApiServer::CmdUnlock, ApiServer::CmdResultUnlock_NotLocked));
+}
+
+void LightpackApiTest::testCase_UdpFrames()
+{
+    ApiUdpServer udpServer;
+    udpServer.setInterface(m_interfaceApi);
+    QVERIFY(udpServer.start(QHostAddress::LocalHost, 3637, QString()));
+
+    QUdpSocket sender;
+
+    // Frame without sequence locks the device and is applied
+    sender.writeDatagram(udpFrame(-1, 1, 2, 3), QHostAddress::LocalHost, 3637);
+    processEventsFromLittle();
+    QVERIFY(m_little->m_colors[0] == qRgb(1, 2, 3));
+    QVERIFY(writeCommandWithCheck(m_socket, ApiServer::CmdLock, ApiServer::CmdResultLock_Busy));
+
+    // Sequenced frames, the late one is dropped
+    sender.writeDatagram(udpFrame(10, 10, 10, 10), QHostAddress::LocalHost, 3637);
+    processEventsFromLittle();
+    QVERIFY(m_little->m_colors[0] == qRgb(10, 10, 10));
+
+    sender.writeDatagram(udpFrame(9, 9, 9, 9), QHostAddress::LocalHost, 3637);
+    sender.writeDatagram(udpFrame(11, 11, 11, 11), QHostAddress::LocalHost, 3637);
+    processEventsFromLittle();
+    QVERIFY(m_little->m_colors[0] == qRgb(11, 11, 11));
+    QCOMPARE(udpServer.stats().stale, quint32(1));
+
+    // Sequence wraps around
+    sender.writeDatagram(udpFrame(0xffff, 20, 20, 20), QHostAddress::LocalHost, 3637);
+    sender.writeDatagram(udpFrame(0, 21, 21, 21), QHostAddress::LocalHost, 3637);
+    processEventsFromLittle();
+    processEventsFromLittle();
+    QVERIFY(m_little->m_colors[0] == qRgb(21, 21, 21));
+
+    // Broken datagrams are counted and ignored
+    sender.writeDatagram(QByteArray(ApiUdpFrame::HeaderSize + 2, ApiUdpFrame::Magic), QHostAddress::LocalHost, 3637);
+    QTest::qWait(100);
+    QCOMPARE(udpServer.stats().invalid, quint32(1));
+
+    // Stopping releases the lock for other clients
+    udpServer.stop();
+    QVERIFY(lock(m_socket));
+
+    // Frames are not applied while another client holds the lock
+    QVERIFY(udpServer.start(QHostAddress::LocalHost, 3637, QString()));
+    sender.writeDatagram(udpFrame(-1, 5, 5, 5), QHostAddress::LocalHost, 3637);
+    QTest::qWait(100);
+    QCOMPARE(udpServer.stats().busy, quint32(1));
+
+    QVERIFY(unlock(m_socket));
+}
+
+void LightpackApiTest::testCase_UdpMulticast()
+{
+    ApiUdpServer udpServer;
+    udpServer.setInterface(m_interfaceApi);
+    if (!udpServer.start(QHostAddress::LocalHost, 3638, "239.255.36.38"))
+        QSKIP("Multicast is not available on this host");
+
+    QUdpSocket sender;
+    sender.setSocketOption(QAbstractSocket::MulticastLoopbackOption, 1);
+    sender.writeDatagram(udpFrame(1, 7, 8, 9), QHostAddress("239.255.36.38"), 3638);
+
+    processEventsFromLittle();
+    QVERIFY(m_little->m_colors[0] == qRgb(7, 8, 9));
+}
+
+void LightpackApiTest::testCase_LockHandle()
+{
+    const QString sessionKey = "API-handle-test";
+
+    QCOMPARE(m_interfaceApi->LockHandle(sessionKey), 0);
+    QVERIFY(m_interfaceApi->SetColorByHandle(0, 0, 1, 2, 3) == false);
+
+    QVERIFY(m_interfaceApi->Lock(sessionKey));
+    int handle = m_interfaceApi->LockHandle(sessionKey);
+    QVERIFY(handle != 0);
+    QCOMPARE(m_interfaceApi->LockHandle("API-not-locked"), 0);
+
+    // Single led updates are merged into the frame, the latest one wins
+    QVERIFY(m_interfaceApi->SetColorByHandle(handle, 0, 1, 2, 3));
+    QVERIFY(m_interfaceApi->SetColorByHandle(handle, 1, 4, 5, 6));
+    QVERIFY(m_interfaceApi->SetColorByHandle(handle, 0, 7, 8, 9));
+    QVERIFY(m_interfaceApi->SetColorByHandle(handle, MaximumNumberOfLeds::AbsoluteMaximum, 1, 1, 1) == false);
+
+    QTRY_VERIFY(m_little->m_colors.count() > 1
+                && m_little->m_colors[0] == qRgb(7, 8, 9)
+                && m_little->m_colors[1] == qRgb(4, 5, 6));
+
+    // Keyed calls change the same frame
+    QVERIFY(m_interfaceApi->SetColor(sessionKey, 1, 10, 11, 12));
+    QTRY_VERIFY(m_little->m_colors[1] == qRgb(10, 11, 12));
+    QVERIFY(m_little->m_colors[0] == qRgb(7, 8, 9));
+
+    // Handle dies with the lock
+    QVERIFY(m_interfaceApi->UnLock(sessionKey));
+    QVERIFY(m_interfaceApi->SetColorByHandle(handle, 0, 1, 2, 3) == false);
+
+    QVERIFY(m_interfaceApi->Lock(sessionKey));
+    QVERIFY(m_interfaceApi->LockHandle(sessionKey) != handle);
+    QVERIFY(m_interfaceApi->UnLock(sessionKey));
+}
+
+void LightpackApiTest::testCase_Subscribe()
+{
+    QTcpSocket sockSub;
+    sockSub.connectToHost("127.0.0.1", 3636);
+    QVERIFY(checkVersion(&sockSub));
+
+    QByteArray cmdSubscribe = ApiServer::CmdSubscribe;
+    QVERIFY(writeCommandWithCheck(&sockSub, cmdSubscribe + ":0", ApiServer::CmdSetResult_Error));
+    QVERIFY(writeCommandWithCheck(&sockSub, cmdSubscribe + ":abc", ApiServer::CmdSetResult_Error));
+    QVERIFY(writeCommandWithCheck(&sockSub, cmdSubscribe + ":2", ApiServer::CmdResultSubscribe_Ok));
+
+    QVERIFY(lock(m_socket));
+    QVERIFY(readBufferedResult(&sockSub) == ApiServer::PushEvent + QByteArray(ApiServer::CmdResultStatusAPI_Busy));
+
+    // The first frame is pushed right away, the next ones within
+    // the push interval are coalesced into the latest colors
+    QByteArray cmdSetColor = ApiServer::CmdSetColor;
+    QVERIFY(writeCommandWithCheck(m_socket, cmdSetColor + "1-1,2,3;", ApiServer::CmdSetResult_Ok));
+    QVERIFY(writeCommandWithCheck(m_socket, cmdSetColor + "1-4,5,6;", ApiServer::CmdSetResult_Ok));
+    QVERIFY(writeCommandWithCheck(m_socket, cmdSetColor + "1-7,8,9;", ApiServer::CmdSetResult_Ok));
+
+    QByteArray frame = readBufferedResult(&sockSub);
+    QVERIFY(frame.startsWith(QByteArray(ApiServer::PushColors) + "010203"));
+    QVERIFY(frame.endsWith("\r\n"));
+    QVERIFY((frame.size() - qstrlen(ApiServer::PushColors) - 2) % 6 == 0);
+
+    frame = readBufferedResult(&sockSub);
+    QVERIFY(frame.startsWith(QByteArray(ApiServer::PushColors) + "070809"));
+    QVERIFY(sockSub.waitForReadyRead(700) == false);
+
+    QVERIFY(writeCommandWithCheck(&sockSub, ApiServer::CmdUnsubscribe, ApiServer::CmdResultUnsubscribe_Ok));
+
+    QVERIFY(unlock(m_socket));
+    QVERIFY(sockSub.waitForReadyRead(100) == false);
+}
+
 void LightpackApiTest::testCase_SetGammaValid()
 {
     QVERIFY(lock(m_socket));
@@ -704,6 +1105,17 @@ QByteArray LightpackApiTest::readResult(QTcpSocket * socket)
     return socket->readLine();
 }
 
+QByteArray LightpackApiTest::readBufferedResult(QTcpSocket * socket)
+{
+    // Unlike readResult(), takes lines that have already arrived first
+    while (socket->canReadLine() == false)
+    {
+        if (socket->waitForReadyRead(1000) == false)
+            return QByteArray();
+    }
+    return socket->readLine();
+}
+
 void LightpackApiTest::writeCommand(QTcpSocket * socket, const char * cmd)
 {
     socket->write(cmd);
@@ -718,6 +1130,50 @@ bool LightpackApiTest::writeCommandWithCheck(QTcpSocket * socket, const QByteArr
     return (m_sockReadLineOk && read == result);
 }
 
+void LightpackApiTest::writeBinaryFrame(QTcpSocket * socket, quint8 type, quint16 sequence, const QByteArray & payload)
+{
+    uchar header[ApiBinaryFrame::HeaderSize];
+
+    header[0] = ApiBinaryFrame::Magic;
+    header[1] = type;
+    qToBigEndian<quint16>(sequence, header + 2);
+    qToBigEndian<quint16>(payload.size(), header + 4);
+
+    socket->write(reinterpret_cast<const char *>(header), ApiBinaryFrame::HeaderSize);
+    socket->write(payload);
+}
+
+bool LightpackApiTest::readBinaryAck(QTcpSocket * socket, quint8 type, quint16 sequence, quint8 status)
+{
+    while (socket->bytesAvailable() < ApiBinaryFrame::HeaderSize)
+    {
+        if (socket->waitForReadyRead(1000) == false)
+            return false;
+    }
+
+    uchar ack[ApiBinaryFrame::HeaderSize];
+    socket->read(reinterpret_cast<char *>(ack), ApiBinaryFrame::HeaderSize);
+
+    return ack[0] == ApiBinaryFrame::Magic
+            && ack[1] == (type | ApiBinaryFrame::AckFlag)
+            && qFromBigEndian<quint16>(ack + 2) == sequence
+            && ack[4] == status;
+}
+
+QByteArray LightpackApiTest::udpFrame(int sequence, int r, int g, int b)
+{
+    // Negative sequence means datagram without sequence number
+    QByteArray frame(ApiUdpFrame::HeaderSize, 0);
+    frame[0] = char(ApiUdpFrame::Magic);
+    if (sequence >= 0)
+    {
+        frame[1] = char(ApiUdpFrame::HasSequence);
+        qToBigEndian<quint16>(sequence, reinterpret_cast<uchar *>(frame.data()) + 2);
+    }
+    frame.append(char(r)).append(char(g)).append(char(b));
+    return frame;
+}
+
 QString LightpackApiTest::getProfilesResultString()
 {
     QStringList profiles = Settings::findAllProfiles();
@@ -52,6 +52,22 @@ private Q_SLOTS:
     void testCase_SetColorInvalid();
     void testCase_SetColorInvalid_data();
 
+    void testCase_SetColorParser();
+    void testCase_SetColorParser_data();
+    void testCase_SetColorParserFuzz();
+    void benchmark_SetColorParser();
+
+    void testCase_SetColorPipelined();
+    void testCase_SetColorBinary();
+    void testCase_SetColorBinaryInvalid();
+
+    void testCase_UdpFrames();
+    void testCase_UdpMulticast();
+
+    void testCase_LockHandle();
+
+    void testCase_Subscribe();
+
     void testCase_SetGammaValid();
     void testCase_SetGammaValid_data();
     void testCase_SetGammaInvalid();
@@ -74,6 +90,7 @@ private Q_SLOTS:
 
 private:
     QByteArray readResult(QTcpSocket * socket);
+    QByteArray readBufferedResult(QTcpSocket * socket);
     void writeCommand(QTcpSocket * socket, const char * cmd);
     bool writeCommandWithCheck(QTcpSocket * socket, const QByteArray & command, const QByteArray & result);
 
@@ -84,11 +101,15 @@ private:
     bool lock(QTcpSocket * socket);
     bool unlock(QTcpSocket * socket);
     bool setGamma(QTcpSocket * socket, QString gammaStr);
+    void writeBinaryFrame(QTcpSocket * socket, quint8 type, quint16 sequence, const QByteArray & payload);
+    bool readBinaryAck(QTcpSocket * socket, quint8 type, quint16 sequence, quint8 status);
+    QByteArray udpFrame(int sequence, int r, int g, int b);
 
 private:
     ApiServer *m_apiServer;
     QThread *m_apiServerThread;
     LightpackPluginInterface *m_interfaceApi;
+    QThread *m_interfaceApiThread;
     SettingsWindowMockup *m_little;
 
     QTcpSocket * m_socket;
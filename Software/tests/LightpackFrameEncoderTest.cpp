@@ -0,0 +1,178 @@
+/*
+ * LightpackFrameEncoderTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LightpackFrameEncoderTest.hpp"
+#include "LightpackFrameEncoder.hpp"
+#include "../../CommonHeaders/COMMANDS.h"
+
+namespace
+{
+const int kLeds = LightpackFrameEncoder::kLedsCount;
+const int kSequence = LightpackFrameEncoder::kSequenceSize;
+
+// CMD_UPDATE_LEDS report as built by LedDeviceLightpack::setColors()
+void setColor(unsigned char *report, int led, quint16 r, quint16 g, quint16 b)
+{
+    report[1] = CMD_UPDATE_LEDS;
+    unsigned char *data = report + 2 + led * 6;
+    data[0] = r >> 4;
+    data[1] = g >> 4;
+    data[2] = b >> 4;
+    data[3] = r & 0x0f;
+    data[4] = g & 0x0f;
+    data[5] = b & 0x0f;
+}
+
+void setColors(unsigned char *report)
+{
+    memset(report, 0, LightpackFrameEncoder::kReportSize);
+    for (int i = 0; i < kLeds; i++)
+        setColor(report, i, (i * 397) % 4096, (i * 1021 + 7) % 4096, 4095 - i);
+}
+
+// The way firmware reads packed values
+quint16 unpack12(const unsigned char *data, int index)
+{
+    const unsigned char *packed = data + index + index / 2;
+    if (index & 1)
+        return ((packed[0] & 0x0f) << 8) | packed[1];
+    else
+        return (packed[0] << 4) | (packed[1] >> 4);
+}
+}
+
+void LightpackFrameEncoderTest::testFill()
+{
+    LightpackFrameEncoder encoder;
+    encoder.setCompactCommands(true);
+
+    unsigned char report[LightpackFrameEncoder::kReportSize] = {0};
+    for (int i = 0; i < kLeds; i++)
+        setColor(report, i, 4095, 0x123, 1);
+
+    QCOMPARE(encoder.encode(report), 2 + LightpackFrameEncoder::packedSize(3) + kSequence);
+    QCOMPARE((int)report[1], CMD_FILL_LEDS);
+    QCOMPARE((int)unpack12(report + 2, 0), 4095);
+    QCOMPARE((int)unpack12(report + 2, 1), 0x123);
+    QCOMPARE((int)unpack12(report + 2, 2), 1);
+
+    // Unit shows these colors already
+    for (int i = 0; i < kLeds; i++)
+        setColor(report, i, 4095, 0x123, 1);
+    QCOMPARE(encoder.encode(report), 0);
+}
+
+void LightpackFrameEncoderTest::testChanged()
+{
+    LightpackFrameEncoder encoder;
+    encoder.setCompactCommands(true);
+
+    unsigned char report[LightpackFrameEncoder::kReportSize];
+    setColors(report);
+    QCOMPARE(encoder.encode(report), 2 + LightpackFrameEncoder::packedSize(3 * kLeds) + kSequence);
+
+    setColors(report);
+    setColor(report, 1, 10, 20, 30);
+    setColor(report, 9, 4000, 3000, 2000);
+
+    QCOMPARE(encoder.encode(report), 2 + 2 + LightpackFrameEncoder::packedSize(3 * 2) + kSequence);
+    QCOMPARE((int)report[1], CMD_UPDATE_LEDS_CHANGED);
+    QCOMPARE(report[2] | (report[3] << 8), (1 << 1) | (1 << 9));
+
+    const quint16 expected[] = { 10, 20, 30, 4000, 3000, 2000 };
+    for (int i = 0; i < 6; i++)
+        QCOMPARE(unpack12(report + 4, i), expected[i]);
+
+    // Forgotten colors are written in full
+    encoder.reset();
+    setColors(report);
+    QCOMPARE(encoder.encode(report), 2 + LightpackFrameEncoder::packedSize(3 * kLeds) + kSequence);
+}
+
+void LightpackFrameEncoderTest::testPacked()
+{
+    LightpackFrameEncoder encoder;
+    encoder.setCompactCommands(true);
+
+    unsigned char report[LightpackFrameEncoder::kReportSize];
+    unsigned char legacy[LightpackFrameEncoder::kReportSize];
+    setColors(report);
+    memcpy(legacy, report, sizeof(report));
+
+    QCOMPARE(encoder.encode(report), 2 + 45 + kSequence);
+    QCOMPARE((int)report[1], CMD_UPDATE_LEDS_PACKED);
+
+    for (int i = 0; i < kLeds * 3; i++) {
+        const unsigned char *color = legacy + 2 + (i / 3) * 6;
+        QCOMPARE((int)unpack12(report + 2, i), (color[i % 3] << 4) | color[3 + i % 3]);
+    }
+}
+
+void LightpackFrameEncoderTest::testLegacy()
+{
+    LightpackFrameEncoder encoder;
+
+    unsigned char report[LightpackFrameEncoder::kReportSize];
+    unsigned char legacy[LightpackFrameEncoder::kReportSize];
+    setColors(report);
+    memcpy(legacy, report, sizeof(report));
+
+    QCOMPARE(encoder.encode(report), (int)LightpackFrameEncoder::kReportSize);
+    QVERIFY(memcmp(report, legacy, sizeof(report)) == 0);
+    QCOMPARE(encoder.encode(report), 0);
+
+    // Switching the commands forgets the colors
+    encoder.setCompactCommands(true);
+    QCOMPARE((int)encoder.isCompactCommands(), 1);
+    QCOMPARE(encoder.encode(report), 2 + 45 + kSequence);
+}
+
+void LightpackFrameEncoderTest::testSequence()
+{
+    LightpackFrameEncoder encoder;
+    encoder.setCompactCommands(true);
+
+    // Sequence goes after the colors of CMD_UPDATE_LEDS, report ID comes first
+    unsigned char report[LightpackFrameEncoder::kReportSize];
+    setColors(report);
+    report[1 + INDEX_UPDATE_LEDS_SEQUENCE] = 0x34;
+    report[1 + INDEX_UPDATE_LEDS_SEQUENCE + 1] = 0x12;
+
+    int size = encoder.encode(report);
+    QCOMPARE(size, 2 + 45 + kSequence);
+    QCOMPARE(report[size - 2] | (report[size - 1] << 8), 0x1234);
+
+    setColors(report);
+    setColor(report, 3, 1, 2, 3);
+    report[1 + INDEX_UPDATE_LEDS_SEQUENCE] = 0x35;
+    report[1 + INDEX_UPDATE_LEDS_SEQUENCE + 1] = 0x12;
+
+    size = encoder.encode(report);
+    QCOMPARE((int)report[1], CMD_UPDATE_LEDS_CHANGED);
+    QCOMPARE(size, 2 + 2 + LightpackFrameEncoder::packedSize(3) + kSequence);
+    QCOMPARE(report[size - 2] | (report[size - 1] << 8), 0x1235);
+}
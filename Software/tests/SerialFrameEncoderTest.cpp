@@ -0,0 +1,181 @@
+/*
+ * SerialFrameEncoderTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SerialFrameEncoderTest.hpp"
+#include "SerialFrameEncoder.hpp"
+
+namespace
+{
+const int kBenchmarkLedsCount = 255;
+
+// The way LedDeviceAdalight built frames before SerialFrameEncoder
+void appendEncode(QByteArray &buffer, const QByteArray &header, const QList<StructRgb> &colors, const QString &colorSequence)
+{
+    buffer.clear();
+    buffer.append(header);
+
+    for (int i = 0; i < colors.count(); i++)
+    {
+        StructRgb color = colors[i];
+
+        color.r = color.r >> 4;
+        color.g = color.g >> 4;
+        color.b = color.b >> 4;
+
+        if (colorSequence == "RBG")
+        {
+            buffer.append(color.r);
+            buffer.append(color.b);
+            buffer.append(color.g);
+        }
+        else if (colorSequence == "BRG")
+        {
+            buffer.append(color.b);
+            buffer.append(color.r);
+            buffer.append(color.g);
+        }
+        else if (colorSequence == "BGR")
+        {
+            buffer.append(color.b);
+            buffer.append(color.g);
+            buffer.append(color.r);
+        }
+        else if (colorSequence == "GRB")
+        {
+            buffer.append(color.g);
+            buffer.append(color.r);
+            buffer.append(color.b);
+        }
+        else if (colorSequence == "GBR")
+        {
+            buffer.append(color.g);
+            buffer.append(color.b);
+            buffer.append(color.r);
+        }
+        else
+        {
+            buffer.append(color.r);
+            buffer.append(color.g);
+            buffer.append(color.b);
+        }
+    }
+}
+
+QList<StructRgb> testColors(int count)
+{
+    QList<StructRgb> colors;
+    for (int i = 0; i < count; i++) {
+        StructRgb color;
+        color.r = (i * 97) % 4096;
+        color.g = (i * 389 + 7) % 4096;
+        color.b = (i * 1021 + 13) % 4096;
+        colors << color;
+    }
+    return colors;
+}
+
+QByteArray adalightHeader(int ledsCount)
+{
+    QByteArray header("Ada");
+    const char hi = ((ledsCount - 1) >> 8) & 0xff;
+    const char lo = (ledsCount - 1) & 0xff;
+    header.append(hi).append(lo).append((char)(hi ^ lo ^ 0x55));
+    return header;
+}
+}
+
+void SerialFrameEncoderTest::testColorSequences()
+{
+    const QList<StructRgb> colors = testColors(30);
+    const QByteArray header = adalightHeader(colors.count());
+    const char *sequences[] = { "RGB", "RBG", "GRB", "GBR", "BRG", "BGR" };
+
+    SerialFrameEncoder encoder;
+    encoder.setHeader(header);
+
+    for (size_t i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        QByteArray expected;
+        appendEncode(expected, header, colors, sequences[i]);
+
+        QVERIFY(encoder.setColorSequence(sequences[i]));
+        QCOMPARE(encoder.encode(colors), expected);
+    }
+
+    // Unknown sequence falls back to RGB as before
+    QByteArray expected;
+    appendEncode(expected, header, colors, "XYZ");
+    QVERIFY(!encoder.setColorSequence("XYZ"));
+    QVERIFY(!encoder.setColorSequence("RRB"));
+    QCOMPARE(encoder.encode(colors), expected);
+}
+
+void SerialFrameEncoderTest::testHeaderAndClamp()
+{
+    SerialFrameEncoder encoder;
+    encoder.setHeader(adalightHeader(2));
+
+    QList<StructRgb> colors = testColors(2);
+    colors[0].r = 4095;
+
+    QCOMPARE(encoder.encode(colors).size(), 6 + 2 * 3);
+    QCOMPARE((unsigned char)encoder.encode(colors).at(6), (unsigned char)255);
+
+    // Header of the other size is applied to the already encoded frame
+    encoder.setHeader(QByteArray(1, (char)255));
+    encoder.setMaxChannelValue(254);
+    const QByteArray &frame = encoder.encode(colors);
+    QCOMPARE(frame.size(), 1 + 2 * 3);
+    QCOMPARE((unsigned char)frame.at(0), (unsigned char)255);
+    QCOMPARE((unsigned char)frame.at(1), (unsigned char)254);
+
+    const QByteArray &black = encoder.encodeBlack(3);
+    QCOMPARE(black, QByteArray(1, (char)255) + QByteArray(3 * 3, 0));
+}
+
+void SerialFrameEncoderTest::benchmarkAppendEncode()
+{
+    const QList<StructRgb> colors = testColors(kBenchmarkLedsCount);
+    const QByteArray header = adalightHeader(colors.count());
+    const QString colorSequence("GRB");
+    QByteArray buffer;
+
+    QBENCHMARK {
+        appendEncode(buffer, header, colors, colorSequence);
+    }
+}
+
+void SerialFrameEncoderTest::benchmarkSerialFrameEncoder()
+{
+    const QList<StructRgb> colors = testColors(kBenchmarkLedsCount);
+    SerialFrameEncoder encoder;
+    encoder.setHeader(adalightHeader(colors.count()));
+    encoder.setColorSequence("GRB");
+
+    QBENCHMARK {
+        encoder.encode(colors);
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * SerialFrameEncoderTest.hpp
+ *
+ *  Created on: 18.10.2026
+ *     Project: Prismatik
+ *
+ *
+ *  Copyright (c) 2026 Prismatik contributors
+ *
+ *  Lightpack is an open-source, USB content-driving ambient lighting
+ *  hardware.
+ *
+ *  Prismatik is a free, open-source software: you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Prismatik and Lightpack files is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+class SerialFrameEncoderTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SerialFrameEncoderTest(){}
+
+private Q_SLOTS:
+    void testColorSequences();
+    void testHeaderAndClamp();
+    void benchmarkAppendEncode();
+    void benchmarkSerialFrameEncoder();
+};
@@ -2,6 +2,8 @@
 #include <QtTest/QtTest>
 #include "LightpackApiTest.hpp"
 #include "GrabCalculationTest.hpp"
+#include "SerialFrameEncoderTest.hpp"
+#include "LightpackFrameEncoderTest.hpp"
 #include "lightpackmathtest.hpp"
 #include "AppVersionTest.hpp"
 #ifdef Q_OS_WIN
@@ -24,6 +26,8 @@ int main(int argc, char *argv[])
     QStringList summary;
 
     tests.append(new GrabCalculationTest());
+    tests.append(new SerialFrameEncoderTest());
+    tests.append(new LightpackFrameEncoderTest());
 
 #ifdef Q_OS_WIN
     tests.append(new HooksTest());
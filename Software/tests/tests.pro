@@ -37,14 +37,20 @@ HEADERS += \
     ../src/enums.hpp \
     ../src/ApiServerSetColorTask.hpp \
     ../src/ApiServer.hpp \
+    ../src/ApiUdpServer.hpp \
     ../src/debug.h \
     ../src/Settings.hpp \
     ../src/Plugin.hpp \
     ../src/LightpackPluginInterface.hpp \
     ../grab/include/calculations.hpp \
+    ../grab/include/LetterboxDetector.hpp \
+    ../src/SerialFrameEncoder.hpp \
+    ../src/LightpackFrameEncoder.hpp \
     ../math/include/PrismatikMath.hpp \
     SettingsWindowMockup.hpp \
     GrabCalculationTest.hpp \
+    SerialFrameEncoderTest.hpp \
+    LightpackFrameEncoderTest.hpp \
     LightpackApiTest.hpp \
     lightpackmathtest.hpp \
     AppVersionTest.hpp \
@@ -53,12 +59,17 @@ HEADERS += \
 SOURCES += \
     ../src/ApiServerSetColorTask.cpp \
     ../src/ApiServer.cpp \
+    ../src/ApiUdpServer.cpp \
     ../src/Settings.cpp \
     ../src/Plugin.cpp \
     ../src/LightpackPluginInterface.cpp \
+    ../src/SerialFrameEncoder.cpp \
+    ../src/LightpackFrameEncoder.cpp \
     LightpackApiTest.cpp \
     SettingsWindowMockup.cpp \
     GrabCalculationTest.cpp \
+    SerialFrameEncoderTest.cpp \
+    LightpackFrameEncoderTest.cpp \
     lightpackmathtest.cpp \
     TestsMain.cpp \
     AppVersionTest.cpp \